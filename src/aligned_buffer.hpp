@@ -0,0 +1,153 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_ALIGNED_BUFFER_HPP
+#define SDL_GLEW_TEST_ALIGNED_BUFFER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "page_allocator.hpp"
+
+// Heap array of trivially copyable elements starting on a cache line boundary.
+// Shrinking never frees and growing reallocates geometrically, so resizing back
+// and forth within the high-water mark never allocates. Large buffers can be
+// backed by huge pages, which are left untouched until first written.
+template<typename T>
+class AlignedBuffer {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    AlignedBuffer() noexcept = default;
+    explicit AlignedBuffer(PagePolicy policy) noexcept;
+    explicit AlignedBuffer(std::size_t size, PagePolicy policy = PagePolicy::Default);
+    ~AlignedBuffer() noexcept;
+
+    AlignedBuffer(AlignedBuffer const &other) = delete;
+    AlignedBuffer(AlignedBuffer &&other) noexcept;
+    AlignedBuffer &operator=(AlignedBuffer const &other) = delete;
+    AlignedBuffer &operator=(AlignedBuffer &&other) noexcept;
+
+    void reserve(std::size_t capacity);
+    // New elements are value-initialized.
+    void resize(std::size_t size);
+    // New elements are left for the caller to write, so that it can choose which
+    // threads first touch their pages.
+    void resize_for_overwrite(std::size_t size);
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] PagePolicy page_policy() const noexcept { return policy_; }
+    [[nodiscard]] T *data() noexcept { return data_; }
+    [[nodiscard]] T const *data() const noexcept { return data_; }
+    [[nodiscard]] T &operator[](std::size_t i) noexcept { return data_[i]; }
+    [[nodiscard]] T const &operator[](std::size_t i) const noexcept { return data_[i]; }
+    [[nodiscard]] T *begin() noexcept { return data_; }
+    [[nodiscard]] T *end() noexcept { return data_ + size_; }
+    [[nodiscard]] T const *begin() const noexcept { return data_; }
+    [[nodiscard]] T const *end() const noexcept { return data_ + size_; }
+
+    operator std::span<T>() noexcept { return {data_, size_}; }
+    operator std::span<T const>() const noexcept { return {data_, size_}; }
+
+private:
+    void release() noexcept;
+
+    T *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+    PagePolicy policy_ = PagePolicy::Default;
+    bool mapped_ = false;
+};
+
+template<typename T>
+AlignedBuffer<T>::AlignedBuffer(PagePolicy policy) noexcept:
+    policy_(policy)
+{}
+
+template<typename T>
+AlignedBuffer<T>::AlignedBuffer(std::size_t size, PagePolicy policy):
+    policy_(policy)
+{
+    resize(size);
+}
+
+template<typename T>
+AlignedBuffer<T>::~AlignedBuffer() noexcept {
+    release();
+}
+
+template<typename T>
+AlignedBuffer<T>::AlignedBuffer(AlignedBuffer &&other) noexcept:
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    capacity_(std::exchange(other.capacity_, 0)),
+    policy_(other.policy_),
+    mapped_(std::exchange(other.mapped_, false))
+{}
+
+template<typename T>
+AlignedBuffer<T> &AlignedBuffer<T>::operator=(AlignedBuffer &&other) noexcept {
+    release();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    policy_ = other.policy_;
+    mapped_ = std::exchange(other.mapped_, false);
+    return *this;
+}
+
+template<typename T>
+void AlignedBuffer<T>::reserve(std::size_t capacity) {
+    if (capacity <= capacity_) {
+        return;
+    }
+    auto bytes = capacity * sizeof(T);
+    void *mapping = (policy_ != PagePolicy::Default && bytes >= HUGE_PAGE_SIZE) ? map_pages(bytes, policy_) : nullptr;
+    auto *data = static_cast<T *>(mapping ? mapping : ::operator new(bytes, std::align_val_t{ALIGNMENT}));
+    if (size_ != 0) {
+        std::memcpy(data, data_, size_ * sizeof(T));
+    }
+    release();
+    data_ = data;
+    capacity_ = capacity;
+    mapped_ = mapping != nullptr;
+}
+
+template<typename T>
+void AlignedBuffer<T>::resize(std::size_t size) {
+    if (size > capacity_) {
+        reserve(std::max(size, capacity_ * 2));
+    }
+    for (auto i = size_; i < size; ++i) {
+        new (data_ + i) T();
+    }
+    size_ = size;
+}
+
+template<typename T>
+void AlignedBuffer<T>::resize_for_overwrite(std::size_t size) {
+    if (size > capacity_) {
+        reserve(std::max(size, capacity_ * 2));
+    }
+    size_ = size;
+}
+
+template<typename T>
+void AlignedBuffer<T>::release() noexcept {
+    if (mapped_) {
+        unmap_pages(data_, capacity_ * sizeof(T));
+    } else if (data_ != nullptr) {
+        ::operator delete(data_, std::align_val_t{ALIGNMENT});
+    }
+}
+
+#endif //SDL_GLEW_TEST_ALIGNED_BUFFER_HPP
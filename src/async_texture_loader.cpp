@@ -0,0 +1,304 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "async_texture_loader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include "SDL_log.h"
+#include "gl_session.hpp"
+#include "sdl_image_loader.hpp"
+#include "trace.hpp"
+
+static void set_texture_parameters(GLenum target) {
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+static std::string cache_path_for(std::string const &path) {
+    return std::filesystem::path(path).replace_extension(".btex").string();
+}
+
+static GLuint create_placeholder(GLenum target) {
+    GLubyte const placeholder_pixel[3] = {128, 128, 128};
+    GLuint ret;
+    glGenTextures(1, &ret);
+    glBindTexture(target, ret);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (target == GL_TEXTURE_2D_ARRAY) {
+        glTexImage3D(target, 0, GL_RGB8, 1, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder_pixel);
+    } else {
+        glTexImage2D(target, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder_pixel);
+    }
+    glGenerateMipmap(target);
+    set_texture_parameters(target);
+    return ret;
+}
+
+AsyncTextureLoader::AsyncTextureLoader(GLSession const &gl, SdlImageLoader const &image_loader):
+    image_loader_(&image_loader),
+    compression_supported_(GLEW_EXT_texture_compression_s3tc),
+    placeholder_2d_(create_placeholder(GL_TEXTURE_2D)),
+    placeholder_array_(create_placeholder(GL_TEXTURE_2D_ARRAY)),
+    pixel_buffer_(0)
+{
+    glGenBuffers(1, &pixel_buffer_);
+
+    worker_ = std::jthread([this](std::stop_token stop) { worker_loop(std::move(stop)); });
+}
+
+AsyncTextureLoader::~AsyncTextureLoader() noexcept {
+    worker_.request_stop();
+    worker_.join();
+
+    if (current_upload_) {
+        glDeleteTextures(1, &current_upload_->texture);
+    }
+    for (auto const &slot : slots_) {
+        if (slot.texture != placeholder(slot.target)) {
+            glDeleteTextures(1, &slot.texture);
+        }
+    }
+    glDeleteTextures(1, &placeholder_2d_);
+    glDeleteTextures(1, &placeholder_array_);
+    glDeleteBuffers(1, &pixel_buffer_);
+}
+
+AsyncTextureLoader::Slot AsyncTextureLoader::load(std::string path) {
+    std::vector<std::string> paths;
+    paths.push_back(std::move(path));
+    return add_slot(GL_TEXTURE_2D, std::move(paths));
+}
+
+AsyncTextureLoader::Slot AsyncTextureLoader::load_array(std::vector<std::string> layer_paths) {
+    if (layer_paths.empty()) {
+        throw std::runtime_error("Cannot load texture array without layers");
+    }
+    return add_slot(GL_TEXTURE_2D_ARRAY, std::move(layer_paths));
+}
+
+void AsyncTextureLoader::reload(Slot slot) {
+    enqueue(slot, true);
+}
+
+GLuint AsyncTextureLoader::texture(Slot slot) const noexcept {
+    return slots_[slot].texture;
+}
+
+bool AsyncTextureLoader::ready(Slot slot) const noexcept {
+    return slots_[slot].texture != placeholder(slots_[slot].target);
+}
+
+AsyncTextureLoader::Slot AsyncTextureLoader::add_slot(GLenum target, std::vector<std::string> paths) {
+    Slot slot = slots_.size();
+    slots_.push_back({target, std::move(paths), placeholder(target)});
+    enqueue(slot, false);
+    return slot;
+}
+
+GLuint AsyncTextureLoader::placeholder(GLenum target) const noexcept {
+    return (target == GL_TEXTURE_2D_ARRAY)? placeholder_array_ : placeholder_2d_;
+}
+
+void AsyncTextureLoader::enqueue(Slot slot, bool reload) {
+    {
+        std::lock_guard lock(mutex_);
+        requests_.push_back({slot, slots_[slot].paths, reload});
+    }
+    requests_available_.notify_one();
+}
+
+static void check_layers_match(std::vector<TextureCache> const &layers, std::vector<std::string> const &paths) {
+    auto const &first = layers.front();
+    for (std::size_t i = 1; i < layers.size(); ++i) {
+        auto const &layer = layers[i];
+        bool matches = layer.format() == first.format()
+            && layer.levels().size() == first.levels().size()
+            && layer.levels()[0].width == first.levels()[0].width
+            && layer.levels()[0].height == first.levels()[0].height;
+        if (!matches) {
+            throw std::runtime_error(std::format(
+                "Texture array layer '{}' does not match the size and format of '{}'", paths[i], paths[0]));
+        }
+    }
+}
+
+void AsyncTextureLoader::worker_loop(std::stop_token stop) {
+    TRACE_THREAD_NAME("texture_loader");
+    while (true) {
+        DecodeRequest request;
+        {
+            std::unique_lock lock(mutex_);
+            if (!requests_available_.wait(lock, stop, [this] { return !requests_.empty(); })) {
+                return;
+            }
+            request = std::move(requests_.front());
+            requests_.pop_front();
+        }
+
+        try {
+            TRACE_SCOPE("load_texture", "load");
+            std::vector<TextureCache> layers;
+            for (auto const &path : request.paths) {
+                layers.push_back(TextureCache::load_or_bake(
+                    path.c_str(),
+                    cache_path_for(path).c_str(),
+                    *image_loader_,
+                    compression_supported_));
+            }
+            check_layers_match(layers, request.paths);
+            std::lock_guard lock(mutex_);
+            decoded_.push_back({request.slot, std::move(layers)});
+        } catch (std::exception const &err) {
+            if (request.reload) {
+                // The slot keeps the texture it has, so a bad edit doesn't end the program.
+                SDL_Log("Keeping the previous texture: %s", err.what());
+                continue;
+            }
+            std::lock_guard lock(mutex_);
+            worker_error_ = std::current_exception();
+        }
+    }
+}
+
+std::optional<AsyncTextureLoader::DecodedImage> AsyncTextureLoader::take_decoded() {
+    std::lock_guard lock(mutex_);
+    if (worker_error_) {
+        std::rethrow_exception(std::exchange(worker_error_, nullptr));
+    }
+    if (decoded_.empty()) {
+        return std::nullopt;
+    }
+    auto ret = std::move(decoded_.front());
+    decoded_.pop_front();
+    return ret;
+}
+
+void AsyncTextureLoader::upload_pending(std::size_t byte_budget) {
+    while (byte_budget > 0) {
+        if (!current_upload_) {
+            auto image = take_decoded();
+            if (!image) {
+                return;
+            }
+            begin_upload(std::move(*image));
+        }
+
+        byte_budget -= std::min(byte_budget, upload_rows(byte_budget));
+        if (current_upload_->layer == current_upload_->layers.size()) {
+            finish_upload();
+        }
+    }
+}
+
+void AsyncTextureLoader::begin_upload(DecodedImage &&image) {
+    auto target = slots_[image.slot].target;
+    auto const &cache = image.layers.front();
+    auto levels = cache.levels();
+    auto internal_format = static_cast<GLint>(cache.gl_internal_format());
+    auto layer_count = static_cast<GLsizei>(image.layers.size());
+
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(target, tex);
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        auto level = static_cast<GLint>(i);
+        if (target == GL_TEXTURE_2D_ARRAY) {
+            glTexImage3D(target, level, internal_format, levels[i].width, levels[i].height, layer_count,
+                         0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        } else {
+            glTexImage2D(target, level, internal_format, levels[i].width, levels[i].height,
+                         0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels.size() - 1));
+    current_upload_.emplace(Upload{image.slot, target, tex, std::move(image.layers), 0, 0, 0});
+}
+
+std::size_t AsyncTextureLoader::upload_rows(std::size_t byte_budget) {
+    TRACE_SCOPE("upload_texture_slice", "upload");
+    auto &upload = *current_upload_;
+    auto const &cache = upload.layers[upload.layer];
+    auto const &level = cache.levels()[upload.level];
+
+    // Each slice is a contiguous run of whole row groups within one mip level of one layer.
+    auto group_height = cache.row_group_height();
+    auto group_bytes = cache.row_group_bytes(level);
+    auto first_group = upload.next_row / group_height;
+    auto remaining_groups = (level.height + group_height - 1) / group_height - first_group;
+    auto groups = std::clamp<std::size_t>(byte_budget / group_bytes, 1, remaining_groups);
+    auto rows = std::min(static_cast<GLsizei>(groups) * group_height, level.height - upload.next_row);
+    auto slice_bytes = groups * group_bytes;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_);
+    // Orphan the previous slice so the map below never waits on an in-flight transfer.
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(slice_bytes), nullptr, GL_STREAM_DRAW);
+    auto *dest = glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(slice_bytes),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dest == nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        throw std::runtime_error("Error mapping texture upload buffer");
+    }
+    std::memcpy(dest, level.data.data() + first_group * group_bytes, slice_bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    auto gl_level = static_cast<GLint>(upload.level);
+    auto gl_layer = static_cast<GLint>(upload.layer);
+    auto internal_format = cache.gl_internal_format();
+    auto image_size = static_cast<GLsizei>(slice_bytes);
+    glBindTexture(upload.target, upload.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (upload.target == GL_TEXTURE_2D_ARRAY) {
+        if (cache.is_compressed()) {
+            glCompressedTexSubImage3D(upload.target, gl_level, 0, upload.next_row, gl_layer, level.width, rows, 1,
+                                      internal_format, image_size, nullptr);
+        } else {
+            glTexSubImage3D(upload.target, gl_level, 0, upload.next_row, gl_layer, level.width, rows, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    } else {
+        if (cache.is_compressed()) {
+            glCompressedTexSubImage2D(upload.target, gl_level, 0, upload.next_row, level.width, rows,
+                                      internal_format, image_size, nullptr);
+        } else {
+            glTexSubImage2D(upload.target, gl_level, 0, upload.next_row, level.width, rows,
+                            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    upload.next_row += rows;
+    if (upload.next_row == level.height) {
+        upload.next_row = 0;
+        if (++upload.level == cache.levels().size()) {
+            upload.level = 0;
+            ++upload.layer;
+        }
+    }
+    return slice_bytes;
+}
+
+void AsyncTextureLoader::finish_upload() {
+    auto slot = current_upload_->slot;
+    auto target = current_upload_->target;
+    auto tex = current_upload_->texture;
+    current_upload_.reset();
+
+    glBindTexture(target, tex);
+    set_texture_parameters(target);
+
+    GLuint previous = std::exchange(slots_[slot].texture, tex);
+    if (previous != placeholder(target)) {
+        glDeleteTextures(1, &previous);
+    }
+}
@@ -0,0 +1,115 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_ASYNC_TEXTURE_LOADER_HPP
+#define SDL_GLEW_TEST_ASYNC_TEXTURE_LOADER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <cstddef>
+
+#include "GL/glew.h"
+#include "texture_cache.hpp"
+
+class GLSession;
+class SdlImageLoader;
+
+// Loads textures on a worker thread and streams them into GL through a pixel
+// buffer object, a bounded number of bytes per frame. Each image is read from its
+// texture cache (the source path with a .btex extension), which is baked from the
+// source on first use, so every mip level is uploaded directly rather than
+// generated. Until a slot's texture has been fully uploaded, texture() returns a
+// 1x1 placeholder of the same target (or the previous texture, when reloading).
+// Images are uploaded in file row order, so meshes sampling them should be built
+// with flipped V coordinates.
+class AsyncTextureLoader {
+public:
+    using Slot = std::size_t;
+
+    AsyncTextureLoader(GLSession const &gl, SdlImageLoader const &image_loader);
+    ~AsyncTextureLoader() noexcept;
+
+    AsyncTextureLoader(AsyncTextureLoader const &other) = delete;
+    AsyncTextureLoader(AsyncTextureLoader &&other) = delete;
+    AsyncTextureLoader &operator=(AsyncTextureLoader const &other) = delete;
+    AsyncTextureLoader &operator=(AsyncTextureLoader &&other) = delete;
+
+    // Loads a GL_TEXTURE_2D.
+    [[nodiscard]] Slot load(std::string path);
+    // Loads a GL_TEXTURE_2D_ARRAY with one layer per image. All images must have
+    // the same dimensions and bake to the same cache format.
+    [[nodiscard]] Slot load_array(std::vector<std::string> layer_paths);
+    // Reads the slot's images again, e.g. after they changed on disk. If they can't
+    // be read, the error is logged and the slot keeps its current texture.
+    void reload(Slot slot);
+
+    [[nodiscard]] GLuint texture(Slot slot) const noexcept;
+    [[nodiscard]] bool ready(Slot slot) const noexcept;
+
+    // Must be called on the thread owning the GL context, typically once per frame.
+    // Rethrows any error raised while decoding a first load.
+    void upload_pending(std::size_t byte_budget);
+
+private:
+    struct SlotState {
+        GLenum target;
+        std::vector<std::string> paths;
+        GLuint texture;
+    };
+
+    struct DecodeRequest {
+        Slot slot;
+        std::vector<std::string> paths;
+        bool reload;
+    };
+
+    struct DecodedImage {
+        Slot slot;
+        std::vector<TextureCache> layers;
+    };
+
+    struct Upload {
+        Slot slot;
+        GLenum target;
+        GLuint texture;
+        std::vector<TextureCache> layers;
+        std::size_t layer;
+        std::size_t level;
+        GLsizei next_row;
+    };
+
+    [[nodiscard]] Slot add_slot(GLenum target, std::vector<std::string> paths);
+    [[nodiscard]] GLuint placeholder(GLenum target) const noexcept;
+    void enqueue(Slot slot, bool reload);
+    void worker_loop(std::stop_token stop);
+    [[nodiscard]] std::optional<DecodedImage> take_decoded();
+    void begin_upload(DecodedImage &&image);
+    std::size_t upload_rows(std::size_t byte_budget);
+    void finish_upload();
+
+    SdlImageLoader const *image_loader_;
+
+    bool compression_supported_;
+    GLuint placeholder_2d_;
+    GLuint placeholder_array_;
+    GLuint pixel_buffer_;
+    std::vector<SlotState> slots_;
+    std::optional<Upload> current_upload_;
+
+    std::mutex mutex_;
+    std::condition_variable_any requests_available_;
+    std::deque<DecodeRequest> requests_;
+    std::deque<DecodedImage> decoded_;
+    std::exception_ptr worker_error_;
+
+    std::jthread worker_;
+};
+
+#endif //SDL_GLEW_TEST_ASYNC_TEXTURE_LOADER_HPP
@@ -0,0 +1,300 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "SDL_log.h"
+
+#include "scenario.hpp"
+#include "simulation.hpp"
+#include "replay.hpp"
+#include "domain_simulation.hpp"
+#include "child_process.hpp"
+
+// FNV-1a over the boids' bytes, visited in id order so that storage order does not matter.
+static std::uint64_t state_hash(Simulation const &simulation) noexcept {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto boids = simulation.boids();
+    for (std::uint32_t id = 0; id < boids.size(); ++id) {
+        unsigned char bytes[sizeof(Boid)];
+        std::memcpy(bytes, &boids[simulation.slot_of(id)], sizeof(Boid));
+        for (auto byte : bytes) {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+struct BenchmarkRun {
+    double ms_per_step;
+    std::uint64_t hash;
+    MemoryStats memory_before;
+    MemoryStats memory_after;
+    MultiRateStats multi_rate;
+    ObstacleStats obstacles;
+    // Cache events while stepping.
+    CacheCounters::Sample cache_counts;
+};
+
+static BenchmarkRun run(Scenario const &scenario, ReplayRecorder *recorder = nullptr) {
+    auto simulation = scenario.create_simulation();
+    auto memory_before = simulation.memory_stats();
+    auto counts_before = simulation.cache_counts();
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < scenario.benchmark_steps; ++i) {
+        simulation.step();
+        if (recorder) {
+            recorder->record(i + 1, simulation.boids(), simulation.ids());
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    auto cache_counts = simulation.cache_counts() - counts_before;
+    return {
+        elapsed.count() / static_cast<double>(scenario.benchmark_steps),
+        state_hash(simulation),
+        memory_before,
+        simulation.memory_stats(),
+        simulation.multi_rate_stats(),
+        simulation.obstacle_stats(),
+        cache_counts,
+    };
+}
+
+// Perf events that could not be opened read as zero references.
+static std::string miss_rate_text(CacheCounters::Sample const &counts) {
+    if (counts.references == 0) {
+        return "unavailable";
+    }
+    return std::format("{:.2f}%", 100.0 * counts.miss_rate());
+}
+
+void log_memory_stats(MemoryStats const &stats) {
+    SDL_Log("Memory: %llu minor / %llu major page faults",
+            static_cast<unsigned long long>(stats.faults.minor),
+            static_cast<unsigned long long>(stats.faults.major));
+    if (stats.sampled_pages == 0) {
+        return;
+    }
+    std::string nodes;
+    for (std::size_t node = 0; node < stats.pages_per_node.size(); ++node) {
+        nodes += std::format(" node{} {}", node, stats.pages_per_node[node]);
+    }
+    SDL_Log("Memory: %zu sampled boid pages,%s; %zu on the stepping thread's node",
+            stats.sampled_pages, nodes.c_str(), stats.local_pages);
+}
+
+// Decodes the whole recording as fast as possible.
+static void run_replay_benchmark(Scenario const &scenario) {
+    ReplayPlayer player(scenario.replay.c_str());
+    std::size_t frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (player.next_frame()) {
+        ++frames;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    auto ms_per_frame = elapsed.count() / static_cast<double>(std::max<std::size_t>(frames, 1));
+    SDL_Log("Replay: %zu frames of %zu boids, %.3f ms/frame, %.1fx real time at 60 Hz",
+            frames, player.boids().size(), ms_per_frame, (1000.0 / 60) / ms_per_frame);
+}
+
+// Steps a flock kept in files, reporting how fast its state streams through them.
+static void run_out_of_core_benchmark(Scenario const &scenario) {
+    auto simulation = scenario.create_out_of_core_simulation();
+    auto grid = simulation->tile_grid();
+    SDL_Log("Out-of-core benchmark: %zu boids in %zux%zux%zu tiles, %zu steps",
+            scenario.boid_count, grid[0], grid[1], grid[2], scenario.benchmark_steps);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < scenario.benchmark_steps; ++i) {
+        simulation->step();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    auto ms_per_step = elapsed.count() / static_cast<double>(scenario.benchmark_steps);
+    SDL_Log("  %.3f ms/step, %.1f MB/s streamed through the state files",
+            ms_per_step, static_cast<double>(simulation->bytes_per_step()) / 1e3 / ms_per_step);
+}
+
+// Steps this process's domain of a flock split between processes, first
+// starting the other domains when they all run on this machine. Returns the
+// time per step, which with domains stepping in lockstep is that of the whole
+// flock.
+static std::optional<double> run_domain_benchmark(Scenario const &scenario) {
+    auto session = scenario;
+    std::vector<std::unique_ptr<ChildProcess>> others;
+    if (scenario.domain_rank == 0 && scenario.domain_hosts.empty() && scenario.domain_count > 1) {
+        session.domain_name = std::format("{}_{:08x}", scenario.domain_name, std::random_device()());
+        std::vector<std::string> arguments(scenario.command_line.begin() + 1, scenario.command_line.end());
+        arguments.insert(arguments.end(), {
+            "--domains", std::to_string(session.domain_count),
+            "--domain_name", session.domain_name,
+            "--domain_scaling", "false",
+            "--domain_rank", "",
+        });
+        for (std::size_t rank = 1; rank < session.domain_count; ++rank) {
+            arguments.back() = std::to_string(rank);
+            others.push_back(std::make_unique<ChildProcess>(scenario.command_line[0], arguments));
+        }
+    }
+
+    std::optional<double> ret;
+    try {
+        auto simulation = session.create_domain_simulation();
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < session.benchmark_steps; ++i) {
+            simulation->step();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        auto steps = static_cast<double>(std::max<std::size_t>(session.benchmark_steps, 1));
+        auto const &stats = simulation->stats();
+        ret = elapsed.count() / steps;
+        SDL_Log("  domain %zu/%zu, x in [%.1f, %.1f): %zu boids, %.3f ms/step, %.1f halo boids, %.1f migrations, %.1f KB sent per step",
+                session.domain_rank, session.domain_count, simulation->slab_min(), simulation->slab_max(),
+                simulation->boids().size(), *ret,
+                static_cast<double>(stats.halo_boids) / steps,
+                static_cast<double>(stats.migrated_boids) / steps,
+                static_cast<double>(stats.bytes_sent) / 1e3 / steps);
+    } catch (std::runtime_error const &err) {
+        SDL_Log("  domain %zu/%zu failed: %s", session.domain_rank, session.domain_count, err.what());
+    }
+    for (auto &other : others) {
+        if (other->wait() != 0) {
+            ret.reset();
+        }
+    }
+    return ret;
+}
+
+// Runs the same flock as 1, 2, 4 and 8 domains on this machine.
+static void run_domain_scaling_benchmark(Scenario const &scenario) {
+    SDL_Log("Domain scaling benchmark: %zu boids, %zu steps over %s",
+            scenario.boid_count, scenario.benchmark_steps,
+            (scenario.domain_transport == DomainTransportMode::Tcp) ? "TCP" : "shared memory");
+    std::optional<double> single;
+    for (std::size_t count : {1, 2, 4, 8}) {
+        auto run_scenario = scenario;
+        run_scenario.domain_count = count;
+        run_scenario.domain_rank = 0;
+        run_scenario.domain_hosts.clear();
+        SDL_Log("%zu domain(s):", count);
+        auto ms_per_step = run_domain_benchmark(run_scenario);
+        if (!ms_per_step) {
+            continue;
+        }
+        if (count == 1) {
+            single = ms_per_step;
+        }
+        if (single) {
+            auto speedup = *single / *ms_per_step;
+            SDL_Log("  %.3f ms/step, %.2fx speedup, %.0f%% efficiency",
+                    *ms_per_step, speedup, 100.0 * speedup / static_cast<double>(count));
+        }
+    }
+}
+
+void run_benchmark(Scenario const &scenario) {
+    if (!scenario.replay.empty()) {
+        run_replay_benchmark(scenario);
+        return;
+    }
+    if (!scenario.out_of_core.empty()) {
+        run_out_of_core_benchmark(scenario);
+        return;
+    }
+    if (scenario.domain_scaling) {
+        run_domain_scaling_benchmark(scenario);
+        return;
+    }
+    if (scenario.domain_count > 1) {
+        if (scenario.domain_rank == 0) {
+            SDL_Log("Domain benchmark: %zu boids in %zu domains, %zu steps",
+                    scenario.boid_count, scenario.domain_count, scenario.benchmark_steps);
+        }
+        if (!run_domain_benchmark(scenario)) {
+            throw std::runtime_error("Domain benchmark failed");
+        }
+        return;
+    }
+    SDL_Log("Benchmark: %zu boids, %zu steps", scenario.boid_count, scenario.benchmark_steps);
+
+    auto fast_scenario = scenario;
+    fast_scenario.deterministic = false;
+    auto fast = run(fast_scenario);
+
+    auto deterministic_scenario = scenario;
+    deterministic_scenario.deterministic = true;
+    auto deterministic = run(deterministic_scenario);
+
+    auto reference_scenario = deterministic_scenario;
+    reference_scenario.thread_count = 1;
+    reference_scenario.reorder_interval = 0;
+    auto reference = run(reference_scenario);
+
+    SDL_Log("  fast:          %.3f ms/step, %llu minor faults while stepping", fast.ms_per_step,
+            static_cast<unsigned long long>(fast.memory_after.faults.minor - fast.memory_before.faults.minor));
+    SDL_Log("  deterministic: %.3f ms/step (%+.1f%%)", deterministic.ms_per_step,
+            100.0 * (deterministic.ms_per_step / fast.ms_per_step - 1));
+    SDL_Log("  deterministic state %016llx, single-threaded, never reordered reference %016llx: %s",
+            static_cast<unsigned long long>(deterministic.hash),
+            static_cast<unsigned long long>(reference.hash),
+            (deterministic.hash == reference.hash) ? "identical" : "DIFFERENT");
+    if (scenario.reorder_interval != 0) {
+        auto unordered_scenario = fast_scenario;
+        unordered_scenario.reorder_interval = 0;
+        auto unordered = run(unordered_scenario);
+        SDL_Log("  reordering:    %.3f ms/step and LLC miss rate %s every %zu steps, %.3f ms/step and %s never (%+.1f%%)",
+                fast.ms_per_step, miss_rate_text(fast.cache_counts).c_str(), scenario.reorder_interval,
+                unordered.ms_per_step, miss_rate_text(unordered.cache_counts).c_str(),
+                100.0 * (fast.ms_per_step / unordered.ms_per_step - 1));
+    }
+    if (scenario.multi_rate.enabled) {
+        auto full_rate_scenario = fast_scenario;
+        full_rate_scenario.multi_rate.enabled = false;
+        auto full_rate = run(full_rate_scenario);
+        auto const &stats = fast.multi_rate;
+        auto skipped = static_cast<double>(stats.boid_steps - stats.updates);
+        auto seconds = fast.ms_per_step * static_cast<double>(scenario.benchmark_steps) / 1000;
+        SDL_Log("  multi-rate:    %.3f ms/step vs %.3f at full rate (%+.1f%%), %.1f%% of boid updates skipped, %.2fM updates/s saved",
+                fast.ms_per_step, full_rate.ms_per_step, 100.0 * (fast.ms_per_step / full_rate.ms_per_step - 1),
+                100.0 * skipped / static_cast<double>(std::max<std::uint64_t>(stats.boid_steps, 1)),
+                skipped / seconds / 1e6);
+        SDL_Log("  tiers:         %zu every step, %zu every 2, %zu every 4, %zu every 8",
+                stats.tier_counts[0], stats.tier_counts[1], stats.tier_counts[2], stats.tier_counts[3]);
+    }
+    if (scenario.obstacles.bvh) {
+        auto const &bvh = *scenario.obstacles.bvh;
+        auto const &stats = fast.obstacles;
+        auto queries = static_cast<double>(std::max<std::uint64_t>(stats.queries, 1));
+        SDL_Log("  obstacles:     %zu triangles in %zu BVH nodes, depth %zu; %.0f ns/query, %.1f%% of queries steering away",
+                bvh.triangle_count(), bvh.node_count(), bvh.depth(),
+                static_cast<double>(stats.query_ns) / queries, 100.0 * static_cast<double>(stats.avoiding) / queries);
+    }
+    if (!scenario.record.empty()) {
+        double ms_per_step;
+        std::uint64_t dropped;
+        {
+            ReplayRecorder recorder(scenario.record.c_str(), scenario.mindset, scenario.bounds);
+            ms_per_step = run(fast_scenario, &recorder).ms_per_step;
+            dropped = recorder.dropped_frames();
+        }
+        std::error_code ignored;
+        auto bytes = std::filesystem::file_size(scenario.record, ignored);
+        SDL_Log("  recording:     %.3f ms/step (%+.1f%%), %llu frames dropped, %.1f bytes/boid/frame",
+                ms_per_step, 100.0 * (ms_per_step / fast.ms_per_step - 1),
+                static_cast<unsigned long long>(dropped),
+                static_cast<double>(bytes) / static_cast<double>(scenario.boid_count * scenario.benchmark_steps));
+    }
+    log_memory_stats(fast.memory_after);
+}
@@ -0,0 +1,21 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_BENCHMARK_HPP
+#define SDL_GLEW_TEST_BENCHMARK_HPP
+
+struct Scenario;
+struct MemoryStats;
+
+// Steps the scenario's simulation without rendering, once in the fast mode and
+// once in the deterministic mode, and logs the time per step of each. Also
+// checks that the deterministic run matches a single-threaded run that never
+// reorders, bit for bit, and compares time and last-level cache miss rate with
+// and without Morton reordering. Replays, out-of-core flocks and flocks split
+// into domains get benchmarks of their own instead.
+void run_benchmark(Scenario const &scenario);
+
+void log_memory_stats(MemoryStats const &stats);
+
+#endif //SDL_GLEW_TEST_BENCHMARK_HPP
@@ -3,6 +3,7 @@
 //
 #include <cmath>
 #include "boid.hpp"
+#include "obstacle_bvh.hpp"
 
 #include <stdio.h>
 
@@ -20,6 +21,23 @@ void Boid::consider(Boid::SituationalAwareness &awareness, Boid const &other) co
     awareness.total_scaled_velocities += inv_dist_sq * other.velocity;
 }
 
+void Boid::consider(Boid::SituationalAwareness &awareness, ObstacleBvh const &obstacles, GLfloat look_ahead, GLfloat clearance) const noexcept {
+    // A surface ahead pushes back along its normal, the harder the sooner it would be hit.
+    auto speed_sq = magnitude_sq(velocity);
+    if (speed_sq > 0 && look_ahead > 0) {
+        auto direction = 1/std::sqrt(speed_sq) * velocity;
+        if (auto hit = obstacles.raycast(pos, direction, look_ahead)) {
+            awareness.geometry_avoidance += (1 - hit->distance / look_ahead) * hit->normal;
+        }
+    }
+    // So does the nearest surface alongside, so that boids do not graze or drift into it.
+    if (clearance > 0) {
+        if (auto contact = obstacles.nearest(pos, clearance); contact && contact->distance > 0) {
+            awareness.geometry_avoidance += (1 - contact->distance / clearance) / contact->distance * (pos - contact->point);
+        }
+    }
+}
+
 static GLfloat accumulate_movement(Vec3<GLfloat> &acc, GLfloat remaining_movement_sq, Vec3<GLfloat> movement) noexcept {
     auto msq = magnitude_sq(movement);
     if (msq < remaining_movement_sq) {
@@ -32,7 +50,12 @@ static GLfloat accumulate_movement(Vec3<GLfloat> &acc, GLfloat remaining_movemen
     }
 }
 
+bool Boid::SituationalAwareness::sees_geometry() const noexcept {
+    return magnitude_sq(geometry_avoidance) > 0;
+}
+
 [[nodiscard]] Boid::MovementDecision Boid::SituationalAwareness::into_decision(const Mindset &mindset) const noexcept {
+    auto geometry_avoiding = mindset.geometry_avoiding_bias * mindset.maximum_movement * geometry_avoidance;
     auto obstacle_avoiding = mindset.obstacle_avoiding_bias * -total_scaled_directions;
     auto conforming = mindset.conforming_bias / total_inv_dist_sq * total_scaled_velocities;
     auto centering = mindset.centering_bias / total_inv_dist_sq * total_scaled_directions;
@@ -40,7 +63,7 @@ static GLfloat accumulate_movement(Vec3<GLfloat> &acc, GLfloat remaining_movemen
     GLfloat remaining_movement_sq = mindset.maximum_movement * mindset.maximum_movement;
     Vec3<GLfloat> velocity_decision = {{0, 0, 0}};
 
-    for (auto const *influence : {&obstacle_avoiding, &conforming, &centering}) {
+    for (auto const *influence : {&geometry_avoiding, &obstacle_avoiding, &conforming, &centering}) {
         if (remaining_movement_sq == 0) {
             break;
         }
@@ -51,6 +74,21 @@ static GLfloat accumulate_movement(Vec3<GLfloat> &acc, GLfloat remaining_movemen
 
 }
 
+[[nodiscard]] Boid::MovementDecision Boid::SituationalAwareness::into_lone_decision(Vec3<GLfloat> velocity, const Mindset &mindset) const noexcept {
+    if (!sees_geometry()) {
+        return {velocity};
+    }
+    auto geometry_avoiding = mindset.geometry_avoiding_bias * mindset.maximum_movement * geometry_avoidance;
+
+    GLfloat remaining_movement_sq = mindset.maximum_movement * mindset.maximum_movement;
+    Vec3<GLfloat> velocity_decision = {{0, 0, 0}};
+    remaining_movement_sq = accumulate_movement(velocity_decision, remaining_movement_sq, geometry_avoiding);
+    if (remaining_movement_sq > 0) {
+        accumulate_movement(velocity_decision, remaining_movement_sq, velocity);
+    }
+    return {velocity_decision};
+}
+
 void Boid::act_upon(Boid::MovementDecision const &decision) noexcept {
     pos += velocity;
     velocity = decision.decided_velocity;
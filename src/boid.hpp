@@ -9,6 +9,8 @@
 #include "matrix.hpp"
 #include "transform.hpp"
 
+class ObstacleBvh;
+
 class Boid {
 public:
     class Mindset {
@@ -18,6 +20,9 @@ public:
         GLfloat conforming_bias;
 
         GLfloat maximum_movement;
+
+        // Static obstacle geometry, unlike other boids, is avoided by default.
+        GLfloat geometry_avoiding_bias = 1;
     };
 
     class MovementDecision {
@@ -30,14 +35,21 @@ public:
         GLfloat total_inv_dist_sq = 0;
         Vec3<GLfloat> total_scaled_directions = {{0, 0, 0}};
         Vec3<GLfloat> total_scaled_velocities = {{0, 0, 0}};
+        // Away from obstacle surfaces, up to unit length for each surface right at the boid.
+        Vec3<GLfloat> geometry_avoidance = {{0, 0, 0}};
 
+        [[nodiscard]] bool sees_geometry() const noexcept;
         [[nodiscard]] MovementDecision into_decision(Mindset const &mindset) const noexcept;
+        // For a boid with no other boids in sight, which keeps its velocity unless it has to steer clear of geometry.
+        [[nodiscard]] MovementDecision into_lone_decision(Vec3<GLfloat> velocity, Mindset const &mindset) const noexcept;
     };
 
     Vec3<GLfloat> pos;
     Vec3<GLfloat> velocity;
 
     void consider(SituationalAwareness &awareness, Boid const &other) const noexcept;
+    // Looks for surfaces up to look_ahead along the boid's velocity and within clearance in any direction.
+    void consider(SituationalAwareness &awareness, ObstacleBvh const &obstacles, GLfloat look_ahead, GLfloat clearance) const noexcept;
     void act_upon(MovementDecision const &decision) noexcept;
 
     [[nodiscard]] Transform<GLfloat> transform() const noexcept;
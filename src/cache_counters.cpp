@@ -0,0 +1,92 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "cache_counters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+CacheCounters::Sample &CacheCounters::Sample::operator+=(Sample const &other) noexcept {
+    references += other.references;
+    misses += other.misses;
+    return *this;
+}
+
+CacheCounters::Sample CacheCounters::Sample::operator-(Sample const &other) const noexcept {
+    return {references - other.references, misses - other.misses};
+}
+
+double CacheCounters::Sample::miss_rate() const noexcept {
+    return (references == 0) ? 0.0 : static_cast<double>(misses) / static_cast<double>(references);
+}
+
+#ifdef __linux__
+
+static int open_counter(std::uint64_t config) noexcept {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // This thread only, on whichever CPU it runs.
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static std::uint64_t read_counter(int fd) noexcept {
+    std::uint64_t value = 0;
+    if (fd < 0 || ::read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return 0;
+    }
+    return value;
+}
+
+CacheCounters::CacheCounters() noexcept:
+    references_fd_(open_counter(PERF_COUNT_HW_CACHE_REFERENCES)),
+    misses_fd_(open_counter(PERF_COUNT_HW_CACHE_MISSES))
+{}
+
+CacheCounters::~CacheCounters() noexcept {
+    if (references_fd_ >= 0) {
+        close(references_fd_);
+    }
+    if (misses_fd_ >= 0) {
+        close(misses_fd_);
+    }
+}
+
+bool CacheCounters::available() const noexcept {
+    return references_fd_ >= 0 && misses_fd_ >= 0;
+}
+
+CacheCounters::Sample CacheCounters::read() const noexcept {
+    if (!available()) {
+        return {};
+    }
+    return {read_counter(references_fd_), read_counter(misses_fd_)};
+}
+
+#else
+
+CacheCounters::CacheCounters() noexcept:
+    references_fd_(-1),
+    misses_fd_(-1)
+{}
+
+CacheCounters::~CacheCounters() noexcept = default;
+
+bool CacheCounters::available() const noexcept {
+    return false;
+}
+
+CacheCounters::Sample CacheCounters::read() const noexcept {
+    return {};
+}
+
+#endif
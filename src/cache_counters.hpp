@@ -0,0 +1,42 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_CACHE_COUNTERS_HPP
+#define SDL_GLEW_TEST_CACHE_COUNTERS_HPP
+
+#include <cstdint>
+
+// Hardware last-level cache reference and miss counts for the thread that
+// created the counters, read through perf events on Linux. Elsewhere, or when
+// the kernel refuses (e.g. perf_event_paranoid), available() is false and every
+// read is zero.
+class CacheCounters {
+public:
+    struct Sample {
+        std::uint64_t references = 0;
+        std::uint64_t misses = 0;
+
+        Sample &operator+=(Sample const &other) noexcept;
+        [[nodiscard]] Sample operator-(Sample const &other) const noexcept;
+        [[nodiscard]] double miss_rate() const noexcept;
+    };
+
+    CacheCounters() noexcept;
+    ~CacheCounters() noexcept;
+
+    CacheCounters(CacheCounters const &other) = delete;
+    CacheCounters(CacheCounters &&other) = delete;
+    CacheCounters &operator=(CacheCounters const &other) = delete;
+    CacheCounters &operator=(CacheCounters &&other) = delete;
+
+    [[nodiscard]] bool available() const noexcept;
+    // May be called from any thread.
+    [[nodiscard]] Sample read() const noexcept;
+
+private:
+    int references_fd_;
+    int misses_fd_;
+};
+
+#endif //SDL_GLEW_TEST_CACHE_COUNTERS_HPP
@@ -0,0 +1,99 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "child_process.hpp"
+
+#include <format>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+#ifdef _WIN32
+// Quotes an argument so that the child's command line parser reads it back unchanged.
+static std::string quote_argument(std::string const &argument) {
+    std::string ret = "\"";
+    std::size_t backslashes = 0;
+    for (auto c : argument) {
+        if (c == '\\') {
+            ++backslashes;
+            continue;
+        }
+        ret.append(c == '"' ? 2 * backslashes + 1 : backslashes, '\\');
+        backslashes = 0;
+        ret += c;
+    }
+    ret.append(2 * backslashes, '\\');
+    ret += '"';
+    return ret;
+}
+#endif
+
+ChildProcess::ChildProcess(std::string const &executable, std::vector<std::string> const &arguments) {
+#ifdef _WIN32
+    auto command_line = quote_argument(executable);
+    for (auto const &argument : arguments) {
+        command_line += ' ';
+        command_line += quote_argument(argument);
+    }
+    STARTUPINFOA startup = {};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info = {};
+    // Without an application name, the command line's first word is the
+    // executable, looked up on PATH as well.
+    if (!CreateProcessA(nullptr, command_line.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &info)) {
+        throw std::runtime_error(std::format("Could not start {}", executable));
+    }
+    CloseHandle(info.hThread);
+    process_ = info.hProcess;
+#else
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(executable.c_str()));
+    for (auto const &argument : arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+    // Searches PATH when the executable has no slash in it, as a shell started it.
+    if (posix_spawnp(&pid_, executable.c_str(), nullptr, nullptr, argv.data(), environ) != 0) {
+        throw std::runtime_error(std::format("Could not start {}", executable));
+    }
+#endif
+}
+
+ChildProcess::~ChildProcess() noexcept {
+    wait();
+#ifdef _WIN32
+    CloseHandle(process_);
+#endif
+}
+
+int ChildProcess::wait() noexcept {
+    if (exited_) {
+        return exit_code_;
+    }
+#ifdef _WIN32
+    WaitForSingleObject(process_, INFINITE);
+    DWORD code = 0;
+    GetExitCodeProcess(process_, &code);
+    exit_code_ = static_cast<int>(code);
+#else
+    int status = 0;
+    pid_t result;
+    do {
+        result = waitpid(pid_, &status, 0);
+    } while (result == -1 && errno == EINTR);
+    exit_code_ = (result != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+#endif
+    exited_ = true;
+    return exit_code_;
+}
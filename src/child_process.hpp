@@ -0,0 +1,36 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_CHILD_PROCESS_HPP
+#define SDL_GLEW_TEST_CHILD_PROCESS_HPP
+
+#include <string>
+#include <vector>
+
+// Another process started from an executable and its arguments, sharing this
+// process's console. Destroying it waits for it to exit.
+class ChildProcess {
+public:
+    ChildProcess(std::string const &executable, std::vector<std::string> const &arguments);
+    ~ChildProcess() noexcept;
+
+    ChildProcess(ChildProcess const &other) = delete;
+    ChildProcess(ChildProcess &&other) = delete;
+    ChildProcess &operator=(ChildProcess const &other) = delete;
+    ChildProcess &operator=(ChildProcess &&other) = delete;
+
+    // Waits for the process to exit and returns its exit code.
+    int wait() noexcept;
+
+private:
+#ifdef _WIN32
+    void *process_;
+#else
+    int pid_;
+#endif
+    bool exited_ = false;
+    int exit_code_ = 0;
+};
+
+#endif //SDL_GLEW_TEST_CHILD_PROCESS_HPP
@@ -0,0 +1,233 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "domain_simulation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include "trace.hpp"
+
+// A message to a neighbor: this header, then the migrating boids' records,
+// then the halo boids' records.
+struct DomainMessageHeader {
+    std::uint32_t migrant_count;
+    std::uint32_t halo_count;
+};
+
+struct DomainRecord {
+    Boid boid;
+    std::uint32_t id;
+};
+
+template<typename T>
+static void append_bytes(std::vector<std::byte> &message, T const &value) {
+    auto offset = message.size();
+    message.resize(offset + sizeof(T));
+    std::memcpy(message.data() + offset, &value, sizeof(T));
+}
+
+DomainSimulation::DomainSimulation(
+    std::uint32_t flock_size,
+    Spawner const &spawn,
+    Boid::Mindset mindset,
+    WorldBounds bounds,
+    InteractionConfig const &interaction,
+    std::size_t rank,
+    std::size_t domain_count,
+    std::unique_ptr<DomainTransport> transport,
+    std::size_t thread_count
+):
+    mindset_(mindset),
+    bounds_(bounds),
+    radius_(interaction.perception_radius),
+    rank_(rank),
+    domain_count_(domain_count),
+    slab_width_((bounds.max[0] - bounds.min[0]) / static_cast<GLfloat>(std::max<std::size_t>(domain_count, 1))),
+    transport_(std::move(transport)),
+    interaction_(make_interaction_backend(interaction, bounds)),
+    pool_(thread_count)
+{
+    if (domain_count == 0 || rank >= domain_count) {
+        throw std::runtime_error(std::format("Domain rank {} is outside the {} domains", rank, domain_count));
+    }
+    if (domain_count > 1) {
+        if (!std::isfinite(radius_) || radius_ <= 0) {
+            throw std::runtime_error(std::format(
+                "Splitting the world into domains needs a finite positive perception radius (got {})", radius_));
+        }
+        if (slab_width_ < radius_ + mindset.maximum_movement) {
+            throw std::runtime_error(std::format(
+                "Domains of {} are narrower than the perception radius plus the maximum movement ({}); use fewer domains",
+                slab_width_, radius_ + mindset.maximum_movement));
+        }
+        if (!transport_) {
+            throw std::runtime_error("Several domains need a transport between them");
+        }
+    }
+
+    for (std::uint32_t id = 0; id < flock_size; ++id) {
+        auto boid = spawn(id);
+        bounds_.wrap(boid.pos);
+        if (domain_of(boid.pos[0]) == rank_) {
+            boids_.push_back(boid);
+            ids_.push_back(id);
+        }
+    }
+    owned_count_ = boids_.size();
+    exchange({}, {}, {});
+}
+
+void DomainSimulation::step() {
+    TRACE_SCOPE("domain_step", "sim");
+    FlockView flock = {
+        .boids = boids_,
+        .ids = ids_,
+        .slots = {},
+        .id_order = false,
+    };
+    auto start = std::chrono::steady_clock::now();
+    // The set of boids changes every step.
+    interaction_->invalidate();
+    interaction_->prepare(flock, pool_);
+    next_.resize(owned_count_);
+    pool_.parallel_for(owned_count_, 256, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            Boid::SituationalAwareness awareness;
+            interaction_->gather(flock, i, awareness);
+
+            Boid &next = next_[i];
+            next = boids_[i];
+            if (awareness.total_inv_dist_sq > 0) {
+                next.act_upon(awareness.into_decision(mindset_));
+            } else {
+                // Nobody in sight: keep going the same way.
+                next.act_upon({next.velocity});
+            }
+            bounds_.wrap(next.pos);
+        }
+    });
+    std::chrono::duration<double, std::milli> interaction_time = std::chrono::steady_clock::now() - start;
+    interaction_->step_finished(interaction_time.count());
+
+    departing_boids_.clear();
+    departing_ids_.clear();
+    departing_sides_.clear();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < owned_count_; ++i) {
+        auto domain = domain_of(next_[i].pos[0]);
+        if (domain == rank_) {
+            boids_[kept] = next_[i];
+            ids_[kept] = ids_[i];
+            ++kept;
+        } else {
+            // Boids move less than a slab per step, so they only ever reach a neighbor.
+            departing_boids_.push_back(next_[i]);
+            departing_ids_.push_back(ids_[i]);
+            departing_sides_.push_back((domain == (rank_ + 1) % domain_count_) ? DomainSide::Right : DomainSide::Left);
+        }
+    }
+    boids_.resize(kept);
+    ids_.resize(kept);
+    owned_count_ = kept;
+    stats_.migrated_boids += departing_boids_.size();
+    exchange(departing_boids_, departing_ids_, departing_sides_);
+}
+
+void DomainSimulation::exchange(std::span<Boid const> departing_boids, std::span<std::uint32_t const> departing_ids,
+                                std::span<DomainSide const> departing_sides) {
+    if (!transport_) {
+        return;
+    }
+    for (std::size_t side = 0; side < 2; ++side) {
+        auto &message = outgoing_[side];
+        message.clear();
+        append_bytes(message, DomainMessageHeader{});
+        DomainMessageHeader header = {.migrant_count = 0, .halo_count = 0};
+        for (std::size_t i = 0; i < departing_boids.size(); ++i) {
+            if (static_cast<std::size_t>(departing_sides[i]) == side) {
+                append_bytes(message, DomainRecord{.boid = departing_boids[i], .id = departing_ids[i]});
+                ++header.migrant_count;
+            }
+        }
+        // Boids do not see across the faces of the world box.
+        bool world_face = (side == static_cast<std::size_t>(DomainSide::Left)) ? (rank_ == 0) : (rank_ + 1 == domain_count_);
+        if (!world_face) {
+            auto edge = (side == static_cast<std::size_t>(DomainSide::Left)) ? slab_min() : slab_max();
+            for (std::size_t i = 0; i < owned_count_; ++i) {
+                if (std::abs(boids_[i].pos[0] - edge) < radius_) {
+                    append_bytes(message, DomainRecord{.boid = boids_[i], .id = ids_[i]});
+                    ++header.halo_count;
+                }
+            }
+        }
+        std::memcpy(message.data(), &header, sizeof(header));
+    }
+
+    auto incoming = transport_->exchange({outgoing_[0], outgoing_[1]});
+
+    DomainMessageHeader headers[2];
+    for (std::size_t side = 0; side < 2; ++side) {
+        if (incoming[side].size() < sizeof(DomainMessageHeader)) {
+            throw std::runtime_error(std::format("Domain {}: truncated message from a neighbor", rank_));
+        }
+        std::memcpy(&headers[side], incoming[side].data(), sizeof(DomainMessageHeader));
+        auto records = std::size_t{headers[side].migrant_count} + headers[side].halo_count;
+        if (incoming[side].size() != sizeof(DomainMessageHeader) + records * sizeof(DomainRecord)) {
+            throw std::runtime_error(std::format("Domain {}: malformed message from a neighbor", rank_));
+        }
+    }
+    auto take = [&](std::size_t side, std::size_t first, std::size_t count) {
+        for (auto r = first; r < first + count; ++r) {
+            DomainRecord record;
+            std::memcpy(&record, incoming[side].data() + sizeof(DomainMessageHeader) + r * sizeof(DomainRecord), sizeof(record));
+            boids_.push_back(record.boid);
+            ids_.push_back(record.id);
+        }
+    };
+    for (std::size_t side = 0; side < 2; ++side) {
+        take(side, 0, headers[side].migrant_count);
+    }
+    owned_count_ = boids_.size();
+    for (std::size_t side = 0; side < 2; ++side) {
+        take(side, headers[side].migrant_count, headers[side].halo_count);
+        stats_.halo_boids += headers[side].halo_count;
+    }
+    // Boids that just left sit right across the edge, so they are halos too.
+    for (std::size_t i = 0; i < departing_boids.size(); ++i) {
+        boids_.push_back(departing_boids[i]);
+        ids_.push_back(departing_ids[i]);
+    }
+    stats_.bytes_sent = transport_->bytes_sent();
+}
+
+std::span<Boid const> DomainSimulation::boids() const noexcept {
+    return std::span<Boid const>(boids_).first(owned_count_);
+}
+
+std::span<std::uint32_t const> DomainSimulation::ids() const noexcept {
+    return std::span<std::uint32_t const>(ids_).first(owned_count_);
+}
+
+GLfloat DomainSimulation::slab_min() const noexcept {
+    return bounds_.min[0] + static_cast<GLfloat>(rank_) * slab_width_;
+}
+
+GLfloat DomainSimulation::slab_max() const noexcept {
+    return (rank_ + 1 == domain_count_) ? bounds_.max[0] : slab_min() + slab_width_;
+}
+
+DomainSimulation::Stats const &DomainSimulation::stats() const noexcept {
+    return stats_;
+}
+
+std::size_t DomainSimulation::domain_of(GLfloat x) const noexcept {
+    auto domain = static_cast<std::ptrdiff_t>(std::floor((x - bounds_.min[0]) / slab_width_));
+    return static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(domain, 0, static_cast<std::ptrdiff_t>(domain_count_) - 1));
+}
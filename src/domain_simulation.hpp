@@ -0,0 +1,101 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_DOMAIN_SIMULATION_HPP
+#define SDL_GLEW_TEST_DOMAIN_SIMULATION_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+#include "simulation.hpp"
+#include "interaction.hpp"
+#include "worker_pool.hpp"
+#include "domain_transport.hpp"
+
+// One of several processes that together simulate a flock too large for one
+// machine. The world box is cut along x into equal slabs, one per domain, and
+// each domain steps only the boids inside its slab. To see across its edges it
+// keeps halo copies of the neighbors' boids within one perception radius of
+// them, and boids that leave the slab migrate to the neighbor they moved into.
+//
+// A step is one exchange with each neighbor, carrying both the boids migrating
+// there and the neighbor's next halo. That is enough as long as a slab is at
+// least one perception radius plus one step of maximum movement wide, which the
+// constructor checks. As in Simulation, boids wrap around the world box but do
+// not see across its faces, so the two outermost slabs share no halo.
+class DomainSimulation {
+public:
+    struct Stats {
+        std::size_t halo_boids = 0;
+        std::size_t migrated_boids = 0;
+        std::uint64_t bytes_sent = 0;
+    };
+
+    // Called with every id of the whole flock from 0 up, in order.
+    using Spawner = std::function<Boid(std::uint32_t id)>;
+
+    // Spawns the whole flock one boid at a time and keeps only the boids that
+    // start in this domain's slab. The transport may only be null for a single domain.
+    DomainSimulation(
+        std::uint32_t flock_size,
+        Spawner const &spawn,
+        Boid::Mindset mindset,
+        WorldBounds bounds,
+        InteractionConfig const &interaction,
+        std::size_t rank,
+        std::size_t domain_count,
+        std::unique_ptr<DomainTransport> transport,
+        std::size_t thread_count = 0);
+
+    DomainSimulation(DomainSimulation const &other) = delete;
+    DomainSimulation(DomainSimulation &&other) = delete;
+    DomainSimulation &operator=(DomainSimulation const &other) = delete;
+    DomainSimulation &operator=(DomainSimulation &&other) = delete;
+
+    void step();
+
+    // The boids this domain owns, and their ids in the whole flock.
+    [[nodiscard]] std::span<Boid const> boids() const noexcept;
+    [[nodiscard]] std::span<std::uint32_t const> ids() const noexcept;
+    [[nodiscard]] GLfloat slab_min() const noexcept;
+    [[nodiscard]] GLfloat slab_max() const noexcept;
+    // Totals since the domain started.
+    [[nodiscard]] Stats const &stats() const noexcept;
+
+private:
+    [[nodiscard]] std::size_t domain_of(GLfloat x) const noexcept;
+    // Sends migrants and halos to both neighbors and takes in theirs.
+    void exchange(std::span<Boid const> departing_boids, std::span<std::uint32_t const> departing_ids,
+                  std::span<DomainSide const> departing_sides);
+
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    GLfloat radius_;
+    std::size_t rank_;
+    std::size_t domain_count_;
+    GLfloat slab_width_;
+    std::unique_ptr<DomainTransport> transport_;
+    std::unique_ptr<InteractionBackend> interaction_;
+    WorkerPool pool_;
+
+    // Owned boids first, then halo boids.
+    std::vector<Boid> boids_;
+    std::vector<std::uint32_t> ids_;
+    std::size_t owned_count_ = 0;
+    std::vector<Boid> next_;
+    std::vector<Boid> departing_boids_;
+    std::vector<std::uint32_t> departing_ids_;
+    std::vector<DomainSide> departing_sides_;
+    std::array<std::vector<std::byte>, 2> outgoing_;
+    Stats stats_;
+};
+
+#endif //SDL_GLEW_TEST_DOMAIN_SIMULATION_HPP
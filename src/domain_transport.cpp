@@ -0,0 +1,379 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "domain_transport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include "trace.hpp"
+
+// How long a domain waits for its neighbors to start.
+constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(30);
+constexpr auto CONNECT_RETRY_INTERVAL = std::chrono::milliseconds(20);
+// How long an exchange waits without any data moving before giving up on a
+// neighbor, which has then most likely exited or hung.
+constexpr auto EXCHANGE_TIMEOUT = std::chrono::seconds(60);
+
+static std::size_t other_side(std::size_t side) noexcept {
+    return 1 - side;
+}
+
+std::array<std::vector<std::byte>, 2> DomainTransport::exchange(std::array<std::span<std::byte const>, 2> outgoing) {
+    TRACE_SCOPE("domain_exchange", "sim");
+    // Every message is preceded by its length.
+    std::uint64_t lengths[2] = {outgoing[0].size(), outgoing[1].size()};
+    std::size_t sent[2] = {0, 0};
+
+    std::array<std::vector<std::byte>, 2> ret;
+    std::uint64_t incoming_lengths[2];
+    std::size_t received[2] = {0, 0};
+    bool length_known[2] = {false, false};
+
+    auto done = [&](std::size_t side) {
+        return sent[side] == sizeof(std::uint64_t) + outgoing[side].size()
+            && length_known[side] && received[side] == ret[side].size();
+    };
+    auto last_progress = std::chrono::steady_clock::now();
+    while (!done(0) || !done(1)) {
+        bool progress = false;
+        for (std::size_t side = 0; side < 2; ++side) {
+            auto neighbor = static_cast<DomainSide>(side);
+            if (sent[side] < sizeof(std::uint64_t)) {
+                std::span<std::byte const> header(reinterpret_cast<std::byte const *>(&lengths[side]), sizeof(std::uint64_t));
+                auto n = send_some(neighbor, header.subspan(sent[side]));
+                sent[side] += n;
+                progress |= (n != 0);
+            }
+            if (sent[side] >= sizeof(std::uint64_t) && sent[side] < sizeof(std::uint64_t) + outgoing[side].size()) {
+                auto n = send_some(neighbor, outgoing[side].subspan(sent[side] - sizeof(std::uint64_t)));
+                sent[side] += n;
+                progress |= (n != 0);
+            }
+
+            if (!length_known[side]) {
+                std::span<std::byte> header(reinterpret_cast<std::byte *>(&incoming_lengths[side]), sizeof(std::uint64_t));
+                auto n = receive_some(neighbor, header.subspan(received[side]));
+                received[side] += n;
+                progress |= (n != 0);
+                if (received[side] == sizeof(std::uint64_t)) {
+                    length_known[side] = true;
+                    ret[side].resize(incoming_lengths[side]);
+                    received[side] = 0;
+                }
+            }
+            if (length_known[side] && received[side] < ret[side].size()) {
+                auto n = receive_some(neighbor, std::span(ret[side]).subspan(received[side]));
+                received[side] += n;
+                progress |= (n != 0);
+            }
+        }
+        if (progress) {
+            last_progress = std::chrono::steady_clock::now();
+        } else if (std::chrono::steady_clock::now() - last_progress > EXCHANGE_TIMEOUT) {
+            throw std::runtime_error(std::format("Domain exchange: no data moved for {} s; a neighbor has stopped",
+                                                 std::chrono::duration_cast<std::chrono::seconds>(EXCHANGE_TIMEOUT).count()));
+        } else {
+            wait();
+        }
+    }
+    bytes_sent_ += 2 * sizeof(std::uint64_t) + outgoing[0].size() + outgoing[1].size();
+    return ret;
+}
+
+std::uint64_t DomainTransport::bytes_sent() const noexcept {
+    return bytes_sent_;
+}
+
+// TCP
+
+TcpDomainTransport::TcpDomainTransport(std::size_t rank, std::vector<std::string> const &hosts, std::uint16_t base_port) {
+    auto count = hosts.size();
+    if (count < 2 || rank >= count) {
+        throw std::runtime_error(std::format("Domain {} of {}: TCP transport needs at least two domains", rank, count));
+    }
+    auto listener = TcpSocket::listen(static_cast<std::uint16_t>(base_port + rank));
+    auto right = (rank + 1) % count;
+    auto deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+
+    std::optional<TcpSocket> right_socket;
+    while (!right_socket) {
+        try {
+            right_socket.emplace(TcpSocket::connect(hosts[right], static_cast<std::uint16_t>(base_port + right)));
+        } catch (std::runtime_error const &) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw;
+            }
+            std::this_thread::sleep_for(CONNECT_RETRY_INTERVAL);
+        }
+    }
+
+    std::optional<TcpSocket> left_socket;
+    while (!(left_socket = listener.accept())) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error(std::format("Domain {}: its left neighbor never connected to port {}", rank, base_port + rank));
+        }
+        listener.wait_readable(CONNECT_RETRY_INTERVAL);
+    }
+
+    sockets_.push_back(std::move(*left_socket));
+    sockets_.push_back(std::move(*right_socket));
+}
+
+std::size_t TcpDomainTransport::send_some(DomainSide to, std::span<std::byte const> data) {
+    return sockets_[static_cast<std::size_t>(to)].send(data);
+}
+
+std::size_t TcpDomainTransport::receive_some(DomainSide from, std::span<std::byte> buffer) {
+    return sockets_[static_cast<std::size_t>(from)].receive(buffer);
+}
+
+void TcpDomainTransport::wait() {
+    // Incoming data is what usually unblocks an exchange; a full send buffer
+    // drains within the timeout anyway.
+    sockets_[static_cast<std::size_t>(DomainSide::Left)].wait_readable(std::chrono::milliseconds(1));
+}
+
+// Shared memory
+
+constexpr std::uint32_t SEGMENT_READY = 0x4d4f4442; // "BDOM"
+
+struct SegmentHeader {
+    std::atomic<std::uint32_t> ready;
+    // Of the process that created the segment, zero where unknown.
+    std::uint32_t owner_pid;
+    std::uint64_t ring_bytes;
+};
+
+// How often a waiting domain checks that its neighbors are still running.
+constexpr auto LIVENESS_CHECK_INTERVAL = std::chrono::milliseconds(100);
+
+// Single producer, single consumer. Both counters only grow; the producer owns
+// `written` and the consumer `read`, each on its own cache line.
+struct SharedMemoryDomainTransport::Ring {
+    alignas(64) std::atomic<std::uint64_t> written;
+    alignas(64) std::atomic<std::uint64_t> read;
+
+    [[nodiscard]] std::byte *data() noexcept {
+        return reinterpret_cast<std::byte *>(this + 1);
+    }
+};
+
+constexpr std::size_t SEGMENT_HEADER_BYTES = 64;
+static_assert(sizeof(SegmentHeader) <= SEGMENT_HEADER_BYTES);
+
+SharedMemoryDomainTransport::SharedMemoryDomainTransport(std::string const &name, std::size_t rank, std::size_t domain_count, std::size_t ring_bytes):
+    ring_bytes_((ring_bytes + 63) / 64 * 64),
+    segment_bytes_(SEGMENT_HEADER_BYTES + 2 * (sizeof(Ring) + ring_bytes_))
+{
+    if (domain_count < 2 || rank >= domain_count) {
+        throw std::runtime_error(std::format("Domain {} of {}: shared memory transport needs at least two domains", rank, domain_count));
+    }
+    own_.name = std::format("{}_{}", name, rank);
+    neighbors_[0].name = std::format("{}_{}", name, (rank + domain_count - 1) % domain_count);
+    neighbors_[1].name = std::format("{}_{}", name, (rank + 1) % domain_count);
+
+    create(own_);
+    try {
+        open(neighbors_[0]);
+        open(neighbors_[1]);
+    } catch (...) {
+        unmap(neighbors_[0]);
+        unmap(own_);
+#ifndef _WIN32
+        shm_unlink(own_.name.c_str());
+#endif
+        throw;
+    }
+}
+
+SharedMemoryDomainTransport::~SharedMemoryDomainTransport() noexcept {
+    unmap(neighbors_[1]);
+    unmap(neighbors_[0]);
+    unmap(own_);
+#ifndef _WIN32
+    shm_unlink(own_.name.c_str());
+#endif
+}
+
+void SharedMemoryDomainTransport::create(Segment &segment) {
+    segment.size = segment_bytes_;
+#ifdef _WIN32
+    auto size = static_cast<std::uint64_t>(segment.size);
+    segment.mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                         static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), segment.name.c_str());
+    if (segment.mapping == nullptr) {
+        throw std::runtime_error(std::format("Could not create shared memory '{}'", segment.name));
+    }
+    segment.data = static_cast<std::byte *>(MapViewOfFile(segment.mapping, FILE_MAP_WRITE, 0, 0, 0));
+    if (segment.data == nullptr) {
+        CloseHandle(segment.mapping);
+        throw std::runtime_error(std::format("Could not map shared memory '{}'", segment.name));
+    }
+#else
+    shm_unlink(segment.name.c_str());
+    int fd = shm_open(segment.name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        throw std::runtime_error(std::format("Could not create shared memory '{}'", segment.name));
+    }
+    if (ftruncate(fd, static_cast<off_t>(segment.size)) != 0) {
+        close(fd);
+        shm_unlink(segment.name.c_str());
+        throw std::runtime_error(std::format("Could not size shared memory '{}' to {} bytes", segment.name, segment.size));
+    }
+    void *data = mmap(nullptr, segment.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(segment.name.c_str());
+        throw std::runtime_error(std::format("Could not map shared memory '{}'", segment.name));
+    }
+    segment.data = static_cast<std::byte *>(data);
+#endif
+
+    // The segment starts zeroed, so both rings start empty; neighbors only use
+    // it once it is marked ready.
+    auto *header = new (segment.data) SegmentHeader{};
+    header->ring_bytes = ring_bytes_;
+#ifndef _WIN32
+    header->owner_pid = static_cast<std::uint32_t>(getpid());
+#endif
+    for (std::size_t side = 0; side < 2; ++side) {
+        new (segment.data + SEGMENT_HEADER_BYTES + side * (sizeof(Ring) + ring_bytes_)) Ring{};
+    }
+    header->ready.store(SEGMENT_READY, std::memory_order_release);
+}
+
+void SharedMemoryDomainTransport::open(Segment &segment) {
+    auto deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+    // Until the neighbor has created and sized its segment, opening fails or
+    // finds it too small.
+    while (true) {
+#ifdef _WIN32
+        segment.mapping = OpenFileMappingA(FILE_MAP_WRITE, FALSE, segment.name.c_str());
+        if (segment.mapping != nullptr) {
+            segment.data = static_cast<std::byte *>(MapViewOfFile(segment.mapping, FILE_MAP_WRITE, 0, 0, 0));
+            if (segment.data != nullptr) {
+                segment.size = segment_bytes_;
+            } else {
+                CloseHandle(segment.mapping);
+                segment.mapping = nullptr;
+            }
+        }
+#else
+        int fd = shm_open(segment.name.c_str(), O_RDWR, 0);
+        if (fd != -1) {
+            struct stat info = {};
+            if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= segment_bytes_) {
+                void *data = mmap(nullptr, segment_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (data != MAP_FAILED) {
+                    segment.data = static_cast<std::byte *>(data);
+                    segment.size = segment_bytes_;
+                }
+            }
+            close(fd);
+        }
+#endif
+        if (segment.data != nullptr) {
+            auto *header = std::launder(reinterpret_cast<SegmentHeader *>(segment.data));
+            if (header->ready.load(std::memory_order_acquire) == SEGMENT_READY) {
+                if (header->ring_bytes != ring_bytes_) {
+                    throw std::runtime_error(std::format("Shared memory '{}' has rings of {} bytes, expected {}",
+                                                         segment.name, header->ring_bytes, ring_bytes_));
+                }
+                return;
+            }
+            unmap(segment);
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error(std::format("Shared memory '{}' was never created", segment.name));
+        }
+        std::this_thread::sleep_for(CONNECT_RETRY_INTERVAL);
+    }
+}
+
+void SharedMemoryDomainTransport::unmap(Segment &segment) noexcept {
+    if (segment.data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(segment.data);
+    CloseHandle(segment.mapping);
+    segment.mapping = nullptr;
+#else
+    munmap(segment.data, segment.size);
+#endif
+    segment.data = nullptr;
+}
+
+SharedMemoryDomainTransport::Ring &SharedMemoryDomainTransport::ring(Segment const &segment, DomainSide from) const noexcept {
+    auto offset = SEGMENT_HEADER_BYTES + static_cast<std::size_t>(from) * (sizeof(Ring) + ring_bytes_);
+    return *std::launder(reinterpret_cast<Ring *>(segment.data + offset));
+}
+
+std::size_t SharedMemoryDomainTransport::send_some(DomainSide to, std::span<std::byte const> data) {
+    // What goes to the right arrives from the left.
+    auto &target = ring(neighbors_[static_cast<std::size_t>(to)], static_cast<DomainSide>(other_side(static_cast<std::size_t>(to))));
+    auto written = target.written.load(std::memory_order_relaxed);
+    auto read = target.read.load(std::memory_order_acquire);
+    auto n = std::min<std::size_t>(data.size(), ring_bytes_ - static_cast<std::size_t>(written - read));
+    auto offset = static_cast<std::size_t>(written % ring_bytes_);
+    auto first = std::min(n, ring_bytes_ - offset);
+    std::memcpy(target.data() + offset, data.data(), first);
+    std::memcpy(target.data(), data.data() + first, n - first);
+    target.written.store(written + n, std::memory_order_release);
+    return n;
+}
+
+std::size_t SharedMemoryDomainTransport::receive_some(DomainSide from, std::span<std::byte> buffer) {
+    auto &source = ring(own_, from);
+    auto read = source.read.load(std::memory_order_relaxed);
+    auto written = source.written.load(std::memory_order_acquire);
+    auto n = std::min<std::size_t>(buffer.size(), static_cast<std::size_t>(written - read));
+    auto offset = static_cast<std::size_t>(read % ring_bytes_);
+    auto first = std::min(n, ring_bytes_ - offset);
+    std::memcpy(buffer.data(), source.data() + offset, first);
+    std::memcpy(buffer.data() + first, source.data(), n - first);
+    source.read.store(read + n, std::memory_order_release);
+    return n;
+}
+
+void SharedMemoryDomainTransport::wait() {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= next_liveness_check_) {
+        next_liveness_check_ = now + LIVENESS_CHECK_INTERVAL;
+        check_neighbors_alive();
+    }
+    std::this_thread::yield();
+}
+
+void SharedMemoryDomainTransport::check_neighbors_alive() const {
+#ifndef _WIN32
+    for (auto const &segment : neighbors_) {
+        auto pid = std::launder(reinterpret_cast<SegmentHeader const *>(segment.data))->owner_pid;
+        if (pid != 0 && kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH) {
+            throw std::runtime_error(std::format("Domain neighbor owning '{}' (pid {}) has exited", segment.name, pid));
+        }
+    }
+#endif
+}
@@ -0,0 +1,117 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_DOMAIN_TRANSPORT_HPP
+#define SDL_GLEW_TEST_DOMAIN_TRANSPORT_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "tcp_socket.hpp"
+
+// Domains sit in a ring, each exchanging messages with the one on either side.
+enum class DomainSide {
+    Left = 0,
+    Right = 1,
+};
+
+// Carries messages between the processes simulating neighboring domains. Each
+// domain sends one message to each neighbor per exchange; what a domain sends
+// to its right arrives as the message from the left of the domain there.
+class DomainTransport {
+public:
+    virtual ~DomainTransport() = default;
+
+    // Sends a message to each neighbor and returns the one each sent back, both
+    // indexed by DomainSide. Sends and receives progress together, so that two
+    // domains sending each other more than the transport buffers cannot block
+    // each other. Throws if a neighbor stops taking part.
+    [[nodiscard]] std::array<std::vector<std::byte>, 2> exchange(std::array<std::span<std::byte const>, 2> outgoing);
+
+    [[nodiscard]] std::uint64_t bytes_sent() const noexcept;
+
+protected:
+    // Both transfer what they can without waiting and return the number of bytes.
+    virtual std::size_t send_some(DomainSide to, std::span<std::byte const> data) = 0;
+    virtual std::size_t receive_some(DomainSide from, std::span<std::byte> buffer) = 0;
+    // Called when neither direction made progress, to wait briefly for some.
+    virtual void wait() = 0;
+
+private:
+    std::uint64_t bytes_sent_ = 0;
+};
+
+// A TCP connection to each neighbor. Domain `rank` listens on base_port + rank
+// of hosts[rank], connects to its right neighbor and accepts its left one,
+// retrying for a while so that domains can be started in any order.
+class TcpDomainTransport final : public DomainTransport {
+public:
+    TcpDomainTransport(std::size_t rank, std::vector<std::string> const &hosts, std::uint16_t base_port);
+
+protected:
+    std::size_t send_some(DomainSide to, std::span<std::byte const> data) override;
+    std::size_t receive_some(DomainSide from, std::span<std::byte> buffer) override;
+    void wait() override;
+
+private:
+    // Indexed by DomainSide.
+    std::vector<TcpSocket> sockets_;
+};
+
+// A byte ring per direction in shared memory, for domains on one machine. Each
+// domain creates a segment named `<name>_<rank>` holding the rings it reads
+// from, and maps those of its neighbors to write into. Names must be unique to
+// the run, as a segment left behind by another run would be mistaken for a
+// neighbor's. Each segment records the process that created it, so that a
+// domain waiting on a neighbor notices when that process has exited.
+class SharedMemoryDomainTransport final : public DomainTransport {
+public:
+    static constexpr std::size_t DEFAULT_RING_BYTES = 8 * 1024 * 1024;
+
+    SharedMemoryDomainTransport(std::string const &name, std::size_t rank, std::size_t domain_count, std::size_t ring_bytes = DEFAULT_RING_BYTES);
+    ~SharedMemoryDomainTransport() noexcept override;
+
+    SharedMemoryDomainTransport(SharedMemoryDomainTransport const &other) = delete;
+    SharedMemoryDomainTransport(SharedMemoryDomainTransport &&other) = delete;
+    SharedMemoryDomainTransport &operator=(SharedMemoryDomainTransport const &other) = delete;
+    SharedMemoryDomainTransport &operator=(SharedMemoryDomainTransport &&other) = delete;
+
+protected:
+    std::size_t send_some(DomainSide to, std::span<std::byte const> data) override;
+    std::size_t receive_some(DomainSide from, std::span<std::byte> buffer) override;
+    void wait() override;
+
+private:
+    struct Segment {
+        std::string name;
+        std::byte *data = nullptr;
+        std::size_t size = 0;
+#ifdef _WIN32
+        void *mapping = nullptr;
+#endif
+    };
+
+    struct Ring;
+
+    void create(Segment &segment);
+    void open(Segment &segment);
+    static void unmap(Segment &segment) noexcept;
+    [[nodiscard]] Ring &ring(Segment const &segment, DomainSide from) const noexcept;
+    // Throws if the process owning either neighbor's segment is gone.
+    void check_neighbors_alive() const;
+
+    std::size_t ring_bytes_;
+    std::size_t segment_bytes_;
+    Segment own_;
+    // The segments of the left and right neighbors; the same one twice with two domains.
+    std::array<Segment, 2> neighbors_;
+    std::chrono::steady_clock::time_point next_liveness_check_;
+};
+
+#endif //SDL_GLEW_TEST_DOMAIN_TRANSPORT_HPP
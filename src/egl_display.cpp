@@ -0,0 +1,69 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "egl_display.hpp"
+
+#include <format>
+#include <stdexcept>
+#include <string_view>
+
+#include "EGL/eglext.h"
+#include "SDL_log.h"
+
+// Extension strings are space-separated names, some of which prefix others.
+static bool has_extension(char const *extensions, std::string_view name) noexcept {
+    if (extensions == nullptr) {
+        return false;
+    }
+    std::string_view rest = extensions;
+    while (!rest.empty()) {
+        auto space = rest.find(' ');
+        if (rest.substr(0, space) == name) {
+            return true;
+        }
+        rest = (space == std::string_view::npos) ? std::string_view{} : rest.substr(space + 1);
+    }
+    return false;
+}
+
+EglDisplay::EglDisplay() {
+    // Client extensions are queried without a display; implementations without
+    // any return null and set an error, which is of no interest here.
+    auto client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    eglGetError();
+    auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display != nullptr && has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+        display_ = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    } else {
+        display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display_ == EGL_NO_DISPLAY) {
+        throw_current_error("Error getting an EGL display");
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (!eglInitialize(display_, &major, &minor)) {
+        throw_current_error("Error initializing EGL");
+    }
+    surfaceless_ = has_extension(eglQueryString(display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    SDL_Log("EGL %d.%d from %s, %s", major, minor, eglQueryString(display_, EGL_VENDOR),
+            surfaceless_ ? "surfaceless" : "rendering beside a pbuffer");
+}
+
+EglDisplay::~EglDisplay() noexcept {
+    eglTerminate(display_);
+}
+
+EGLDisplay EglDisplay::inner() const noexcept {
+    return display_;
+}
+
+bool EglDisplay::surfaceless() const noexcept {
+    return surfaceless_;
+}
+
+void EglDisplay::throw_current_error(char const *msg) const {
+    throw std::runtime_error(std::format("{}: EGL error {:#x}", msg, eglGetError()));
+}
@@ -0,0 +1,38 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_EGL_DISPLAY_HPP
+#define SDL_GLEW_TEST_EGL_DISPLAY_HPP
+
+#include "EGL/egl.h"
+
+// An initialized EGL display, for OpenGL contexts that no window system backs.
+// Mesa's surfaceless platform is used where the EGL implementation offers it:
+// it needs neither an X server nor a GPU, and renders with llvmpipe on machines
+// without one. Elsewhere the default display is used.
+class EglDisplay {
+public:
+    EglDisplay();
+    ~EglDisplay() noexcept;
+
+    EglDisplay(EglDisplay const &other) = delete;
+    EglDisplay(EglDisplay &&other) = delete;
+    EglDisplay &operator=(EglDisplay const &other) = delete;
+    EglDisplay &operator=(EglDisplay &&other) = delete;
+
+    [[nodiscard]] EGLDisplay inner() const noexcept;
+
+    // Whether contexts can be made current without any surface, as the
+    // surfaceless platform allows, rather than with a placeholder pbuffer.
+    [[nodiscard]] bool surfaceless() const noexcept;
+
+    // Throws with the last EGL error of this thread.
+    [[noreturn]] void throw_current_error(char const *msg) const;
+
+private:
+    EGLDisplay display_;
+    bool surfaceless_;
+};
+
+#endif //SDL_GLEW_TEST_EGL_DISPLAY_HPP
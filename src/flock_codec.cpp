@@ -0,0 +1,95 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "flock_codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+constexpr GLfloat POS_RANGE = 65536;
+
+FlockQuantizer::FlockQuantizer(Boid::Mindset const &mindset, WorldBounds const &bounds, std::int32_t velocity_levels) noexcept:
+    min_(bounds.min),
+    velocity_levels_(std::clamp<long>(velocity_levels, 1, FULL_VELOCITY_LEVELS))
+{
+    auto max_movement = (mindset.maximum_movement > 0) ? mindset.maximum_movement : 1.0f;
+    velocity_step_ = max_movement / static_cast<GLfloat>(velocity_levels_);
+    for (int i = 0; i < 3; ++i) {
+        auto extent = bounds.max[i] - bounds.min[i];
+        pos_step_[i] = extent / POS_RANGE;
+        velocity_to_pos_[i] = velocity_step_ / pos_step_[i];
+    }
+}
+
+std::uint16_t FlockQuantizer::pos(GLfloat value, int axis) const noexcept {
+    auto q = std::floor((value - min_[axis]) / pos_step_[axis]);
+    return static_cast<std::uint16_t>(std::clamp(q, 0.0f, POS_RANGE - 1));
+}
+
+std::int16_t FlockQuantizer::velocity(GLfloat value) const noexcept {
+    auto q = std::lround(value / velocity_step_);
+    return static_cast<std::int16_t>(std::clamp<long>(q, -velocity_levels_, velocity_levels_));
+}
+
+GLfloat FlockQuantizer::unpack_pos(std::uint16_t q, int axis) const noexcept {
+    return min_[axis] + (static_cast<GLfloat>(q) + 0.5f) * pos_step_[axis];
+}
+
+GLfloat FlockQuantizer::unpack_velocity(std::int16_t q) const noexcept {
+    return static_cast<GLfloat>(q) * velocity_step_;
+}
+
+QuantizedBoid FlockQuantizer::quantize(Boid const &boid) const noexcept {
+    QuantizedBoid ret;
+    for (int i = 0; i < 3; ++i) {
+        ret.pos[i] = pos(boid.pos[i], i);
+        ret.velocity[i] = velocity(boid.velocity[i]);
+    }
+    return ret;
+}
+
+Boid FlockQuantizer::unpack(QuantizedBoid const &q) const noexcept {
+    Boid ret;
+    for (int i = 0; i < 3; ++i) {
+        ret.pos[i] = unpack_pos(q.pos[i], i);
+        ret.velocity[i] = unpack_velocity(q.velocity[i]);
+    }
+    return ret;
+}
+
+std::uint16_t FlockQuantizer::predict(std::uint16_t pos, std::int16_t velocity, int axis, std::uint64_t steps) const noexcept {
+    return static_cast<std::uint16_t>(pos + std::lround(velocity * velocity_to_pos_[axis] * static_cast<GLfloat>(steps)));
+}
+
+std::uint32_t zigzag(std::int32_t n) noexcept {
+    return (static_cast<std::uint32_t>(n) << 1) ^ static_cast<std::uint32_t>(n >> 31);
+}
+
+std::int32_t unzigzag(std::uint32_t n) noexcept {
+    return static_cast<std::int32_t>(n >> 1) ^ -static_cast<std::int32_t>(n & 1);
+}
+
+void write_varint(std::vector<std::uint8_t> &out, std::uint32_t n) {
+    while (n >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(n | 0x80));
+        n >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(n));
+}
+
+std::uint8_t const *read_varint(std::uint8_t const *p, std::uint8_t const *end, std::uint32_t &n) {
+    n = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p == end) {
+            throw std::runtime_error("Truncated varint in flock data");
+        }
+        auto byte = *p++;
+        n |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return p;
+        }
+    }
+    throw std::runtime_error("Malformed varint in flock data");
+}
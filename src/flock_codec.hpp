@@ -0,0 +1,55 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_FLOCK_CODEC_HPP
+#define SDL_GLEW_TEST_FLOCK_CODEC_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+#include "simulation.hpp"
+
+struct QuantizedBoid {
+    std::uint16_t pos[3];
+    std::int16_t velocity[3];
+};
+
+// Quantization shared by replays and network streams: positions become 16-bit
+// fractions of the world box, so that wrapping around the box is wrapping
+// around the integers, and velocities fractions of the maximum movement, in
+// steps of 1/velocity_levels (at most 32767).
+class FlockQuantizer {
+public:
+    static constexpr std::int32_t FULL_VELOCITY_LEVELS = 32767;
+
+    FlockQuantizer(Boid::Mindset const &mindset, WorldBounds const &bounds, std::int32_t velocity_levels = FULL_VELOCITY_LEVELS) noexcept;
+
+    [[nodiscard]] std::uint16_t pos(GLfloat value, int axis) const noexcept;
+    [[nodiscard]] std::int16_t velocity(GLfloat value) const noexcept;
+    [[nodiscard]] GLfloat unpack_pos(std::uint16_t q, int axis) const noexcept;
+    [[nodiscard]] GLfloat unpack_velocity(std::int16_t q) const noexcept;
+    [[nodiscard]] QuantizedBoid quantize(Boid const &boid) const noexcept;
+    [[nodiscard]] Boid unpack(QuantizedBoid const &q) const noexcept;
+
+    // Where a boid at `pos` moving at `velocity` is `steps` steps later, wrapped around the box.
+    [[nodiscard]] std::uint16_t predict(std::uint16_t pos, std::int16_t velocity, int axis, std::uint64_t steps = 1) const noexcept;
+
+private:
+    Vec3<GLfloat> min_;
+    long velocity_levels_;
+    GLfloat pos_step_[3];
+    GLfloat velocity_step_;
+    GLfloat velocity_to_pos_[3];
+};
+
+// Variable-length coding of small signed residuals.
+[[nodiscard]] std::uint32_t zigzag(std::int32_t n) noexcept;
+[[nodiscard]] std::int32_t unzigzag(std::uint32_t n) noexcept;
+void write_varint(std::vector<std::uint8_t> &out, std::uint32_t n);
+// Throws if the varint runs past `end`.
+std::uint8_t const *read_varint(std::uint8_t const *p, std::uint8_t const *end, std::uint32_t &n);
+
+#endif //SDL_GLEW_TEST_FLOCK_CODEC_HPP
@@ -0,0 +1,222 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+#include "SDL_log.h"
+
+constexpr char const *PHASE_NAMES[FrameProfiler::PHASE_COUNT] = {
+    "events",
+    "simulate",
+    "upload",
+    "draw",
+    "swap",
+    "delay",
+};
+
+constexpr double NO_SAMPLE = std::numeric_limits<double>::quiet_NaN();
+
+FrameProfiler::FrameProfiler(std::size_t window_frames):
+    window_(std::max<std::size_t>(window_frames, 1)),
+    frame_(0),
+    gpu_timers_supported_(GLEW_ARB_timer_query),
+    gpu_queries_{},
+    next_gpu_query_{},
+    lost_gpu_samples_(0)
+{
+    for (auto &sample : window_) {
+        sample.frame = std::numeric_limits<std::uint64_t>::max();
+    }
+    if (gpu_timers_supported_) {
+        for (auto &ring : gpu_queries_) {
+            for (auto &q : ring) {
+                glGenQueries(1, &q.query);
+            }
+        }
+    }
+}
+
+FrameProfiler::~FrameProfiler() noexcept {
+    if (gpu_timers_supported_) {
+        for (auto &ring : gpu_queries_) {
+            for (auto &q : ring) {
+                glDeleteQueries(1, &q.query);
+            }
+        }
+    }
+}
+
+void FrameProfiler::begin_frame() {
+    auto &sample = window_[frame_ % window_.size()];
+    sample.frame = frame_;
+    sample.cpu_ms.fill(0);
+    sample.gpu_ms.fill(NO_SAMPLE);
+}
+
+void FrameProfiler::end_frame() {
+    collect_gpu_results();
+    ++frame_;
+}
+
+void FrameProfiler::record_cpu(FramePhase phase, double ms) noexcept {
+    window_[frame_ % window_.size()].cpu_ms[static_cast<std::size_t>(phase)] += ms;
+}
+
+void FrameProfiler::begin_gpu(FramePhase phase) {
+    if (!gpu_timers_supported_) {
+        return;
+    }
+    auto phase_idx = static_cast<std::size_t>(phase);
+    auto &q = gpu_queries_[phase_idx][next_gpu_query_[phase_idx]];
+    next_gpu_query_[phase_idx] = (next_gpu_query_[phase_idx] + 1) % QUERY_RING_SIZE;
+
+    // The ring has wrapped onto a query that is still in flight. Waiting for it
+    // would stall on the GPU, so its sample is given up instead.
+    if (q.pending && !read_query(q, phase_idx)) {
+        ++lost_gpu_samples_;
+    }
+    q.frame = frame_;
+    q.pending = true;
+    glBeginQuery(GL_TIME_ELAPSED, q.query);
+}
+
+void FrameProfiler::end_gpu() {
+    if (gpu_timers_supported_) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+FrameProfiler::FrameSample *FrameProfiler::sample_for_frame(std::uint64_t frame) noexcept {
+    auto &sample = window_[frame % window_.size()];
+    return (sample.frame == frame)? &sample : nullptr;
+}
+
+void FrameProfiler::collect_gpu_results() {
+    if (!gpu_timers_supported_) {
+        return;
+    }
+    for (std::size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+        for (auto &q : gpu_queries_[phase]) {
+            if (q.pending) {
+                read_query(q, phase);
+            }
+        }
+    }
+}
+
+bool FrameProfiler::read_query(GpuQuery &q, std::size_t phase) {
+    GLint available = 0;
+    glGetQueryObjectiv(q.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+    GLuint64 ns;
+    glGetQueryObjectui64v(q.query, GL_QUERY_RESULT, &ns);
+    q.pending = false;
+    if (auto *sample = sample_for_frame(q.frame)) {
+        sample->gpu_ms[phase] = static_cast<double>(ns) / 1e6;
+    }
+    return true;
+}
+
+FrameProfiler::Percentiles FrameProfiler::percentiles(
+    std::array<double, PHASE_COUNT> FrameSample::*times,
+    FramePhase phase) const
+{
+    std::vector<double> values;
+    values.reserve(window_.size());
+    for (auto const &sample : window_) {
+        auto value = (sample.*times)[static_cast<std::size_t>(phase)];
+        if (sample.frame < frame_ && !std::isnan(value)) {
+            values.push_back(value);
+        }
+    }
+    if (values.empty()) {
+        return {NO_SAMPLE, NO_SAMPLE, NO_SAMPLE};
+    }
+
+    auto nth = [&](double p) {
+        auto idx = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(idx), values.end());
+        return values[idx];
+    };
+    return {nth(0.50), nth(0.95), nth(0.99)};
+}
+
+FrameProfiler::Percentiles FrameProfiler::cpu_percentiles(FramePhase phase) const {
+    return percentiles(&FrameSample::cpu_ms, phase);
+}
+
+FrameProfiler::Percentiles FrameProfiler::gpu_percentiles(FramePhase phase) const {
+    return percentiles(&FrameSample::gpu_ms, phase);
+}
+
+void FrameProfiler::write_csv(char const *path) const {
+    FILE *file;
+    if (fopen_s(&file, path, "w") != 0) {
+        throw std::runtime_error(std::format("Could not open profile output '{}'", path));
+    }
+
+    fputs("frame", file);
+    for (auto const *name : PHASE_NAMES) {
+        fprintf(file, ",%s_cpu_ms", name);
+    }
+    for (auto const *name : PHASE_NAMES) {
+        fprintf(file, ",%s_gpu_ms", name);
+    }
+    fputc('\n', file);
+
+    auto count = std::min<std::uint64_t>(frame_, window_.size());
+    for (auto frame = frame_ - count; frame < frame_; ++frame) {
+        auto const &sample = window_[frame % window_.size()];
+        fprintf(file, "%llu", static_cast<unsigned long long>(sample.frame));
+        for (double ms : sample.cpu_ms) {
+            fprintf(file, ",%.4f", ms);
+        }
+        for (double ms : sample.gpu_ms) {
+            if (std::isnan(ms)) {
+                fputc(',', file);
+            } else {
+                fprintf(file, ",%.4f", ms);
+            }
+        }
+        fputc('\n', file);
+    }
+
+    if (fclose(file) != 0) {
+        throw std::runtime_error(std::format("Error writing profile output '{}'", path));
+    }
+}
+
+void FrameProfiler::log_summary() const {
+    for (std::size_t i = 0; i < PHASE_COUNT; ++i) {
+        auto phase = static_cast<FramePhase>(i);
+        auto cpu = cpu_percentiles(phase);
+        auto gpu = gpu_percentiles(phase);
+        SDL_Log("%-10s cpu p50 %.3f p95 %.3f p99 %.3f ms | gpu p50 %.3f p95 %.3f p99 %.3f ms",
+                PHASE_NAMES[i], cpu.p50, cpu.p95, cpu.p99, gpu.p50, gpu.p95, gpu.p99);
+    }
+    if (lost_gpu_samples_ != 0) {
+        SDL_Log("%llu GPU samples lost to a GPU more than %zu frames behind",
+                static_cast<unsigned long long>(lost_gpu_samples_), QUERY_RING_SIZE);
+    }
+}
+
+ProfileScope::ProfileScope(FrameProfiler &profiler, FramePhase phase) noexcept:
+    profiler_(&profiler),
+    phase_(phase),
+    start_(std::chrono::steady_clock::now())
+{}
+
+ProfileScope::~ProfileScope() noexcept {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_;
+    profiler_->record_cpu(phase_, elapsed.count());
+}
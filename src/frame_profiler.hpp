@@ -0,0 +1,131 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_FRAME_PROFILER_HPP
+#define SDL_GLEW_TEST_FRAME_PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GL/glew.h"
+
+enum class FramePhase {
+    Events,
+    // Reported by the simulation thread for each step the renderer consumes.
+    Simulate,
+    Upload,
+    Draw,
+    Swap,
+    Delay,
+    Count,
+};
+
+// Collects CPU and GPU time per frame phase over a rolling window of frames.
+// GPU times come from GL_TIME_ELAPSED queries kept in a small ring per phase and
+// read back a few frames later, so measuring never stalls the pipeline: when the
+// GPU falls more than QUERY_RING_SIZE frames behind, the oldest samples are lost
+// rather than waited for.
+// Only one GPU phase may be open at a time.
+class FrameProfiler {
+public:
+    static constexpr std::size_t PHASE_COUNT = static_cast<std::size_t>(FramePhase::Count);
+
+    struct Percentiles {
+        double p50;
+        double p95;
+        double p99;
+    };
+
+    explicit FrameProfiler(std::size_t window_frames = 3600);
+    ~FrameProfiler() noexcept;
+
+    FrameProfiler(FrameProfiler const &other) = delete;
+    FrameProfiler(FrameProfiler &&other) = delete;
+    FrameProfiler &operator=(FrameProfiler const &other) = delete;
+    FrameProfiler &operator=(FrameProfiler &&other) = delete;
+
+    void begin_frame();
+    void end_frame();
+
+    void record_cpu(FramePhase phase, double ms) noexcept;
+    void begin_gpu(FramePhase phase);
+    void end_gpu();
+
+    // Percentiles of the frames currently in the window; GPU samples still in flight are skipped.
+    [[nodiscard]] Percentiles cpu_percentiles(FramePhase phase) const;
+    [[nodiscard]] Percentiles gpu_percentiles(FramePhase phase) const;
+
+    void write_csv(char const *path) const;
+    void log_summary() const;
+
+private:
+    static constexpr std::size_t QUERY_RING_SIZE = 4;
+
+    struct FrameSample {
+        std::uint64_t frame;
+        std::array<double, PHASE_COUNT> cpu_ms;
+        std::array<double, PHASE_COUNT> gpu_ms;
+    };
+
+    struct GpuQuery {
+        GLuint query;
+        std::uint64_t frame;
+        bool pending;
+    };
+
+    [[nodiscard]] FrameSample *sample_for_frame(std::uint64_t frame) noexcept;
+    void collect_gpu_results();
+    // Stores the query's result in its frame's sample if it is available yet.
+    bool read_query(GpuQuery &q, std::size_t phase);
+    [[nodiscard]] Percentiles percentiles(std::array<double, PHASE_COUNT> FrameSample::*times, FramePhase phase) const;
+
+    std::vector<FrameSample> window_;
+    std::uint64_t frame_;
+    bool gpu_timers_supported_;
+    std::array<std::array<GpuQuery, QUERY_RING_SIZE>, PHASE_COUNT> gpu_queries_;
+    std::array<std::size_t, PHASE_COUNT> next_gpu_query_;
+    std::uint64_t lost_gpu_samples_;
+};
+
+// Records the CPU time spent in its enclosing scope.
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler &profiler, FramePhase phase) noexcept;
+    ~ProfileScope() noexcept;
+
+    ProfileScope(ProfileScope const &other) = delete;
+    ProfileScope(ProfileScope &&other) = delete;
+    ProfileScope &operator=(ProfileScope const &other) = delete;
+    ProfileScope &operator=(ProfileScope &&other) = delete;
+
+private:
+    FrameProfiler *profiler_;
+    FramePhase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// The profiler is compiled in only with BOIDS_ENABLE_PROFILER; otherwise these
+// expand to nothing and the profiler object is never referenced.
+#ifdef BOIDS_ENABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_CPU_SCOPE(profiler, phase) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)((profiler), (phase))
+#define PROFILE_CPU_RECORD(profiler, phase, ms) (profiler).record_cpu((phase), (ms))
+#define PROFILE_GPU_BEGIN(profiler, phase) (profiler).begin_gpu(phase)
+#define PROFILE_GPU_END(profiler) (profiler).end_gpu()
+#define PROFILE_FRAME_BEGIN(profiler) (profiler).begin_frame()
+#define PROFILE_FRAME_END(profiler) (profiler).end_frame()
+#else
+#define PROFILE_CPU_SCOPE(profiler, phase) ((void)0)
+#define PROFILE_CPU_RECORD(profiler, phase, ms) ((void)0)
+#define PROFILE_GPU_BEGIN(profiler, phase) ((void)0)
+#define PROFILE_GPU_END(profiler) ((void)0)
+#define PROFILE_FRAME_BEGIN(profiler) ((void)0)
+#define PROFILE_FRAME_END(profiler) ((void)0)
+#endif
+
+#endif //SDL_GLEW_TEST_FRAME_PROFILER_HPP
@@ -4,6 +4,7 @@
 
 #include "gl_session.hpp"
 
+#include <format>
 #include <stdexcept>
 #include <string>
 #include "GL/glew.h"
@@ -11,6 +12,9 @@
 #include "sdl_session.hpp"
 #include "sdl_window.hpp"
 #include "gl_shader_program.hpp"
+#ifdef BOIDS_ENABLE_HEADLESS
+#include "egl_display.hpp"
+#endif
 
 GLSession::GLSession(const SdlSession &sdl, const SdlWindow &window, GLConfig config) {
     if (SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, config.major_version) != 0) {
@@ -34,7 +38,80 @@ GLSession::GLSession(const SdlSession &sdl, const SdlWindow &window, GLConfig co
     }
 }
 
+#ifdef BOIDS_ENABLE_HEADLESS
+static void destroy_egl_context(EGLDisplay display, EGLContext context, EGLSurface surface) noexcept {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE) {
+        eglDestroySurface(display, surface);
+    }
+    eglDestroyContext(display, context);
+}
+
+GLSession::GLSession(EglDisplay const &display, GLConfig config): egl_display_(display.inner()) {
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        display.throw_current_error("Error selecting the OpenGL API");
+    }
+
+    // Pbuffer support is asked for even when rendering surfaceless, as every
+    // config that renders offscreen has it.
+    EGLint const config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE,
+    };
+    EGLConfig egl_config = nullptr;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(egl_display_, config_attributes, &egl_config, 1, &config_count)) {
+        display.throw_current_error("Error choosing an EGL config");
+    }
+    if (config_count == 0) {
+        throw std::runtime_error("No EGL config renders OpenGL offscreen");
+    }
+
+    EGLint const context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, config.major_version,
+        EGL_CONTEXT_MINOR_VERSION, config.minor_version,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    egl_context_ = eglCreateContext(egl_display_, egl_config, EGL_NO_CONTEXT, context_attributes);
+    if (egl_context_ == EGL_NO_CONTEXT) {
+        display.throw_current_error("Error creating OpenGL context");
+    }
+
+    if (!display.surfaceless()) {
+        EGLint const pbuffer_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        egl_surface_ = eglCreatePbufferSurface(egl_display_, egl_config, pbuffer_attributes);
+        if (egl_surface_ == EGL_NO_SURFACE) {
+            auto err = eglGetError();
+            destroy_egl_context(egl_display_, egl_context_, egl_surface_);
+            throw std::runtime_error(std::format("Error creating a pbuffer: EGL error {:#x}", err));
+        }
+    }
+
+    if (!eglMakeCurrent(egl_display_, egl_surface_, egl_surface_, egl_context_)) {
+        auto err = eglGetError();
+        destroy_egl_context(egl_display_, egl_context_, egl_surface_);
+        throw std::runtime_error(std::format("Error making the OpenGL context current: EGL error {:#x}", err));
+    }
+
+    // GLEW built for GLX loads the GL functions first, then fails to open an X
+    // display for GLX's own, which headless runs never call.
+    if (GLenum err = glewInit(); err != GLEW_OK && err != GLEW_ERROR_NO_GLX_DISPLAY) {
+        destroy_egl_context(egl_display_, egl_context_, egl_surface_);
+        auto glew_err_string = reinterpret_cast<char const *>(glewGetErrorString(err));
+        throw std::runtime_error(std::string("Error initializing GLEW: ") + glew_err_string);
+    }
+}
+#endif
+
 GLSession::~GLSession() noexcept {
+#ifdef BOIDS_ENABLE_HEADLESS
+    if (egl_context_ != EGL_NO_CONTEXT) {
+        destroy_egl_context(egl_display_, egl_context_, egl_surface_);
+        return;
+    }
+#endif
     SDL_GL_DeleteContext(gl_context_);
 }
 
@@ -6,6 +6,9 @@
 #define SDL_GLEW_TEST_GL_SESSION_HPP
 
 #include "SDL_video.h"
+#ifdef BOIDS_ENABLE_HEADLESS
+#include "EGL/egl.h"
+#endif
 
 struct GLConfig {
     int major_version;
@@ -14,11 +17,17 @@ struct GLConfig {
 
 class SdlSession;
 class SdlWindow;
+class EglDisplay;
 class GLShaderProgram;
 
 class GLSession {
 public:
     GLSession(SdlSession const &sdl, SdlWindow const &window, GLConfig config);
+#ifdef BOIDS_ENABLE_HEADLESS
+    // A core profile context without a window, for rendering into framebuffer
+    // objects only; the default framebuffer is either absent or a 1x1 pbuffer.
+    GLSession(EglDisplay const &display, GLConfig config);
+#endif
 
     ~GLSession() noexcept;
 
@@ -30,7 +39,13 @@ public:
     void use_program(GLShaderProgram const &program) const;
 
 private:
-    SDL_GLContext gl_context_;
+    SDL_GLContext gl_context_ = nullptr;
+#ifdef BOIDS_ENABLE_HEADLESS
+    // Set instead of gl_context_ by the headless constructor.
+    EGLDisplay egl_display_ = EGL_NO_DISPLAY;
+    EGLContext egl_context_ = EGL_NO_CONTEXT;
+    EGLSurface egl_surface_ = EGL_NO_SURFACE;
+#endif
 };
 
 
@@ -3,9 +3,11 @@
 //
 
 #include "gl_shader_program.hpp"
+#include "trace.hpp"
 
 #include <stdexcept>
 #include <format>
+#include <utility>
 
 class GLShaderCompiler {
 public:
@@ -52,6 +54,10 @@ public:
         fragment_shader_ = compile_shader(GL_FRAGMENT_SHADER, "fragment shader", src);
     }
 
+    void set_transform_feedback_varyings(std::span<char const * const> varyings) const {
+        glTransformFeedbackVaryings(program_, static_cast<GLsizei>(varyings.size()), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    }
+
     void link() const {
         glLinkProgram(program_);
         if (
@@ -142,6 +148,11 @@ GLShaderProgramBuilder &GLShaderProgramBuilder::fragment_shader(std::string_view
     return *this;
 }
 
+GLShaderProgramBuilder &GLShaderProgramBuilder::transform_feedback_varyings(std::vector<char const *> varyings) {
+    transform_feedback_varyings_ = std::move(varyings);
+    return *this;
+}
+
 GLShaderProgram GLShaderProgramBuilder::build(GLSession const &gl) const {
     return {gl, *this};
 }
@@ -154,11 +165,16 @@ std::string_view GLShaderProgramBuilder::get_fragment_shader() const {
     return fragment_shader_src_;
 }
 
+std::span<char const * const> GLShaderProgramBuilder::get_transform_feedback_varyings() const {
+    return transform_feedback_varyings_;
+}
+
 GLuint GLShaderProgram::inner() const {
     return program_;
 }
 
 GLShaderProgram::GLShaderProgram(GLSession const &gl, const GLShaderProgramBuilder &builder) {
+    TRACE_SCOPE("compile_shader_program", "gl");
     GLShaderCompiler compiler(gl);
     if (auto src = builder.get_vertex_shader(); !src.empty()) {
         compiler.compile_vertex_shader(src);
@@ -168,6 +184,10 @@ GLShaderProgram::GLShaderProgram(GLSession const &gl, const GLShaderProgramBuild
         compiler.compile_fragment_shader(src);
     }
 
+    if (auto varyings = builder.get_transform_feedback_varyings(); !varyings.empty()) {
+        compiler.set_transform_feedback_varyings(varyings);
+    }
+
     compiler.link();
     program_ = std::move(compiler).into_program();
 }
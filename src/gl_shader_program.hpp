@@ -7,6 +7,8 @@
 
 #include <string_view>
 #include <optional>
+#include <span>
+#include <vector>
 #include "GL/glew.h"
 
 
@@ -40,15 +42,19 @@ public:
     GLShaderProgramBuilder() = default;
     GLShaderProgramBuilder &vertex_shader(std::string_view src);
     GLShaderProgramBuilder &fragment_shader(std::string_view src);
+    // Vertex shader outputs captured by transform feedback, interleaved into one buffer.
+    GLShaderProgramBuilder &transform_feedback_varyings(std::vector<char const *> varyings);
 
     [[nodiscard]] GLShaderProgram build(GLSession const &gl) const;
 
     [[nodiscard]] std::string_view get_vertex_shader() const;
     [[nodiscard]] std::string_view get_fragment_shader() const;
+    [[nodiscard]] std::span<char const * const> get_transform_feedback_varyings() const;
 
 private:
     std::string_view vertex_shader_src_;
     std::string_view fragment_shader_src_;
+    std::vector<char const *> transform_feedback_varyings_;
 };
 
 
@@ -0,0 +1,247 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "gpu_simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "gl_session.hpp"
+#include "interaction.hpp"
+#include "trace.hpp"
+
+// One boid as stored on the GPU; buffer textures hold one, two or four
+// components per texel, so both vectors are padded to four.
+struct GpuBoid {
+    GLfloat pos[4];
+    GLfloat velocity[4];
+};
+
+// The state buffer texture is bound here, clear of the units used for drawing.
+constexpr GLint STATE_TEXTURE_UNIT = 1;
+
+// Boid::consider, SituationalAwareness::into_decision and Boid::act_upon, for
+// the boid at gl_VertexID, followed by WorldBounds::wrap.
+constexpr char const *STEP_SHADER_SOURCE = R"(
+    #version 330 core
+    layout (location = 0) in vec4 aPos;
+    layout (location = 1) in vec4 aVelocity;
+
+    out vec4 vPos;
+    out vec4 vVelocity;
+
+    // Texels 2i and 2i + 1 are the position and velocity of boid i.
+    uniform samplerBuffer uState;
+    uniform int uCount;
+    uniform float uRadiusSq;
+    // obstacle_avoiding_bias, centering_bias, conforming_bias, maximum_movement
+    uniform vec4 uMindset;
+    uniform vec3 uBoundsMin;
+    uniform vec3 uBoundsMax;
+
+    float accumulate_movement(inout vec3 acc, float remaining_movement_sq, vec3 movement) {
+        float msq = dot(movement, movement);
+        if (msq < remaining_movement_sq) {
+            acc += movement;
+            return remaining_movement_sq - msq;
+        }
+        acc += sqrt(remaining_movement_sq / msq) * movement;
+        return 0.0;
+    }
+
+    void main() {
+        vec3 pos = aPos.xyz;
+        vec3 velocity = aVelocity.xyz;
+
+        float total_inv_dist_sq = 0.0;
+        vec3 total_scaled_directions = vec3(0.0);
+        vec3 total_scaled_velocities = vec3(0.0);
+        for (int j = 0; j < uCount; ++j) {
+            vec3 diff = texelFetch(uState, 2 * j).xyz - pos;
+            float dist_sq = dot(diff, diff);
+            if (j != gl_VertexID && dist_sq < uRadiusSq) {
+                float inv_dist_sq = 1.0 / max(dist_sq, 0.00001);
+                total_inv_dist_sq += inv_dist_sq;
+                total_scaled_directions += inv_dist_sq * diff;
+                total_scaled_velocities += inv_dist_sq * texelFetch(uState, 2 * j + 1).xyz;
+            }
+        }
+
+        // Nobody in sight: keep going the same way.
+        vec3 decision = velocity;
+        if (total_inv_dist_sq > 0.0) {
+            vec3 influences[3] = vec3[3](
+                uMindset.x * -total_scaled_directions,
+                uMindset.z / total_inv_dist_sq * total_scaled_velocities,
+                uMindset.y / total_inv_dist_sq * total_scaled_directions
+            );
+            float remaining_movement_sq = uMindset.w * uMindset.w;
+            decision = vec3(0.0);
+            for (int i = 0; i < 3 && remaining_movement_sq != 0.0; ++i) {
+                remaining_movement_sq = accumulate_movement(decision, remaining_movement_sq, influences[i]);
+            }
+        }
+
+        pos += velocity;
+        vec3 extent = uBoundsMax - uBoundsMin;
+        for (int i = 0; i < 3; ++i) {
+            if (pos[i] > uBoundsMax[i]) {
+                pos[i] -= extent[i];
+            } else if (pos[i] < uBoundsMin[i]) {
+                pos[i] += extent[i];
+            }
+        }
+
+        vPos = vec4(pos, 1.0);
+        vVelocity = vec4(decision, 0.0);
+    }
+)";
+
+GpuSimulation::GpuSimulation(GLSession const &gl, std::span<Boid const> boids, Boid::Mindset mindset, WorldBounds bounds, GLfloat perception_radius):
+    program_(GLShaderProgramBuilder()
+        .vertex_shader(STEP_SHADER_SOURCE)
+        .transform_feedback_varyings({"vPos", "vVelocity"})
+        .build(gl)),
+    count_(boids.size()),
+    mindset_(mindset),
+    bounds_(bounds),
+    perception_radius_(perception_radius)
+{
+    // Texel indices are ints in the shader.
+    if (2 * count_ > static_cast<std::size_t>(std::numeric_limits<GLint>::max())) {
+        throw std::runtime_error(std::format("Too many boids for the GPU simulation: {}", count_));
+    }
+    GLint max_texels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+    if (2 * count_ > static_cast<std::size_t>(max_texels)) {
+        throw std::runtime_error(std::format("{} boids exceed the GPU's buffer texture size of {} texels", count_, max_texels));
+    }
+
+    std::vector<GpuBoid> initial(count_);
+    for (std::size_t i = 0; i < count_; ++i) {
+        auto const &boid = boids[i];
+        initial[i] = {
+            .pos = {boid.pos[0], boid.pos[1], boid.pos[2], 1},
+            .velocity = {boid.velocity[0], boid.velocity[1], boid.velocity[2], 0},
+        };
+    }
+
+    glGenBuffers(2, buffers_);
+    glGenVertexArrays(2, vertex_arrays_);
+    glGenTextures(2, textures_);
+    for (std::size_t b = 0; b < 2; ++b) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers_[b]);
+        // Both buffers start out equal, so that either can be read first.
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(initial.size() * sizeof(GpuBoid)), initial.data(), GL_DYNAMIC_COPY);
+
+        glBindVertexArray(vertex_arrays_[b]);
+        glVertexAttribPointer(0, 4, GL_FLOAT, false, sizeof(GpuBoid), reinterpret_cast<void const*>(offsetof(GpuBoid, pos)));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(GpuBoid), reinterpret_cast<void const*>(offsetof(GpuBoid, velocity)));
+        glEnableVertexAttribArray(1);
+
+        glBindTexture(GL_TEXTURE_BUFFER, textures_[b]);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffers_[b]);
+    }
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    // An unlimited radius is passed as the largest float, which every driver compares correctly.
+    auto radius_sq = std::isfinite(perception_radius)
+        ? perception_radius * perception_radius
+        : std::numeric_limits<GLfloat>::max();
+    gl.use_program(program_);
+    glUniform1i(*program_.uniform_location("uState"), STATE_TEXTURE_UNIT);
+    glUniform1i(*program_.uniform_location("uCount"), static_cast<GLint>(count_));
+    glUniform1f(*program_.uniform_location("uRadiusSq"), radius_sq);
+    glUniform4f(*program_.uniform_location("uMindset"),
+                mindset.obstacle_avoiding_bias, mindset.centering_bias, mindset.conforming_bias, mindset.maximum_movement);
+    glUniform3fv(*program_.uniform_location("uBoundsMin"), 1, bounds.min.arr.data());
+    glUniform3fv(*program_.uniform_location("uBoundsMax"), 1, bounds.max.arr.data());
+}
+
+GpuSimulation::~GpuSimulation() noexcept {
+    glDeleteTextures(2, textures_);
+    glDeleteVertexArrays(2, vertex_arrays_);
+    glDeleteBuffers(2, buffers_);
+}
+
+void GpuSimulation::step() {
+    TRACE_SCOPE("gpu_step", "sim");
+    auto next = 1 - current_;
+    glUseProgram(program_.inner());
+    glBindVertexArray(vertex_arrays_[current_]);
+    glActiveTexture(GL_TEXTURE0 + STATE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, textures_[current_]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers_[next]);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(count_));
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+    current_ = next;
+}
+
+void GpuSimulation::bind_instance_attributes(GLuint first_location) const {
+    glBindBuffer(GL_ARRAY_BUFFER, buffers_[current_]);
+    glVertexAttribPointer(first_location, 4, GL_FLOAT, false, sizeof(GpuBoid), reinterpret_cast<void const*>(offsetof(GpuBoid, pos)));
+    glVertexAttribDivisor(first_location, 1);
+    glEnableVertexAttribArray(first_location);
+    glVertexAttribPointer(first_location + 1, 4, GL_FLOAT, false, sizeof(GpuBoid), reinterpret_cast<void const*>(offsetof(GpuBoid, velocity)));
+    glVertexAttribDivisor(first_location + 1, 1);
+    glEnableVertexAttribArray(first_location + 1);
+}
+
+std::vector<Boid> GpuSimulation::read_boids() const {
+    TRACE_SCOPE("gpu_read_boids", "sim");
+    std::vector<GpuBoid> state(count_);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers_[current_]);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(state.size() * sizeof(GpuBoid)), state.data());
+    std::vector<Boid> ret(count_);
+    for (std::size_t i = 0; i < count_; ++i) {
+        ret[i] = {
+            .pos = {{state[i].pos[0], state[i].pos[1], state[i].pos[2]}},
+            .velocity = {{state[i].velocity[0], state[i].velocity[1], state[i].velocity[2]}},
+        };
+    }
+    return ret;
+}
+
+GpuValidation GpuSimulation::validate_step() {
+    TRACE_SCOPE("gpu_validate_step", "sim");
+    Simulation reference(read_boids(), mindset_, bounds_, 0);
+    reference.set_interaction(std::make_unique<AllPairsInteraction>(perception_radius_));
+    reference.step();
+    step();
+    auto stepped = read_boids();
+
+    GpuValidation ret = {.max_position_error = 0, .max_velocity_error = 0};
+    auto expected = reference.boids();
+    for (std::size_t i = 0; i < count_; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            auto extent = bounds_.max[k] - bounds_.min[k];
+            auto position_error = std::abs(stepped[i].pos[k] - expected[i].pos[k]);
+            // A boid right at an edge may wrap on one side and not on the other.
+            position_error = std::min(position_error, std::abs(extent - position_error));
+            ret.max_position_error = std::max(ret.max_position_error, position_error);
+            ret.max_velocity_error = std::max(ret.max_velocity_error, std::abs(stepped[i].velocity[k] - expected[i].velocity[k]));
+        }
+    }
+    return ret;
+}
+
+std::size_t GpuSimulation::size() const noexcept {
+    return count_;
+}
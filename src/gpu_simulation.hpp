@@ -0,0 +1,77 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_GPU_SIMULATION_HPP
+#define SDL_GLEW_TEST_GPU_SIMULATION_HPP
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+#include "simulation.hpp"
+#include "gl_shader_program.hpp"
+
+class GLSession;
+
+// How far one GPU step ended up from a CPU step of the same state, with
+// positions compared across the world's wrapping edges.
+struct GpuValidation {
+    // Allowed error as a fraction of maximum_movement. A step differs by rounding
+    // in the sums over neighbors, around a millionth of it.
+    static constexpr GLfloat TOLERANCE = 1e-3f;
+
+    GLfloat max_position_error;
+    GLfloat max_velocity_error;
+};
+
+// Flock state kept on the GPU, for flocks that are simulated only to be drawn.
+// A vertex shader runs Boid::consider, into_decision and act_upon for every boid,
+// reading the current state of all boids through a buffer texture and writing the
+// next state by transform feedback into a second buffer; the two buffers then
+// swap roles. Boids consider every other boid within the perception radius, as
+// with AllPairsInteraction; Simulation's other settings do not apply. Boids keep
+// their initial order, so a boid's index is its id. Needs OpenGL 3.3.
+class GpuSimulation {
+public:
+    GpuSimulation(GLSession const &gl, std::span<Boid const> boids, Boid::Mindset mindset, WorldBounds bounds, GLfloat perception_radius);
+    ~GpuSimulation() noexcept;
+
+    GpuSimulation(GpuSimulation const &other) = delete;
+    GpuSimulation(GpuSimulation &&other) = delete;
+    GpuSimulation &operator=(GpuSimulation const &other) = delete;
+    GpuSimulation &operator=(GpuSimulation &&other) = delete;
+
+    // Leaves the simulation's program and vertex array bound.
+    void step();
+
+    // Sets the current positions and velocities as per-instance vec4 attributes on
+    // first_location and first_location + 1 of the currently bound vertex array.
+    // The state moves to the other buffer every step, so call it after each step.
+    void bind_instance_attributes(GLuint first_location) const;
+
+    // Copies the state back, which waits for the GPU to finish stepping.
+    [[nodiscard]] std::vector<Boid> read_boids() const;
+    // Steps the GPU, and a CPU Simulation from the same state, once.
+    [[nodiscard]] GpuValidation validate_step();
+
+    [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+    GLShaderProgram program_;
+    std::size_t count_;
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    GLfloat perception_radius_;
+
+    GLuint buffers_[2] = {};
+    // Per buffer: a vertex array reading it as the step's input, and a buffer
+    // texture through which the step reads every boid.
+    GLuint vertex_arrays_[2] = {};
+    GLuint textures_[2] = {};
+    std::size_t current_ = 0;
+};
+
+#endif //SDL_GLEW_TEST_GPU_SIMULATION_HPP
@@ -0,0 +1,42 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "instance_buffer.hpp"
+#include "trace.hpp"
+
+InstanceBuffer::InstanceBuffer():
+    buffer_(0),
+    capacity_(0)
+{
+    glGenBuffers(1, &buffer_);
+}
+
+InstanceBuffer::~InstanceBuffer() noexcept {
+    glDeleteBuffers(1, &buffer_);
+}
+
+void InstanceBuffer::bind_attributes(GLuint first_location) const {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+    for (GLuint i = 0; i < 4; ++i) {
+        auto offset = offsetof(Instance, model) + i * 4 * sizeof(GLfloat);
+        glVertexAttribPointer(first_location + i, 4, GL_FLOAT, false, sizeof(Instance), reinterpret_cast<void const*>(offset));
+        glVertexAttribDivisor(first_location + i, 1);
+        glEnableVertexAttribArray(first_location + i);
+    }
+    glVertexAttribIPointer(first_location + 4, 1, GL_UNSIGNED_INT, sizeof(Instance), reinterpret_cast<void const*>(offsetof(Instance, layer)));
+    glVertexAttribDivisor(first_location + 4, 1);
+    glEnableVertexAttribArray(first_location + 4);
+}
+
+void InstanceBuffer::upload(std::span<Instance const> instances) {
+    TRACE_SCOPE("upload_instances", "upload");
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+    if (instances.size() > capacity_) {
+        capacity_ = instances.size();
+    }
+    // Respecifying the store each frame lets the driver hand out fresh memory
+    // instead of waiting for draws still reading last frame's instances.
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity_ * sizeof(Instance)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(instances.size_bytes()), instances.data());
+}
@@ -0,0 +1,44 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_INSTANCE_BUFFER_HPP
+#define SDL_GLEW_TEST_INSTANCE_BUFFER_HPP
+
+#include <span>
+#include <cstddef>
+
+#include "GL/glew.h"
+
+// Per-instance attributes for instanced draws, streamed once per frame.
+class InstanceBuffer {
+public:
+    struct Instance {
+        // Row-major, as produced by Transform; the shader reads it as its transpose.
+        GLfloat model[16];
+        GLuint layer;
+    };
+
+    // Number of attribute locations used by bind_attributes.
+    static constexpr GLuint LOCATION_COUNT = 5;
+
+    InstanceBuffer();
+    ~InstanceBuffer() noexcept;
+
+    InstanceBuffer(InstanceBuffer const &other) = delete;
+    InstanceBuffer(InstanceBuffer &&other) = delete;
+    InstanceBuffer &operator=(InstanceBuffer const &other) = delete;
+    InstanceBuffer &operator=(InstanceBuffer &&other) = delete;
+
+    // Sets the model matrix on locations [first_location, first_location + 4) and the
+    // texture layer on first_location + 4, on the currently bound vertex array.
+    void bind_attributes(GLuint first_location) const;
+
+    void upload(std::span<Instance const> instances);
+
+private:
+    GLuint buffer_;
+    std::size_t capacity_;
+};
+
+#endif //SDL_GLEW_TEST_INSTANCE_BUFFER_HPP
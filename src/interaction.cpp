@@ -0,0 +1,551 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "interaction.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#include "SDL_log.h"
+
+#include "simulation.hpp"
+#include "worker_pool.hpp"
+#include "trace.hpp"
+
+static GLfloat distance_sq(Vec3<GLfloat> const &a, Vec3<GLfloat> const &b) noexcept {
+    GLfloat ret = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto d = b[i] - a[i];
+        ret += d * d;
+    }
+    return ret;
+}
+
+// Distance between the closest images of two points in the wrapping world.
+static GLfloat periodic_distance_sq(Vec3<GLfloat> const &a, Vec3<GLfloat> const &b, Vec3<GLfloat> const &extent) noexcept {
+    GLfloat ret = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto d = std::abs(b[i] - a[i]);
+        d = std::min(d, extent[i] - d);
+        ret += d * d;
+    }
+    return ret;
+}
+
+AllPairsInteraction::AllPairsInteraction(GLfloat perception_radius) noexcept:
+    radius_sq_(perception_radius * perception_radius)
+{}
+
+char const *AllPairsInteraction::name() const noexcept {
+    return "all_pairs";
+}
+
+void AllPairsInteraction::prepare(FlockView const &, WorkerPool &) {}
+
+void AllPairsInteraction::gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept {
+    auto boids = flock.boids;
+    Boid const &boid = boids[i];
+    for (std::size_t k = 0; k < boids.size(); ++k) {
+        auto j = flock.id_order ? flock.slots[k] : k;
+        if (i != j && distance_sq(boid.pos, boids[j].pos) < radius_sq_) {
+            boid.consider(awareness, boids[j]);
+        }
+    }
+}
+
+constexpr int MAX_GRID_DIM = 64;
+
+VerletInteraction::VerletInteraction(GLfloat perception_radius, GLfloat skin, WorldBounds const &bounds):
+    radius_sq_(perception_radius * perception_radius),
+    list_radius_(perception_radius + skin),
+    half_skin_sq_(skin * skin / 4),
+    grid_min_(bounds.min),
+    extent_(bounds.max - bounds.min)
+{
+    if (!std::isfinite(list_radius_) || perception_radius <= 0 || skin < 0) {
+        throw std::runtime_error(std::format(
+            "Verlet interaction needs a finite positive perception radius and non-negative skin (got {}, {})",
+            perception_radius, skin));
+    }
+    for (int i = 0; i < 3; ++i) {
+        // Cells at least one list radius wide, so every neighbor lies in the adjacent cells.
+        grid_dims_[i] = std::clamp(static_cast<int>(extent_[i] / list_radius_), 1, MAX_GRID_DIM);
+        cell_size_[i] = extent_[i] / static_cast<GLfloat>(grid_dims_[i]);
+    }
+}
+
+char const *VerletInteraction::name() const noexcept {
+    return (half_skin_sq_ == 0) ? "cell_grid" : "verlet";
+}
+
+void VerletInteraction::prepare(FlockView const &flock, WorkerPool &) {
+    if (needs_rebuild(flock.boids)) {
+        rebuild(flock);
+    }
+}
+
+void VerletInteraction::gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept {
+    auto boids = flock.boids;
+    Boid const &boid = boids[i];
+    for (auto k = list_starts_[i]; k < list_starts_[i + 1]; ++k) {
+        Boid const &other = boids[neighbors_[k]];
+        if (distance_sq(boid.pos, other.pos) < radius_sq_) {
+            boid.consider(awareness, other);
+        }
+    }
+}
+
+void VerletInteraction::invalidate() noexcept {
+    built_positions_.clear();
+}
+
+std::uint64_t VerletInteraction::rebuild_count() const noexcept {
+    return rebuild_count_;
+}
+
+bool VerletInteraction::needs_rebuild(std::span<Boid const> boids) const noexcept {
+    if (rebuild_count_ == 0 || built_positions_.size() != boids.size()) {
+        return true;
+    }
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        if (periodic_distance_sq(built_positions_[i], boids[i].pos, extent_) > half_skin_sq_) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int VerletInteraction::cell_coord(GLfloat pos, int axis) const noexcept {
+    auto cell = static_cast<int>(std::floor((pos - grid_min_[axis]) / cell_size_[axis]));
+    return std::clamp(cell, 0, grid_dims_[axis] - 1);
+}
+
+void VerletInteraction::rebuild(FlockView const &flock) {
+    TRACE_SCOPE("verlet_rebuild", "sim");
+    auto boids = flock.boids;
+    auto count = boids.size();
+    auto cell_count = static_cast<std::size_t>(grid_dims_[0] * grid_dims_[1] * grid_dims_[2]);
+    auto cell_index = [&](int x, int y, int z) {
+        return static_cast<std::size_t>((z * grid_dims_[1] + y) * grid_dims_[0] + x);
+    };
+
+    // Counting sort of boid indices by cell.
+    cell_starts_.assign(cell_count + 1, 0);
+    for (auto const &boid : boids) {
+        ++cell_starts_[cell_index(cell_coord(boid.pos[0], 0), cell_coord(boid.pos[1], 1), cell_coord(boid.pos[2], 2)) + 1];
+    }
+    for (std::size_t c = 0; c < cell_count; ++c) {
+        cell_starts_[c + 1] += cell_starts_[c];
+    }
+    cell_boids_.resize(count);
+    cell_fill_.assign(cell_starts_.begin(), cell_starts_.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const &pos = boids[i].pos;
+        cell_boids_[cell_fill_[cell_index(cell_coord(pos[0], 0), cell_coord(pos[1], 1), cell_coord(pos[2], 2))]++] = static_cast<std::uint32_t>(i);
+    }
+
+    auto list_radius_sq = list_radius_ * list_radius_;
+    list_starts_.resize(count + 1);
+    neighbors_.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        list_starts_[i] = static_cast<std::uint32_t>(neighbors_.size());
+        auto const &pos = boids[i].pos;
+        int cells[3][3];
+        int cell_counts[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            auto dim = grid_dims_[axis];
+            auto c = cell_coord(pos[axis], axis);
+            cell_counts[axis] = std::min(dim, 3);
+            for (int k = 0; k < cell_counts[axis]; ++k) {
+                cells[axis][k] = (dim < 3) ? k : (c + k - 1 + dim) % dim;
+            }
+        }
+        for (int z = 0; z < cell_counts[2]; ++z) {
+            for (int y = 0; y < cell_counts[1]; ++y) {
+                for (int x = 0; x < cell_counts[0]; ++x) {
+                    auto cell = cell_index(cells[0][x], cells[1][y], cells[2][z]);
+                    for (auto k = cell_starts_[cell]; k < cell_starts_[cell + 1]; ++k) {
+                        auto j = cell_boids_[k];
+                        if (j != i && periodic_distance_sq(pos, boids[j].pos, extent_) < list_radius_sq) {
+                            neighbors_.push_back(j);
+                        }
+                    }
+                }
+            }
+        }
+        std::sort(neighbors_.begin() + list_starts_[i], neighbors_.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return flock.order_key(a) < flock.order_key(b);
+        });
+    }
+    list_starts_[count] = static_cast<std::uint32_t>(neighbors_.size());
+
+    built_positions_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        built_positions_[i] = boids[i].pos;
+    }
+    ++rebuild_count_;
+    TRACE_COUNTER("verlet_neighbors", static_cast<double>(neighbors_.size()));
+}
+
+// Ranges this small are scanned rather than split further.
+constexpr std::uint32_t KD_LEAF_SIZE = 8;
+
+// Bounded max-heap of the best candidates seen so far.
+class KnnInteraction::Nearest {
+public:
+    Nearest(std::size_t capacity, GLfloat radius_sq) noexcept:
+        capacity_(capacity),
+        radius_sq_(radius_sq)
+    {}
+
+    static bool closer(Candidate const &a, Candidate const &b) noexcept {
+        return a.dist_sq < b.dist_sq || (a.dist_sq == b.dist_sq && a.key < b.key);
+    }
+
+    // Squared distance beyond which no candidate can be accepted.
+    [[nodiscard]] GLfloat bound() const noexcept {
+        return (size_ < capacity_) ? radius_sq_ : heap_[0].dist_sq;
+    }
+
+    void offer(Candidate candidate) noexcept {
+        if (candidate.dist_sq >= radius_sq_) {
+            return;
+        }
+        if (size_ < capacity_) {
+            heap_[size_++] = candidate;
+            std::push_heap(heap_.begin(), heap_.begin() + size_, closer);
+        } else if (closer(candidate, heap_[0])) {
+            std::pop_heap(heap_.begin(), heap_.begin() + size_, closer);
+            heap_[size_ - 1] = candidate;
+            std::push_heap(heap_.begin(), heap_.begin() + size_, closer);
+        }
+    }
+
+    [[nodiscard]] std::span<Candidate> candidates() noexcept {
+        return {heap_.data(), size_};
+    }
+
+private:
+    std::array<Candidate, MAX_NEIGHBORS> heap_;
+    std::size_t size_ = 0;
+    std::size_t capacity_;
+    GLfloat radius_sq_;
+};
+
+KnnInteraction::KnnInteraction(std::size_t neighbor_count, GLfloat perception_radius):
+    neighbor_count_(neighbor_count),
+    radius_sq_(perception_radius * perception_radius)
+{
+    if (neighbor_count == 0 || neighbor_count > MAX_NEIGHBORS) {
+        throw std::runtime_error(std::format("Knn interaction needs between 1 and {} neighbors (got {})", MAX_NEIGHBORS, neighbor_count));
+    }
+}
+
+char const *KnnInteraction::name() const noexcept {
+    return "knn";
+}
+
+void KnnInteraction::prepare(FlockView const &flock, WorkerPool &pool) {
+    TRACE_SCOPE("kd_tree_build", "sim");
+    auto boids = flock.boids;
+    auto count = static_cast<std::uint32_t>(boids.size());
+    order_.resize(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        order_[i] = i;
+    }
+
+    // Split serially until there are enough independent subtrees to keep every thread busy.
+    subtrees_.assign(1, {0, count, 0});
+    auto target = pool.thread_count() * 4;
+    while (subtrees_.size() < target) {
+        next_subtrees_.clear();
+        for (auto range : subtrees_) {
+            if (range.end - range.begin <= KD_LEAF_SIZE) {
+                continue;
+            }
+            auto mid = split(range, boids);
+            next_subtrees_.push_back({range.begin, mid, range.depth + 1});
+            next_subtrees_.push_back({mid + 1, range.end, range.depth + 1});
+        }
+        if (next_subtrees_.empty()) {
+            break;
+        }
+        std::swap(subtrees_, next_subtrees_);
+    }
+    pool.parallel_for(subtrees_.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            build(subtrees_[i], boids);
+        }
+    });
+
+    positions_.resize(count);
+    pool.parallel_for(count, 4096, [&](std::size_t begin, std::size_t end) {
+        for (auto p = begin; p < end; ++p) {
+            positions_[p] = boids[order_[p]].pos;
+        }
+    });
+}
+
+std::uint32_t KnnInteraction::split(Range range, std::span<Boid const> boids) noexcept {
+    auto axis = range.depth % 3;
+    auto mid = range.begin + (range.end - range.begin) / 2;
+    std::nth_element(order_.begin() + range.begin, order_.begin() + mid, order_.begin() + range.end,
+        [&](std::uint32_t a, std::uint32_t b) {
+            auto pa = boids[a].pos[axis], pb = boids[b].pos[axis];
+            return pa < pb || (pa == pb && a < b);
+        });
+    return mid;
+}
+
+void KnnInteraction::build(Range range, std::span<Boid const> boids) noexcept {
+    if (range.end - range.begin <= KD_LEAF_SIZE) {
+        return;
+    }
+    auto mid = split(range, boids);
+    build({range.begin, mid, range.depth + 1}, boids);
+    build({mid + 1, range.end, range.depth + 1}, boids);
+}
+
+void KnnInteraction::search(Range range, FlockView const &flock, std::uint32_t self, Nearest &nearest) const noexcept {
+    auto const &pos = flock.boids[self].pos;
+    auto offer = [&](std::uint32_t p) {
+        auto slot = order_[p];
+        if (slot != self) {
+            nearest.offer({distance_sq(pos, positions_[p]), flock.order_key(slot), slot});
+        }
+    };
+    if (range.end - range.begin <= KD_LEAF_SIZE) {
+        for (auto p = range.begin; p < range.end; ++p) {
+            offer(p);
+        }
+        return;
+    }
+
+    auto axis = range.depth % 3;
+    auto mid = range.begin + (range.end - range.begin) / 2;
+    offer(mid);
+    auto d = pos[axis] - positions_[mid][axis];
+    Range below = {range.begin, mid, range.depth + 1};
+    Range above = {mid + 1, range.end, range.depth + 1};
+    search(d < 0 ? below : above, flock, self, nearest);
+    // Inclusive, so that equally distant boids with lower keys are still found.
+    if (d * d <= nearest.bound()) {
+        search(d < 0 ? above : below, flock, self, nearest);
+    }
+}
+
+void KnnInteraction::gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept {
+    Nearest nearest(neighbor_count_, radius_sq_);
+    search({0, static_cast<std::uint32_t>(order_.size()), 0}, flock, static_cast<std::uint32_t>(i), nearest);
+
+    auto candidates = nearest.candidates();
+    std::sort(candidates.begin(), candidates.end(), [](Candidate const &a, Candidate const &b) {
+        return a.key < b.key;
+    });
+    for (auto const &candidate : candidates) {
+        flock.boids[i].consider(awareness, flock.boids[candidate.slot]);
+    }
+}
+
+// Steps timed per candidate, after one warm-up step that may rebuild caches.
+// Verlet lists are timed until they have been rebuilt again, so their average
+// spreads one rebuild over the steps between rebuilds, within the longest trial.
+constexpr std::size_t TRIAL_WARMUP_STEPS = 1;
+constexpr std::size_t TRIAL_STEPS = 4;
+constexpr std::size_t MAX_TRIAL_STEPS = 64;
+// All-pairs is not even tried past this many boids.
+constexpr std::size_t ALL_PAIRS_TRIAL_LIMIT = 20000;
+// A candidate averaging this many times slower than the best one so far is cut short.
+constexpr double TRIAL_ABORT_FACTOR = 4;
+// Switching requires the winner to beat the current backend by this fraction.
+constexpr double SWITCH_HYSTERESIS = 0.15;
+constexpr std::size_t MIN_DWELL_STEPS = 300;
+constexpr std::size_t REEVALUATE_STEPS = 3000;
+// Flock size or density must change by this factor to trigger new trials.
+constexpr double REGIME_CHANGE_FACTOR = 2;
+constexpr std::size_t DENSITY_SAMPLES = 32;
+constexpr std::size_t DENSITY_SAMPLE_STEPS = 50;
+
+AutoInteraction::AutoInteraction(InteractionConfig const &config, WorldBounds const &bounds):
+    radius_sq_(config.perception_radius * config.perception_radius)
+{
+    candidates_.push_back({std::make_unique<AllPairsInteraction>(config.perception_radius), nullptr, 0, 0, 0});
+    if (std::isfinite(config.perception_radius)) {
+        for (auto skin : {0.0f, config.verlet_skin}) {
+            auto verlet = std::make_unique<VerletInteraction>(config.perception_radius, skin, bounds);
+            auto const *lists = verlet.get();
+            candidates_.push_back({std::move(verlet), lists, 0, 0, 0});
+        }
+    } else {
+        SDL_Log("Interaction: unlimited perception radius, only all_pairs applies");
+    }
+}
+
+char const *AutoInteraction::name() const noexcept {
+    return candidates_[current_].backend->name();
+}
+
+void AutoInteraction::prepare(FlockView const &flock, WorkerPool &pool) {
+    auto boids = flock.boids;
+    if (boids.size() != boid_count_ || steps_since_decision_ % DENSITY_SAMPLE_STEPS == 0) {
+        sample_density(boids);
+    }
+    if (!in_trial_ && candidates_.size() > 1 && !boids.empty()) {
+        if (decided_boid_count_ == 0
+            || (steps_since_decision_ >= MIN_DWELL_STEPS && (regime_changed() || steps_since_decision_ >= REEVALUATE_STEPS))) {
+            start_trial();
+        }
+    }
+    candidates_[current_].backend->prepare(flock, pool);
+}
+
+void AutoInteraction::gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept {
+    candidates_[current_].backend->gather(flock, i, awareness);
+}
+
+void AutoInteraction::invalidate() noexcept {
+    for (auto &candidate : candidates_) {
+        candidate.backend->invalidate();
+    }
+}
+
+void AutoInteraction::step_finished(double step_ms) noexcept {
+    ++steps_since_decision_;
+    if (!in_trial_) {
+        return;
+    }
+    auto &candidate = candidates_[trial_candidate_];
+    if (candidate.trial_steps++ >= TRIAL_WARMUP_STEPS) {
+        candidate.trial_ms += step_ms;
+    } else if (candidate.verlet != nullptr) {
+        candidate.trial_rebuilds = candidate.verlet->rebuild_count();
+    }
+
+    double best_ms = std::numeric_limits<double>::infinity();
+    for (std::size_t c = 0; c < trial_candidate_; ++c) {
+        if (!skip_trial(c)) {
+            best_ms = std::min(best_ms, candidates_[c].trial_ms);
+        }
+    }
+    auto timed_steps = candidate.trial_steps - std::min(candidate.trial_steps, TRIAL_WARMUP_STEPS);
+    bool rebuilt = candidate.verlet == nullptr || candidate.verlet->rebuild_count() > candidate.trial_rebuilds;
+    if (timed_steps >= MAX_TRIAL_STEPS || (timed_steps >= TRIAL_STEPS && rebuilt)) {
+        candidate.trial_ms /= static_cast<double>(timed_steps);
+        advance_trial();
+    } else if (timed_steps > 0 && candidate.trial_ms > TRIAL_ABORT_FACTOR * best_ms * static_cast<double>(timed_steps)) {
+        // Compared as an average, so a rebuild step alone does not cut a trial short.
+        candidate.trial_ms /= static_cast<double>(timed_steps);
+        advance_trial();
+    }
+}
+
+void AutoInteraction::sample_density(std::span<Boid const> boids) noexcept {
+    boid_count_ = boids.size();
+    if (boids.size() < 2 || !std::isfinite(radius_sq_)) {
+        density_ = static_cast<double>(boids.size());
+        return;
+    }
+    // Mean neighbor count over evenly spaced boids.
+    auto samples = std::min(DENSITY_SAMPLES, boids.size());
+    std::size_t neighbors = 0;
+    for (std::size_t s = 0; s < samples; ++s) {
+        auto const &pos = boids[s * boids.size() / samples].pos;
+        for (auto const &other : boids) {
+            if (distance_sq(pos, other.pos) < radius_sq_) {
+                ++neighbors;
+            }
+        }
+    }
+    density_ = static_cast<double>(neighbors) / static_cast<double>(samples) - 1;
+}
+
+bool AutoInteraction::regime_changed() const noexcept {
+    auto changed = [](double now, double then) {
+        return now > then * REGIME_CHANGE_FACTOR || now * REGIME_CHANGE_FACTOR < then;
+    };
+    // Density is compared with one added, so that nearly empty neighborhoods do not look volatile.
+    return changed(static_cast<double>(boid_count_), static_cast<double>(decided_boid_count_))
+        || changed(density_ + 1, decided_density_ + 1);
+}
+
+void AutoInteraction::start_trial() {
+    TRACE_SCOPE("interaction_trial", "sim");
+    for (auto &candidate : candidates_) {
+        candidate.trial_ms = 0;
+        candidate.trial_steps = 0;
+        candidate.trial_rebuilds = 0;
+    }
+    in_trial_ = true;
+    trial_candidate_ = static_cast<std::size_t>(-1);
+    advance_trial();
+}
+
+bool AutoInteraction::skip_trial(std::size_t candidate) const noexcept {
+    return candidate == 0 && boid_count_ > ALL_PAIRS_TRIAL_LIMIT;
+}
+
+void AutoInteraction::advance_trial() {
+    do {
+        ++trial_candidate_;
+    } while (trial_candidate_ < candidates_.size() && skip_trial(trial_candidate_));
+
+    if (trial_candidate_ < candidates_.size()) {
+        current_ = trial_candidate_;
+        candidates_[current_].backend->invalidate();
+    } else {
+        in_trial_ = false;
+        decide();
+    }
+}
+
+void AutoInteraction::decide() {
+    std::size_t best = candidates_.size();
+    for (std::size_t c = 0; c < candidates_.size(); ++c) {
+        if (!skip_trial(c) && (best == candidates_.size() || candidates_[c].trial_ms < candidates_[best].trial_ms)) {
+            best = c;
+        }
+    }
+    bool first_decision = decided_boid_count_ == 0;
+    auto previous = settled_;
+    if (first_decision || skip_trial(settled_)
+        || candidates_[best].trial_ms < (1 - SWITCH_HYSTERESIS) * candidates_[settled_].trial_ms) {
+        settled_ = best;
+    }
+    current_ = settled_;
+    candidates_[current_].backend->invalidate();
+
+    std::string timings;
+    for (std::size_t c = 0; c < candidates_.size(); ++c) {
+        if (skip_trial(c)) {
+            timings += std::format(" {} skipped", candidates_[c].backend->name());
+        } else {
+            timings += std::format(" {} {:.2f} ms", candidates_[c].backend->name(), candidates_[c].trial_ms);
+        }
+    }
+    SDL_Log("Interaction: %zu boids, %.1f neighbors each:%s -> %s%s",
+            boid_count_, density_, timings.c_str(), name(),
+            (!first_decision && settled_ == previous) ? " (kept)" : "");
+
+    decided_boid_count_ = boid_count_;
+    decided_density_ = density_;
+    steps_since_decision_ = 0;
+}
+
+std::unique_ptr<InteractionBackend> make_interaction_backend(InteractionConfig const &config, WorldBounds const &bounds) {
+    switch (config.mode) {
+        case InteractionMode::AllPairs:
+            return std::make_unique<AllPairsInteraction>(config.perception_radius);
+        case InteractionMode::Verlet:
+            return std::make_unique<VerletInteraction>(config.perception_radius, config.verlet_skin, bounds);
+        case InteractionMode::Knn:
+            return std::make_unique<KnnInteraction>(config.neighbor_count, config.perception_radius);
+        case InteractionMode::Auto:
+            return std::make_unique<AutoInteraction>(config, bounds);
+    }
+    throw std::runtime_error("Unknown interaction mode");
+}
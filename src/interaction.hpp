@@ -0,0 +1,220 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_INTERACTION_HPP
+#define SDL_GLEW_TEST_INTERACTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+
+struct WorldBounds;
+class WorkerPool;
+
+enum class InteractionMode {
+    AllPairs,
+    Verlet,
+    Knn,
+    Auto,
+};
+
+struct InteractionConfig {
+    InteractionMode mode = InteractionMode::AllPairs;
+    // Boids only consider others closer than this.
+    GLfloat perception_radius = std::numeric_limits<GLfloat>::infinity();
+    // Extra distance covered by Verlet neighbor lists, so they stay valid while
+    // no boid has moved more than half of it.
+    GLfloat verlet_skin = 8;
+    // Number of nearest neighbors considered by Knn interaction.
+    std::size_t neighbor_count = 7;
+};
+
+// The flock as an interaction backend sees it during one step.
+struct FlockView {
+    std::span<Boid const> boids;
+    // Stable id of the boid in each slot, and the slot holding each id.
+    std::span<std::uint32_t const> ids;
+    std::span<std::uint32_t const> slots;
+    // Rank neighbors by id rather than by slot, so that results do not depend on
+    // where boids happen to be stored.
+    bool id_order = false;
+
+    [[nodiscard]] std::uint32_t order_key(std::uint32_t slot) const noexcept {
+        return id_order ? ids[slot] : slot;
+    }
+};
+
+// Decides which boids each boid considers during a step. Neighbors are always
+// considered in increasing FlockView::order_key order, so every backend
+// accumulates the same sums for the same set of neighbors. gather() may run on
+// several threads at once.
+class InteractionBackend {
+public:
+    virtual ~InteractionBackend() = default;
+
+    [[nodiscard]] virtual char const *name() const noexcept = 0;
+
+    // Called once per step, before gathering for any boid.
+    virtual void prepare(FlockView const &flock, WorkerPool &pool) = 0;
+    virtual void gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept = 0;
+    // Boids were reordered, added or removed, so anything cached by index is stale.
+    virtual void invalidate() noexcept {}
+    // Time spent preparing and gathering for the step that just finished.
+    virtual void step_finished(double) noexcept {}
+};
+
+class AllPairsInteraction final : public InteractionBackend {
+public:
+    explicit AllPairsInteraction(GLfloat perception_radius) noexcept;
+
+    [[nodiscard]] char const *name() const noexcept override;
+    void prepare(FlockView const &flock, WorkerPool &pool) override;
+    void gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept override;
+
+private:
+    GLfloat radius_sq_;
+};
+
+// Keeps, for every boid, the list of boids within perception radius + skin, and
+// rebuilds the lists only once some boid has moved more than half the skin since
+// the last build. Lists are built by binning boids into a uniform grid of cells
+// one list radius wide. Distances for the lists and for movement are measured
+// across the world's wrapping edges, so boids wrapping around do not force a
+// rebuild; neighbors are still filtered by plain distance when gathering.
+class VerletInteraction final : public InteractionBackend {
+public:
+    VerletInteraction(GLfloat perception_radius, GLfloat skin, WorldBounds const &bounds);
+
+    [[nodiscard]] char const *name() const noexcept override;
+    void prepare(FlockView const &flock, WorkerPool &pool) override;
+    void gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept override;
+    void invalidate() noexcept override;
+
+    [[nodiscard]] std::uint64_t rebuild_count() const noexcept;
+
+private:
+    [[nodiscard]] bool needs_rebuild(std::span<Boid const> boids) const noexcept;
+    void rebuild(FlockView const &flock);
+    [[nodiscard]] int cell_coord(GLfloat pos, int axis) const noexcept;
+
+    GLfloat radius_sq_;
+    GLfloat list_radius_;
+    GLfloat half_skin_sq_;
+    Vec3<GLfloat> grid_min_;
+    Vec3<GLfloat> extent_;
+    Vec3<GLfloat> cell_size_;
+    int grid_dims_[3];
+
+    std::vector<Vec3<GLfloat>> built_positions_;
+    std::vector<std::uint32_t> cell_starts_;
+    std::vector<std::uint32_t> cell_fill_;
+    std::vector<std::uint32_t> cell_boids_;
+    std::vector<std::uint32_t> list_starts_;
+    std::vector<std::uint32_t> neighbors_;
+    std::uint64_t rebuild_count_ = 0;
+};
+
+// Topological interaction: each boid considers only its k nearest neighbors
+// (within the perception radius), found in a kd-tree rebuilt every step. The
+// top levels of the tree are split serially and the subtrees below them are
+// built in parallel. Equally distant neighbors are ranked by order key.
+class KnnInteraction final : public InteractionBackend {
+public:
+    static constexpr std::size_t MAX_NEIGHBORS = 64;
+
+    KnnInteraction(std::size_t neighbor_count, GLfloat perception_radius);
+
+    [[nodiscard]] char const *name() const noexcept override;
+    void prepare(FlockView const &flock, WorkerPool &pool) override;
+    void gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept override;
+
+private:
+    struct Candidate {
+        GLfloat dist_sq;
+        std::uint32_t key;
+        std::uint32_t slot;
+    };
+
+    struct Range {
+        std::uint32_t begin;
+        std::uint32_t end;
+        int depth;
+    };
+
+    class Nearest;
+
+    [[nodiscard]] std::uint32_t split(Range range, std::span<Boid const> boids) noexcept;
+    void build(Range range, std::span<Boid const> boids) noexcept;
+    void search(Range range, FlockView const &flock, std::uint32_t self, Nearest &nearest) const noexcept;
+
+    std::size_t neighbor_count_;
+    GLfloat radius_sq_;
+
+    // Boid indices in tree order, and their positions in the same order.
+    std::vector<std::uint32_t> order_;
+    std::vector<Vec3<GLfloat>> positions_;
+    std::vector<Range> subtrees_;
+    std::vector<Range> next_subtrees_;
+};
+
+// Picks whichever of all-pairs, a per-step cell grid (Verlet lists without
+// skin) and Verlet lists is fastest for the current flock. Each candidate is
+// timed for a few steps, and Verlet lists until they have been rebuilt at least
+// once, when the flock size or density changes markedly, and periodically after
+// that; the winner replaces the current backend only if it is clearly faster,
+// and never before the current one has run for a while. An empty flock is never
+// timed. Every candidate finds the same neighbors, so switching does not change
+// the simulation. Topological (knn) interaction is a different model and is
+// never picked automatically.
+class AutoInteraction final : public InteractionBackend {
+public:
+    AutoInteraction(InteractionConfig const &config, WorldBounds const &bounds);
+
+    [[nodiscard]] char const *name() const noexcept override;
+    void prepare(FlockView const &flock, WorkerPool &pool) override;
+    void gather(FlockView const &flock, std::size_t i, Boid::SituationalAwareness &awareness) const noexcept override;
+    void invalidate() noexcept override;
+    void step_finished(double step_ms) noexcept override;
+
+private:
+    struct Candidate {
+        std::unique_ptr<InteractionBackend> backend;
+        // The same backend when it keeps Verlet lists, whose rebuilds a trial must include.
+        VerletInteraction const *verlet;
+        double trial_ms;
+        std::size_t trial_steps;
+        std::uint64_t trial_rebuilds;
+    };
+
+    void sample_density(std::span<Boid const> boids) noexcept;
+    [[nodiscard]] bool regime_changed() const noexcept;
+    void start_trial();
+    [[nodiscard]] bool skip_trial(std::size_t candidate) const noexcept;
+    void advance_trial();
+    void decide();
+
+    GLfloat radius_sq_;
+    std::vector<Candidate> candidates_;
+    std::size_t current_ = 0;
+    std::size_t settled_ = 0;
+
+    bool in_trial_ = false;
+    std::size_t trial_candidate_ = 0;
+    std::size_t steps_since_decision_ = 0;
+
+    std::size_t boid_count_ = 0;
+    double density_ = 0;
+    std::size_t decided_boid_count_ = 0;
+    double decided_density_ = 0;
+};
+
+[[nodiscard]] std::unique_ptr<InteractionBackend> make_interaction_backend(InteractionConfig const &config, WorldBounds const &bounds);
+
+#endif //SDL_GLEW_TEST_INTERACTION_HPP
@@ -1,7 +1,16 @@
 #include <numbers>
+#include <algorithm>
+#include <chrono>
+#include <utility>
 #include <cmath>
 #include <cstring>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "GL/glew.h"
 #include "SDL_log.h"
@@ -11,57 +20,166 @@
 #include "sdl_session.hpp"
 #include "sdl_window.hpp"
 #include "sdl_image_loader.hpp"
+#include "async_texture_loader.hpp"
 #include "gl_session.hpp"
 #include "gl_shader_program.hpp"
 #include "matrix.hpp"
 #include "transform.hpp"
 #include "boid.hpp"
+#include "simulation.hpp"
+#include "simulation_thread.hpp"
+#include "scenario.hpp"
+#include "benchmark.hpp"
+#include "replay.hpp"
+#include "shared_flock_writer.hpp"
+#include "stream_server.hpp"
+#include "stream_client.hpp"
+#include "quality_controller.hpp"
+#include "gpu_simulation.hpp"
+#include "offscreen_target.hpp"
+#ifdef BOIDS_ENABLE_HEADLESS
+#include "egl_display.hpp"
+#endif
 
 #include "obj_format.hpp"
 #include "mesh.hpp"
+#include "instance_buffer.hpp"
+#include "frame_profiler.hpp"
+#include "trace.hpp"
+
+constexpr std::size_t TEXTURE_UPLOAD_BYTES_PER_FRAME = 256 * 1024;
+
+// Boid transforms are projected as they are, with no view transform, so the
+// eye sits at the world origin.
+Vec3<GLfloat> const RENDER_CAMERA = {{0, 0, 0}};
+
+// One texture array layer per skin; boids are assigned skins round-robin.
+std::vector<std::string> const BOID_SKINS = {
+    "assets/boid.png",
+};
 
 char const *VERTEX_SHADER_SOURCE = R"(
     #version 330 core
     layout (location = 0) in vec3 aPos;
     layout (location = 1) in vec2 aTexCoord;
+    layout (location = 2) in mat4 aModel;
+    layout (location = 6) in uint aLayer;
 
     out vec2 texCoord;
+    flat out uint layer;
 
-    uniform mat4 uModels[128];
+    uniform mat4 uMesh;
     uniform mat4 uProjection;
 
     void main() {
-        gl_Position = vec4(aPos, 1.0) * uModels[gl_InstanceID] * uProjection;
+        // aModel holds the transpose of the model transform, so it multiplies from the left.
+        gl_Position = (aModel * (vec4(aPos, 1.0) * uMesh)) * uProjection;
         texCoord = aTexCoord;
+        layer = aLayer;
     }
 )";
 
 char const *FRAGMENT_SHADER_SOURCE = R"(
     #version 330 core
     in vec2 texCoord;
+    flat in uint layer;
 
     out vec4 fragColor;
 
-    uniform sampler2D uTex;
+    uniform sampler2DArray uTex;
 
     void main() {
-        fragColor = texture(uTex, texCoord);
+        fragColor = texture(uTex, vec3(texCoord, float(layer)));
     }
 )";
 
 
+// The vertex shader above, with each boid's transform built from the GPU
+// simulation's state buffer instead of uploaded.
+char const *GPU_VERTEX_SHADER_SOURCE = R"(
+    #version 330 core
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    layout (location = 2) in vec4 aBoidPos;
+    layout (location = 3) in vec4 aBoidVelocity;
+
+    out vec2 texCoord;
+    flat out uint layer;
+
+    uniform mat4 uMesh;
+    uniform mat4 uProjection;
+    uniform uint uSkinCount;
+
+    void main() {
+        // As Boid::transform: z along the velocity, x level with the ground.
+        vec3 velocity = aBoidVelocity.xyz;
+        vec3 a = (dot(velocity, velocity) != 0.0) ? normalize(velocity) : vec3(0.0, 0.0, 1.0);
+        vec3 b = normalize(vec3(a.z, 0.0, -a.x));
+        vec3 c = cross(a, b);
+        mat4 model = mat4(vec4(b, 0.0), vec4(c, 0.0), vec4(a, 0.0), vec4(aBoidPos.xyz, 1.0));
+        gl_Position = (model * (vec4(aPos, 1.0) * uMesh)) * uProjection;
+        texCoord = aTexCoord;
+        layer = uint(gl_InstanceID) % uSkinCount;
+    }
+)";
+
+// Plays a replay on by a number of frames, starting over at its end.
+static void advance_replay(ReplayPlayer &replay, std::size_t frames) {
+    for (std::size_t i = 0; i < frames; ++i) {
+        if (!replay.next_frame()) {
+            replay.rewind();
+            replay.next_frame();
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     try {
-        SdlSession sdl;
-        SdlWindow window(sdl, {
-                .width = 640,
-                .height = 400,
-                .title = "Hello"
-        });
-        GLSession gl(sdl, window, {
-                .major_version = 3,
-                .minor_version = 3
-        });
+        TRACE_THREAD_NAME("render");
+        auto scenario = Scenario::from_command_line(argc, argv);
+        if (scenario.benchmark_steps != 0) {
+            run_benchmark(scenario);
+            return 0;
+        }
+
+        // Headless runs have no window, and draw into an offscreen framebuffer of
+        // a context that EGL creates without any display.
+        SdlSession sdl({.video = !scenario.headless});
+        std::optional<SdlWindow> window;
+#ifdef BOIDS_ENABLE_HEADLESS
+        std::optional<EglDisplay> egl;
+#endif
+        std::optional<GLSession> gl_session;
+        if (scenario.headless) {
+#ifdef BOIDS_ENABLE_HEADLESS
+            egl.emplace();
+            gl_session.emplace(*egl, GLConfig{
+                    .major_version = 3,
+                    .minor_version = 3
+            });
+#else
+            throw std::runtime_error("headless rendering needs a build with BOIDS_ENABLE_HEADLESS");
+#endif
+        } else {
+            window.emplace(sdl, WindowConfig{
+                    .width = 640,
+                    .height = 400,
+                    .title = "Hello"
+            });
+            gl_session.emplace(sdl, *window, GLConfig{
+                    .major_version = 3,
+                    .minor_version = 3
+            });
+        }
+        auto const &gl = *gl_session;
+
+        std::optional<OffscreenTarget> offscreen;
+        if (scenario.headless) {
+            offscreen.emplace(gl, scenario.frame_width, scenario.frame_height);
+            offscreen->bind();
+            std::filesystem::create_directories(scenario.frame_output);
+        }
+        auto aspect_ratio = offscreen ? offscreen->aspect_ratio() : window->aspect_ratio();
 
         SdlImageLoader image_loader(sdl);
 
@@ -70,125 +188,351 @@ int main(int argc, char *argv[]) {
                 .fragment_shader(FRAGMENT_SHADER_SOURCE)
                 .build(gl);
 
-        SDL_Surface *rgb_img = image_loader.load_rgb24_image_flipped("assets/boid.png");
-        GLuint tex;
-        glGenTextures(1, &tex);
+        AsyncTextureLoader texture_loader(gl, image_loader);
+        auto boid_texture = texture_loader.load_array(BOID_SKINS);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, rgb_img->w, rgb_img->h, 0, GL_RGB, GL_UNSIGNED_BYTE, rgb_img->pixels);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        SDL_FreeSurface(rgb_img);
-
-        Mesh model = ObjFormat("assets/boid.obj").create_mesh();
+        Mesh model = ObjFormat("assets/boid.obj").create_mesh({
+                .vertex_format = Mesh::VertexFormat::Unorm16,
+                .flip_v = true
+        });
 
         gl.use_program(shader_program);
         glUniform1i(*shader_program.uniform_location("uTex"), 0);
 
         auto fov_degrees = 80.0f;
         auto fov_radians = fov_degrees * std::numbers::pi_v<GLfloat> / 180.0f;
-        auto perspective = Transform<GLfloat>::perspective(fov_radians, window.aspect_ratio(), 0.1, 500.0);
+        auto perspective = Transform<GLfloat>::perspective(fov_radians, aspect_ratio, 0.1, 500.0);
         glUniformMatrix4fv(*shader_program.uniform_location("uProjection"), 1, true, perspective.matrix.data());
+        auto mesh_uniform = *shader_program.uniform_location("uMesh");
+        glUniformMatrix4fv(mesh_uniform, 1, true, model.position_transform().matrix.data());
 
         GLuint vao;
         glGenVertexArrays(1, &vao);
         glBindVertexArray(vao);
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Mesh::Vertex), reinterpret_cast<void const*>(offsetof(Mesh::Vertex, pos)));
-        glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(Mesh::Vertex), reinterpret_cast<void const*>(offsetof(Mesh::Vertex, uv)));
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
+        model.bind_vertex_attributes();
+        InstanceBuffer boid_instances;
+        boid_instances.bind_attributes(2);
+
+        // Obstacles are drawn as one instance each, placed where the boids see them.
+        auto obstacle_scale = scenario.obstacle_placement.scale;
+        auto const &obstacle_offset = scenario.obstacle_placement.offset;
+        InstanceBuffer::Instance obstacle_instance = {
+            .model = {
+                obstacle_scale, 0, 0, 0,
+                0, obstacle_scale, 0, 0,
+                0, 0, obstacle_scale, 0,
+                obstacle_offset[0], obstacle_offset[1], obstacle_offset[2], 1,
+            },
+            .layer = 0,
+        };
+        InstanceBuffer obstacle_instances;
+        obstacle_instances.upload({&obstacle_instance, 1});
+        std::vector<std::unique_ptr<Mesh>> obstacle_models;
+        std::vector<GLuint> obstacle_vaos(scenario.obstacle_objs.size());
+        if (!obstacle_vaos.empty()) {
+            glGenVertexArrays(static_cast<GLsizei>(obstacle_vaos.size()), obstacle_vaos.data());
+        }
+        for (std::size_t i = 0; i < obstacle_vaos.size(); ++i) {
+            obstacle_models.push_back(std::make_unique<Mesh>(scenario.obstacle_objs[i]->create_mesh()));
+            glBindVertexArray(obstacle_vaos[i]);
+            obstacle_models[i]->bind_vertex_attributes();
+            obstacle_instances.bind_attributes(2);
+        }
+        glBindVertexArray(vao);
+
+        // The GPU simulation's boids are drawn with their own program and vertex
+        // array, whose instance attributes follow the simulation's current buffer.
+        std::optional<GLShaderProgram> gpu_program;
+        GLuint gpu_vao = 0;
+        if (scenario.gpu) {
+            gpu_program.emplace(GLShaderProgramBuilder()
+                    .vertex_shader(GPU_VERTEX_SHADER_SOURCE)
+                    .fragment_shader(FRAGMENT_SHADER_SOURCE)
+                    .build(gl));
+            gl.use_program(*gpu_program);
+            glUniform1i(*gpu_program->uniform_location("uTex"), 0);
+            glUniform1ui(*gpu_program->uniform_location("uSkinCount"), static_cast<GLuint>(BOID_SKINS.size()));
+            glUniformMatrix4fv(*gpu_program->uniform_location("uProjection"), 1, true, perspective.matrix.data());
+            glUniformMatrix4fv(*gpu_program->uniform_location("uMesh"), 1, true, model.position_transform().matrix.data());
+            glGenVertexArrays(1, &gpu_vao);
+            glBindVertexArray(gpu_vao);
+            model.bind_vertex_attributes();
+            glBindVertexArray(vao);
+        }
 
         glEnable(GL_DEPTH_TEST);
 
-        constexpr int BOID_COUNT = 100;
-        GLfloat boid_transform_mat_data[Mat4<GLfloat>::ELEM_COUNT * BOID_COUNT];
-
-        Boid boids[BOID_COUNT];
-        Boid::MovementDecision decisions[BOID_COUNT];
-        for (int i = 0; i < BOID_COUNT; ++i) {
-            boids[i] = {
-                .pos = {{
-                    static_cast<GLfloat>(i%5) * 10.0f,
-                    static_cast<GLfloat>(i/5%5) * 10.0f,
-                    static_cast<GLfloat>(-i%25) * 10.0f - 150.0f
-                }},
-                .velocity = {0, 0, 0},
-            };
+        // Either simulates, plays back a recording at replay_speed frames per rendered
+        // frame, or shows a flock streamed from a remote simulation. Headless runs
+        // step their simulation in lock-step with rendering, replay_speed steps per
+        // frame, so that every machine rendering a scenario writes the same frames
+        // however long each takes.
+        std::optional<SimulationThread> simulation;
+        std::optional<Simulation> lockstep;
+        std::optional<ReplayPlayer> replay;
+        std::optional<StreamClient> stream;
+        std::optional<GpuSimulation> gpu;
+        std::uint64_t gpu_steps = 0;
+        auto steps_per_frame = offscreen ? scenario.replay_speed : 1;
+        std::vector<InstanceBuffer::Instance> played_instances;
+        if (!scenario.replay.empty()) {
+            replay.emplace(scenario.replay.c_str());
+            advance_replay(*replay, scenario.first_frame * scenario.replay_speed);
+        } else if (!scenario.stream_connect.empty()) {
+            auto colon = scenario.stream_connect.rfind(':');
+            if (colon == std::string::npos) {
+                throw std::runtime_error("stream_connect expects host:port");
+            }
+            StreamView view;
+            std::memcpy(view.min, scenario.stream_view_min.arr.data(), sizeof(view.min));
+            std::memcpy(view.max, scenario.stream_view_max.arr.data(), sizeof(view.max));
+            stream.emplace(
+                scenario.stream_connect.substr(0, colon),
+                static_cast<std::uint16_t>(std::stoi(scenario.stream_connect.substr(colon + 1))),
+                view);
+        } else if (scenario.gpu) {
+            gpu.emplace(gl, scenario.spawn_boids(), scenario.mindset, scenario.bounds, scenario.interaction.perception_radius);
+            for (std::size_t i = 0; i < scenario.first_frame * steps_per_frame; ++i) {
+                gpu->step();
+            }
+            gpu_steps = scenario.first_frame * steps_per_frame;
+        } else if (offscreen) {
+            lockstep.emplace(scenario.create_simulation());
+            for (std::size_t i = 0; i < scenario.first_frame * steps_per_frame; ++i) {
+                lockstep->step();
+            }
+        } else {
+            SimulationOutputs outputs;
+            if (!scenario.record.empty()) {
+                outputs.recorder = std::make_unique<ReplayRecorder>(scenario.record.c_str(), scenario.mindset, scenario.bounds);
+            }
+            if (!scenario.shared_memory.empty()) {
+                auto capacity = (scenario.shared_memory_capacity != 0) ? scenario.shared_memory_capacity : 4 * scenario.boid_count;
+                outputs.shared_memory = std::make_unique<SharedFlockWriter>(scenario.shared_memory, static_cast<std::uint32_t>(capacity));
+            }
+            if (scenario.stream_port != 0) {
+                outputs.stream = std::make_unique<StreamServer>(scenario.stream_port, scenario.mindset, scenario.bounds, scenario.stream_bandwidth);
+            }
+            simulation.emplace(
+                scenario.create_simulation(),
+                BOID_SKINS.size(),
+                std::chrono::nanoseconds(1'000'000'000 / 60),
+                std::move(outputs));
+        }
+        auto flock_size = scenario.boid_count;
+
+        std::optional<QualityController> quality;
+        if (simulation && scenario.frame_budget_ms > 0) {
+            // Rungs that turn multi-rate updates on measure distance from the
+            // eye, unless the scenario placed a camera of its own.
+            auto multi_rate = scenario.multi_rate;
+            if (!scenario.camera_set) {
+                multi_rate.camera = RENDER_CAMERA;
+            }
+            quality.emplace(QualityControllerConfig{.target_frame_ms = scenario.frame_budget_ms}, scenario.interaction, multi_rate);
         }
 
-        Boid::Mindset mindset = {
-            .obstacle_avoiding_bias = 1.0/5,
-            .centering_bias = 1.0/60,
-            .conforming_bias = 1.0,
-            .maximum_movement = 2.0,
-        };
+        // Headless frames are written with the skins on, rather than with the
+        // placeholder a window shows while they stream in.
+        if (offscreen) {
+            while (!texture_loader.ready(boid_texture)) {
+                texture_loader.upload_pending(TEXTURE_UPLOAD_BYTES_PER_FRAME);
+                SDL_Delay(1);
+            }
+        }
+
+#ifdef BOIDS_ENABLE_PROFILER
+        FrameProfiler profiler;
+#endif
 
+        std::size_t frames_written = 0;
         bool running = true;
         while (running) {
-            SDL_Event e;
-            while (SDL_PollEvent(&e)) {
-                switch (e.type) {
-                    case SDL_QUIT: {
-                        running = false;
-                        break;
+            PROFILE_FRAME_BEGIN(profiler);
+            auto frame_start = std::chrono::steady_clock::now();
+
+            {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Events);
+                SDL_Event e;
+                while (SDL_PollEvent(&e)) {
+                    switch (e.type) {
+                        case SDL_QUIT: {
+                            running = false;
+                            break;
+                        }
+                        case SDL_KEYDOWN: {
+                            if (e.key.keysym.sym == SDLK_F5) {
+                                texture_loader.reload(boid_texture);
+                            } else if (e.key.keysym.sym == SDLK_F12) {
+                                try {
+                                    TRACE_WRITE("boids_trace.json");
+                                } catch (std::runtime_error const &err) {
+                                    SDL_Log("%s", err.what());
+                                }
+                            } else if (!simulation) {
+                                break;
+                            } else if (e.key.keysym.sym == SDLK_F9) {
+                                simulation->request_snapshot("boids.snapshot");
+                            } else if (e.key.keysym.sym == SDLK_EQUALS || e.key.keysym.sym == SDLK_KP_PLUS) {
+                                flock_size = std::max<std::size_t>(flock_size * 2, 1);
+                                simulation->request_boid_count(flock_size);
+                            } else if (e.key.keysym.sym == SDLK_MINUS || e.key.keysym.sym == SDLK_KP_MINUS) {
+                                flock_size /= 2;
+                                simulation->request_boid_count(flock_size);
+                            }
+                            break;
+                        }
                     }
                 }
             }
 
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-
-            for (int i = 0; i < BOID_COUNT; ++i) {
-                Boid::SituationalAwareness awareness;
-                for (int j = 0; j < BOID_COUNT; ++j) {
-                    if (i != j) {
-                        boids[i].consider(awareness, boids[j]);
+            bool new_frame = false;
+            std::span<InstanceBuffer::Instance const> instances;
+            if (simulation) {
+                new_frame = simulation->acquire_latest_frame();
+                if (new_frame) {
+                    PROFILE_CPU_RECORD(profiler, FramePhase::Simulate, simulation->latest_frame().step_ms);
+                }
+                if (simulation->has_frame()) {
+                    instances = simulation->latest_frame().instances;
+                }
+            } else if (replay) {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Simulate);
+                advance_replay(*replay, scenario.replay_speed);
+                fill_instances(replay->boids(), replay->ids(), BOID_SKINS.size(), played_instances);
+                instances = played_instances;
+                new_frame = true;
+            } else if (lockstep) {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Simulate);
+                for (std::size_t i = 0; i < steps_per_frame; ++i) {
+                    lockstep->step();
+                }
+                fill_instances(lockstep->boids(), lockstep->ids(), BOID_SKINS.size(), played_instances);
+                instances = played_instances;
+                new_frame = true;
+            } else if (gpu) {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Simulate);
+                for (std::size_t i = 0; i < steps_per_frame; ++i) {
+                    if (scenario.gpu_validate_interval != 0 && gpu_steps % scenario.gpu_validate_interval == 0) {
+                        auto validation = gpu->validate_step();
+                        auto tolerance = GpuValidation::TOLERANCE * scenario.mindset.maximum_movement;
+                        SDL_Log("GPU step %llu against the CPU: position error %g, velocity error %g (%s tolerance %g)",
+                                static_cast<unsigned long long>(gpu_steps), validation.max_position_error, validation.max_velocity_error,
+                                (validation.max_position_error <= tolerance && validation.max_velocity_error <= tolerance) ? "within" : "BEYOND",
+                                tolerance);
+                    } else {
+                        gpu->step();
                     }
+                    ++gpu_steps;
                 }
-                decisions[i] = awareness.into_decision(mindset);
+                glBindVertexArray(vao);
+            } else {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Simulate);
+                new_frame = stream->poll();
+                if (new_frame) {
+                    fill_instances(stream->boids(), stream->ids(), BOID_SKINS.size(), played_instances);
+                }
+                instances = played_instances;
             }
 
-            for (int i = 0; i < BOID_COUNT; ++i) {
-                Boid &b = boids[i];
-                b.act_upon(decisions[i]);
-                if (b.pos[0] > 50*3) {
-                    b.pos[0] -= 100*3;
-                } else if (b.pos[0] < -50*3) {
-                    b.pos[0] += 100*3;
+            {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Upload);
+                PROFILE_GPU_BEGIN(profiler, FramePhase::Upload);
+                texture_loader.upload_pending(TEXTURE_UPLOAD_BYTES_PER_FRAME);
+                if (new_frame) {
+                    boid_instances.upload(instances);
                 }
+                PROFILE_GPU_END(profiler);
+            }
 
-                if (b.pos[1] > 40*3) {
-                    b.pos[1] -= 80*3;
-                } else if (b.pos[1] < -40*3) {
-                    b.pos[1] += 80*3;
+            {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Draw);
+                TRACE_SCOPE("draw", "render");
+                PROFILE_GPU_BEGIN(profiler, FramePhase::Draw);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                gl.use_program(shader_program);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D_ARRAY, texture_loader.texture(boid_texture));
+                if (!instances.empty()) {
+                    model.draw_instances(static_cast<GLsizei>(instances.size()));
                 }
-
-                if (b.pos[2] > -10) {
-                    b.pos[2] -= 400;
-                } else if (b.pos[2] < -410) {
-                    b.pos[2] += 400;
+                if (gpu) {
+                    gl.use_program(*gpu_program);
+                    glBindVertexArray(gpu_vao);
+                    gpu->bind_instance_attributes(2);
+                    model.draw_instances(static_cast<GLsizei>(gpu->size()));
+                    glBindVertexArray(vao);
+                    gl.use_program(shader_program);
                 }
-
-                auto trans = boids[i].transform().matrix;
-                std::memcpy(&boid_transform_mat_data[i * 16], trans.data(), sizeof(GLfloat) * 16);
+                if (!obstacle_models.empty()) {
+                    for (std::size_t i = 0; i < obstacle_models.size(); ++i) {
+                        glBindVertexArray(obstacle_vaos[i]);
+                        glUniformMatrix4fv(mesh_uniform, 1, true, obstacle_models[i]->position_transform().matrix.data());
+                        obstacle_models[i]->draw_instances(1);
+                    }
+                    glBindVertexArray(vao);
+                    glUniformMatrix4fv(mesh_uniform, 1, true, model.position_transform().matrix.data());
+                }
+                PROFILE_GPU_END(profiler);
             }
 
-            gl.use_program(shader_program);
+            // Swapping waits for the display, and writing a headless frame for the
+            // disk; neither is part of the frame's cost.
+            std::chrono::duration<double, std::milli> render_time = std::chrono::steady_clock::now() - frame_start;
+            {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Swap);
+                TRACE_SCOPE("swap", "render");
+                if (offscreen) {
+                    auto path = std::format("{}/frame_{:06}.ppm", scenario.frame_output, scenario.first_frame + frames_written);
+                    offscreen->write_ppm(path.c_str());
+                    if (++frames_written >= scenario.frames) {
+                        running = false;
+                    }
+                } else {
+                    window->swap_buffers();
+                }
+            }
 
+            if (quality) {
+                auto sim_ms = simulation->has_frame() ? simulation->latest_frame().step_ms : 0.0;
+                if (quality->update(sim_ms, render_time.count())) {
+                    simulation->request_quality(quality->knobs());
+                }
+                quality->export_metrics();
+            }
 
-            glUniformMatrix4fv(*shader_program.uniform_location("uModels"), BOID_COUNT, true, boid_transform_mat_data);
-            model.draw_instances(BOID_COUNT);
+            // Headless runs render as fast as they can.
+            if (!offscreen) {
+                PROFILE_CPU_SCOPE(profiler, FramePhase::Delay);
+                SDL_Delay(1000/60);
+            }
 
-            window.swap_buffers();
+            PROFILE_FRAME_END(profiler);
+        }
 
-            SDL_Delay(1000/60);
+        if (offscreen) {
+            SDL_Log("Wrote %zu frames of %dx%d to %s", frames_written,
+                    scenario.frame_width, scenario.frame_height, scenario.frame_output.c_str());
+        }
+        if (simulation && simulation->has_frame()) {
+            auto const &frame = simulation->latest_frame();
+            if (frame.cache_counts.references != 0) {
+                SDL_Log("Simulation cache miss rate: %.2f%% over %llu steps",
+                        100.0 * frame.cache_counts.miss_rate(),
+                        static_cast<unsigned long long>(frame.step));
+            }
+            SDL_Log("Page faults: %llu minor, %llu major",
+                    static_cast<unsigned long long>(frame.page_faults.minor),
+                    static_cast<unsigned long long>(frame.page_faults.major));
         }
 
-    } catch(std::runtime_error const &err) {
+#ifdef BOIDS_ENABLE_PROFILER
+        profiler.log_summary();
+        profiler.write_csv("frame_profile.csv");
+#endif
+        TRACE_WRITE("boids_trace.json");
+
+    } catch(std::exception const &err) {
         SDL_Log(err.what());
         return 1;
     }
@@ -0,0 +1,248 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <format>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(char const *path):
+    data_(nullptr),
+    size_(0),
+    writable_(false),
+    mapping_(nullptr)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(std::format("Could not open file '{}'", path));
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error(std::format("Could not get size of file '{}'", path));
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping_ == nullptr) {
+        throw std::runtime_error(std::format("Could not map file '{}'", path));
+    }
+
+    data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        throw std::runtime_error(std::format("Could not map file '{}'", path));
+    }
+}
+
+MappedFile::MappedFile(char const *path, std::size_t size):
+    data_(nullptr),
+    size_(size),
+    writable_(true),
+    mapping_(nullptr)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(std::format("Could not create file '{}'", path));
+    }
+    if (size_ == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    file_size.QuadPart = static_cast<LONGLONG>(size_);
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_READWRITE, file_size.HighPart, file_size.LowPart, nullptr);
+    CloseHandle(file);
+    if (mapping_ == nullptr) {
+        throw std::runtime_error(std::format("Could not map file '{}' for writing", path));
+    }
+
+    data_ = MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0);
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        throw std::runtime_error(std::format("Could not map file '{}' for writing", path));
+    }
+}
+
+void MappedFile::prefetch(std::size_t offset, std::size_t size) const noexcept {
+    if (size == 0) {
+        return;
+    }
+    WIN32_MEMORY_RANGE_ENTRY range = {static_cast<std::byte *>(data_) + offset, size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::release(std::size_t offset, std::size_t size) const noexcept {
+    // Windows trims clean file pages on its own; only the write-back is requested.
+    if (writable_ && size != 0) {
+        FlushViewOfFile(static_cast<std::byte *>(data_) + offset, size);
+    }
+}
+
+void MappedFile::unmap() noexcept {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept:
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    writable_(other.writable_),
+    mapping_(std::exchange(other.mapping_, nullptr))
+{}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    writable_ = other.writable_;
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(char const *path):
+    data_(nullptr),
+    size_(0),
+    writable_(false)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error(std::format("Could not open file '{}'", path));
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error(std::format("Could not get size of file '{}'", path));
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ == 0) {
+        close(fd);
+        return;
+    }
+
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(std::format("Could not map file '{}'", path));
+    }
+    data_ = data;
+}
+
+MappedFile::MappedFile(char const *path, std::size_t size):
+    data_(nullptr),
+    size_(size),
+    writable_(true)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error(std::format("Could not create file '{}'", path));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        close(fd);
+        throw std::runtime_error(std::format("Could not resize file '{}' to {} bytes", path, size_));
+    }
+    if (size_ == 0) {
+        close(fd);
+        return;
+    }
+
+    void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(std::format("Could not map file '{}' for writing", path));
+    }
+    data_ = data;
+}
+
+// madvise and msync take page-aligned addresses.
+static std::pair<void *, std::size_t> page_range(void *data, std::size_t offset, std::size_t size) noexcept {
+    auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    auto begin = offset / page * page;
+    return {static_cast<std::byte *>(data) + begin, offset + size - begin};
+}
+
+void MappedFile::prefetch(std::size_t offset, std::size_t size) const noexcept {
+    if (size == 0) {
+        return;
+    }
+    auto [address, length] = page_range(data_, offset, size);
+    madvise(address, length, MADV_WILLNEED);
+}
+
+void MappedFile::release(std::size_t offset, std::size_t size) const noexcept {
+    if (size == 0) {
+        return;
+    }
+    auto [address, length] = page_range(data_, offset, size);
+    if (writable_) {
+        msync(address, length, MS_ASYNC);
+    }
+    // Dirty pages of a shared mapping stay in the page cache until written back.
+    madvise(address, length, MADV_DONTNEED);
+}
+
+void MappedFile::unmap() noexcept {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept:
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    writable_(other.writable_)
+{}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    writable_ = other.writable_;
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() noexcept {
+    unmap();
+}
+
+std::span<std::byte const> MappedFile::bytes() const noexcept {
+    return {static_cast<std::byte const *>(data_), size_};
+}
+
+std::span<std::byte> MappedFile::writable_bytes() const noexcept {
+    if (!writable_) {
+        return {};
+    }
+    return {static_cast<std::byte *>(data_), size_};
+}
@@ -0,0 +1,45 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_MAPPED_FILE_HPP
+#define SDL_GLEW_TEST_MAPPED_FILE_HPP
+
+#include <span>
+#include <cstddef>
+
+// Memory mapping of a whole file: read-only, or read-write for a file created
+// at a fixed size, whose changes reach the file.
+class MappedFile {
+public:
+    explicit MappedFile(char const *path);
+    // Creates the file, replacing any existing one, and maps it for writing.
+    MappedFile(char const *path, std::size_t size);
+    ~MappedFile() noexcept;
+
+    MappedFile(MappedFile const &other) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile const &other) = delete;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    [[nodiscard]] std::span<std::byte const> bytes() const noexcept;
+    // Empty unless the file was mapped for writing.
+    [[nodiscard]] std::span<std::byte> writable_bytes() const noexcept;
+
+    // Paging hints for streaming through files larger than memory: start reading
+    // a range in ahead of use, or write a range back and drop it from memory.
+    void prefetch(std::size_t offset, std::size_t size) const noexcept;
+    void release(std::size_t offset, std::size_t size) const noexcept;
+
+private:
+    void unmap() noexcept;
+
+    void *data_;
+    std::size_t size_;
+    bool writable_;
+#ifdef _WIN32
+    void *mapping_;
+#endif
+};
+
+#endif //SDL_GLEW_TEST_MAPPED_FILE_HPP
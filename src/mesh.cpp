@@ -3,8 +3,64 @@
 //
 
 #include "mesh.hpp"
+#include "trace.hpp"
 
-Mesh::Mesh(std::span<Vertex> vertex_data, std::span<GLuint> element_data) {
+#include <stdexcept>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+static Mesh::Bounds compute_bounds(std::span<Mesh::Vertex const> vertex_data) noexcept {
+    if (vertex_data.empty()) {
+        return {{{0, 0, 0}}, {{0, 0, 0}}};
+    }
+    Mesh::Bounds ret = {
+        {{vertex_data[0].pos[0], vertex_data[0].pos[1], vertex_data[0].pos[2]}},
+        {{vertex_data[0].pos[0], vertex_data[0].pos[1], vertex_data[0].pos[2]}},
+    };
+    for (auto const &vertex : vertex_data) {
+        for (int i = 0; i < 3; ++i) {
+            ret.min[i] = std::min(ret.min[i], vertex.pos[i]);
+            ret.max[i] = std::max(ret.max[i], vertex.pos[i]);
+        }
+    }
+    return ret;
+}
+
+static GLushort quantize_unorm16(GLfloat value, GLfloat min, GLfloat extent) noexcept {
+    if (extent <= 0) {
+        return 0;
+    }
+    auto normalized = std::clamp((value - min) / extent, 0.0f, 1.0f);
+    return static_cast<GLushort>(std::lround(normalized * std::numeric_limits<GLushort>::max()));
+}
+
+static std::vector<Mesh::PackedVertex> pack_vertices(std::span<Mesh::Vertex const> vertex_data, Mesh::Bounds const &bounds) {
+    std::vector<Mesh::PackedVertex> ret;
+    ret.reserve(vertex_data.size());
+    for (auto const &vertex : vertex_data) {
+        Mesh::PackedVertex packed = {};
+        for (int i = 0; i < 3; ++i) {
+            packed.pos[i] = quantize_unorm16(vertex.pos[i], bounds.min[i], bounds.max[i] - bounds.min[i]);
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (vertex.uv[i] < 0 || vertex.uv[i] > 1) {
+                throw std::runtime_error("Cannot pack mesh: texture coordinates must lie within [0, 1]");
+            }
+            packed.uv[i] = quantize_unorm16(vertex.uv[i], 0, 1);
+        }
+        ret.push_back(packed);
+    }
+    return ret;
+}
+
+Mesh::Mesh(std::span<Vertex const> vertex_data, std::span<GLuint const> element_data, VertexFormat format):
+    format(format),
+    mesh_bounds(compute_bounds(vertex_data))
+{
+    TRACE_SCOPE("upload_mesh", "upload");
     vertex_count = static_cast<GLint>(element_data.size());
 
     GLuint buffers[2];
@@ -13,10 +69,27 @@ Mesh::Mesh(std::span<Vertex> vertex_data, std::span<GLuint> element_data) {
     element_array_buffer = buffers[1];
 
     glBindBuffer(GL_ARRAY_BUFFER, array_buffer);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLint>(vertex_data.size_bytes()), vertex_data.data(), GL_STATIC_DRAW);
+    switch (format) {
+        case VertexFormat::Float32: {
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_data.size_bytes()), vertex_data.data(), GL_STATIC_DRAW);
+            break;
+        }
+        case VertexFormat::Unorm16: {
+            auto packed = pack_vertices(vertex_data, mesh_bounds);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(packed.size() * sizeof(PackedVertex)), packed.data(), GL_STATIC_DRAW);
+            break;
+        }
+    }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_array_buffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLint>(element_data.size_bytes()), element_data.data(), GL_STATIC_DRAW);
+    if (vertex_data.size() <= std::numeric_limits<GLushort>::max() + std::size_t{1}) {
+        element_type = GL_UNSIGNED_SHORT;
+        std::vector<GLushort> short_elements(element_data.begin(), element_data.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(short_elements.size() * sizeof(GLushort)), short_elements.data(), GL_STATIC_DRAW);
+    } else {
+        element_type = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(element_data.size_bytes()), element_data.data(), GL_STATIC_DRAW);
+    }
 }
 
 Mesh::~Mesh() noexcept {
@@ -24,8 +97,65 @@ Mesh::~Mesh() noexcept {
     glDeleteBuffers(2, buffers);
 }
 
+Mesh::Mesh(Mesh &&other) noexcept:
+    array_buffer(std::exchange(other.array_buffer, 0)),
+    element_array_buffer(std::exchange(other.element_array_buffer, 0)),
+    vertex_count(other.vertex_count),
+    element_type(other.element_type),
+    format(other.format),
+    mesh_bounds(other.mesh_bounds)
+{}
+
+Mesh &Mesh::operator=(Mesh &&other) noexcept {
+    GLuint buffers[2] = {array_buffer, element_array_buffer};
+    glDeleteBuffers(2, buffers);
+    array_buffer = std::exchange(other.array_buffer, 0);
+    element_array_buffer = std::exchange(other.element_array_buffer, 0);
+    vertex_count = other.vertex_count;
+    element_type = other.element_type;
+    format = other.format;
+    mesh_bounds = other.mesh_bounds;
+    return *this;
+}
+
+void Mesh::bind_vertex_attributes() const {
+    glBindBuffer(GL_ARRAY_BUFFER, array_buffer);
+    switch (format) {
+        case VertexFormat::Float32: {
+            glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), reinterpret_cast<void const*>(offsetof(Vertex, pos)));
+            glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(Vertex), reinterpret_cast<void const*>(offsetof(Vertex, uv)));
+            break;
+        }
+        case VertexFormat::Unorm16: {
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, true, sizeof(PackedVertex), reinterpret_cast<void const*>(offsetof(PackedVertex, pos)));
+            glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, true, sizeof(PackedVertex), reinterpret_cast<void const*>(offsetof(PackedVertex, uv)));
+            break;
+        }
+    }
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+}
+
+Transform<GLfloat> Mesh::position_transform() const noexcept {
+    if (format == VertexFormat::Float32) {
+        return Transform<GLfloat>::identity();
+    }
+    auto extent = mesh_bounds.max - mesh_bounds.min;
+    return Transform<GLfloat>::identity()
+        .scale(extent[0], extent[1], extent[2])
+        .translate(mesh_bounds.min[0], mesh_bounds.min[1], mesh_bounds.min[2]);
+}
+
+Mesh::VertexFormat Mesh::vertex_format() const noexcept {
+    return format;
+}
+
+Mesh::Bounds const &Mesh::bounds() const noexcept {
+    return mesh_bounds;
+}
+
 void Mesh::draw_instances(GLsizei instances) const {
     glBindBuffer(GL_ARRAY_BUFFER, array_buffer);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_array_buffer);
-    glDrawElementsInstanced(GL_TRIANGLES, vertex_count, GL_UNSIGNED_INT, nullptr, instances);
+    glDrawElementsInstanced(GL_TRIANGLES, vertex_count, element_type, nullptr, instances);
 }
@@ -8,6 +8,8 @@
 #include <span>
 
 #include "GL/glew.h"
+#include "matrix.hpp"
+#include "transform.hpp"
 
 class Mesh {
 public:
@@ -16,9 +18,40 @@ public:
         GLfloat uv[2];
     };
 
-    Mesh(std::span<Vertex> vertex_data, std::span<GLuint> element_data);
+    // Positions are normalized against the mesh bounds and UVs against [0, 1].
+    // pos[3] is padding so that uv starts on a 4-byte boundary.
+    struct PackedVertex {
+        GLushort pos[4];
+        GLushort uv[2];
+    };
+
+    enum class VertexFormat {
+        Float32,
+        Unorm16,
+    };
+
+    struct Bounds {
+        Vec3<GLfloat> min;
+        Vec3<GLfloat> max;
+    };
+
+    Mesh(std::span<Vertex const> vertex_data, std::span<GLuint const> element_data, VertexFormat format = VertexFormat::Float32);
     ~Mesh() noexcept;
 
+    Mesh(Mesh const &other) = delete;
+    Mesh(Mesh &&other) noexcept;
+    Mesh &operator=(Mesh const &other) = delete;
+    Mesh &operator=(Mesh &&other) noexcept;
+
+    // Sets vertex attributes 0 (position) and 1 (uv) on the currently bound vertex array.
+    void bind_vertex_attributes() const;
+
+    // Maps stored positions back into model space; identity for Float32 meshes.
+    [[nodiscard]] Transform<GLfloat> position_transform() const noexcept;
+
+    [[nodiscard]] VertexFormat vertex_format() const noexcept;
+    [[nodiscard]] Bounds const &bounds() const noexcept;
+
     void draw_instances(GLsizei instances) const;
 
 private:
@@ -26,6 +59,9 @@ private:
     GLuint element_array_buffer;
 
     GLint vertex_count;
+    GLenum element_type;
+    VertexFormat format;
+    Bounds mesh_bounds;
 };
 
 #endif //SDL_GLEW_TEST_MESH_HPP
@@ -3,6 +3,7 @@
 //
 
 #include "obj_format.hpp"
+#include "trace.hpp"
 
 #include <stdexcept>
 #include <algorithm>
@@ -244,6 +245,7 @@ ObjFormat::ObjFormat(char const *path):
     vt{},
     f{}
 {
+    TRACE_SCOPE("parse_obj", "load");
     ObjParser parser(path);
     if (parser.parse(*this) != Ok) {
         throw std::runtime_error(std::format("Error parsing line: {}", parser.cur_line()));
@@ -268,7 +270,8 @@ struct FaceVertexHasher {
     }
 };
 
-Mesh ObjFormat::create_mesh() const {
+Mesh ObjFormat::create_mesh(MeshConfig config) const {
+    TRACE_SCOPE("create_mesh", "load");
     std::unordered_map<FaceVertex, int, FaceVertexHasher> index_map = {};
     std::vector<Mesh::Vertex> vertices = {};
     std::vector<GLuint> indices = {};
@@ -278,6 +281,9 @@ Mesh ObjFormat::create_mesh() const {
         if (inserted) {
             auto pos = v[fv.v_idx - 1];
             auto uv = fv.vt_idx? vt[*fv.vt_idx - 1] : TexCoord{0.0, 0.0};
+            if (config.flip_v) {
+                uv.y = 1.0f - uv.y;
+            }
             vertices.push_back({pos[0], pos[1], pos[2], uv.x, uv.y});
         }
         return it->second;
@@ -298,5 +304,5 @@ Mesh ObjFormat::create_mesh() const {
         }
     }
 
-    return {vertices, indices};
+    return {vertices, indices, config.vertex_format};
 }
@@ -10,6 +10,12 @@
 #include "mesh.hpp"
 #include "matrix.hpp"
 
+struct MeshConfig {
+    Mesh::VertexFormat vertex_format = Mesh::VertexFormat::Float32;
+    // Use v' = 1 - v, for textures uploaded top row first.
+    bool flip_v = false;
+};
+
 class ObjFormat {
 public:
     struct FaceVertex {
@@ -31,7 +37,7 @@ public:
 
     explicit ObjFormat(char const *path);
 
-    [[nodiscard]] Mesh create_mesh() const;
+    [[nodiscard]] Mesh create_mesh(MeshConfig config = {}) const;
 
     std::vector<Vec4<float>> v;
     std::vector<TexCoord> vt;
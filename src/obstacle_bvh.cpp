@@ -0,0 +1,424 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "obstacle_bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "trace.hpp"
+
+// Ranges of this many triangles or fewer always become leaves.
+constexpr std::size_t LEAF_SIZE = 2;
+// Ranges up to this size also become leaves when no split lowers the surface area cost.
+constexpr std::size_t MAX_LEAF_SIZE = 8;
+constexpr std::size_t BIN_COUNT = 16;
+// Deeper ranges become leaves whatever their size, which bounds the traversal stack.
+constexpr std::size_t MAX_DEPTH = 60;
+constexpr std::size_t STACK_SIZE = MAX_DEPTH + 4;
+
+constexpr GLfloat INF = std::numeric_limits<GLfloat>::infinity();
+
+struct Box {
+    Vec3<GLfloat> min = {{INF, INF, INF}};
+    Vec3<GLfloat> max = {{-INF, -INF, -INF}};
+
+    void grow(Vec3<GLfloat> const &p) noexcept {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], p[i]);
+            max[i] = std::max(max[i], p[i]);
+        }
+    }
+
+    void grow(Box const &other) noexcept {
+        grow(other.min);
+        grow(other.max);
+    }
+
+    // Half the surface area, which is all that the cost comparison needs.
+    [[nodiscard]] GLfloat half_area() const noexcept {
+        auto dx = max[0] - min[0];
+        auto dy = max[1] - min[1];
+        auto dz = max[2] - min[2];
+        return (dx < 0) ? 0 : dx*dy + dy*dz + dz*dx;
+    }
+};
+
+struct Bin {
+    Box box;
+    std::size_t count = 0;
+};
+
+static GLfloat dot(Vec3<GLfloat> const &a, Vec3<GLfloat> const &b) noexcept {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+static Vec3<GLfloat> cross(Vec3<GLfloat> const &a, Vec3<GLfloat> const &b) noexcept {
+    return {{a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2], a[0]*b[1] - a[1]*b[0]}};
+}
+
+static std::size_t bin_of(GLfloat value, GLfloat min, GLfloat scale) noexcept {
+    return std::min(static_cast<std::size_t>((value - min) * scale), BIN_COUNT - 1);
+}
+
+// Partitions order[begin, end) at the cheapest of the binned splits along each
+// axis and returns where the second half starts, or begin to keep the range whole.
+static std::size_t split_range(
+    std::vector<std::uint32_t> &order,
+    std::vector<Box> const &boxes,
+    std::vector<Vec3<GLfloat>> const &centroids,
+    std::size_t begin,
+    std::size_t end,
+    Box const &bounds,
+    Box const &centroid_bounds
+) {
+    auto count = end - begin;
+    auto best_cost = INF;
+    int best_axis = -1;
+    std::size_t best_bin = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        auto extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+        if (extent <= 0) {
+            continue;
+        }
+        auto scale = static_cast<GLfloat>(BIN_COUNT) / extent;
+        Bin bins[BIN_COUNT];
+        for (auto i = begin; i < end; ++i) {
+            auto &bin = bins[bin_of(centroids[order[i]][axis], centroid_bounds.min[axis], scale)];
+            bin.box.grow(boxes[order[i]]);
+            ++bin.count;
+        }
+        GLfloat right_costs[BIN_COUNT];
+        Box right;
+        std::size_t right_count = 0;
+        for (auto b = BIN_COUNT - 1; b > 0; --b) {
+            right.grow(bins[b].box);
+            right_count += bins[b].count;
+            right_costs[b] = right.half_area() * static_cast<GLfloat>(right_count);
+        }
+        Box left;
+        std::size_t left_count = 0;
+        for (std::size_t b = 0; b + 1 < BIN_COUNT; ++b) {
+            left.grow(bins[b].box);
+            left_count += bins[b].count;
+            if (left_count == 0 || left_count == count) {
+                continue;
+            }
+            auto cost = left.half_area() * static_cast<GLfloat>(left_count) + right_costs[b + 1];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = b;
+            }
+        }
+    }
+
+    if (best_axis < 0) {
+        // Every centroid in one spot: any halves will do.
+        return (count > MAX_LEAF_SIZE) ? begin + count / 2 : begin;
+    }
+    if (count <= MAX_LEAF_SIZE && best_cost >= bounds.half_area() * static_cast<GLfloat>(count)) {
+        return begin;
+    }
+    auto min = centroid_bounds.min[best_axis];
+    auto scale = static_cast<GLfloat>(BIN_COUNT) / (centroid_bounds.max[best_axis] - min);
+    auto middle = std::partition(order.begin() + static_cast<std::ptrdiff_t>(begin), order.begin() + static_cast<std::ptrdiff_t>(end),
+                                 [&](std::uint32_t t) { return bin_of(centroids[t][best_axis], min, scale) <= best_bin; });
+    return static_cast<std::size_t>(middle - order.begin());
+}
+
+ObstacleBvh::ObstacleBvh(std::vector<Triangle> const &triangles) {
+    TRACE_SCOPE("build_obstacle_bvh", "load");
+    auto count = triangles.size();
+    if (count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error(std::format("Too many obstacle triangles: {}", count));
+    }
+    std::vector<Box> boxes(count);
+    std::vector<Vec3<GLfloat>> centroids(count);
+    std::vector<std::uint32_t> order(count);
+    for (std::size_t t = 0; t < count; ++t) {
+        auto const &tri = triangles[t];
+        boxes[t].grow(tri.a);
+        boxes[t].grow(tri.b);
+        boxes[t].grow(tri.c);
+        centroids[t] = 1.0f/3 * (tri.a + tri.b + tri.c);
+        order[t] = static_cast<std::uint32_t>(t);
+    }
+
+    struct BuildTask {
+        std::size_t node;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t depth;
+    };
+    std::vector<BuildTask> tasks = {{.node = 0, .begin = 0, .end = count, .depth = 1}};
+    nodes_.resize(1);
+    while (!tasks.empty()) {
+        auto task = tasks.back();
+        tasks.pop_back();
+        depth_ = std::max(depth_, task.depth);
+
+        Box bounds;
+        Box centroid_bounds;
+        for (auto i = task.begin; i < task.end; ++i) {
+            bounds.grow(boxes[order[i]]);
+            centroid_bounds.grow(centroids[order[i]]);
+        }
+        auto middle = task.begin;
+        if (task.end - task.begin > LEAF_SIZE && task.depth < MAX_DEPTH) {
+            middle = split_range(order, boxes, centroids, task.begin, task.end, bounds, centroid_bounds);
+        }
+
+        Node node = {
+            .min = {bounds.min[0], bounds.min[1], bounds.min[2]},
+            .first = static_cast<std::uint32_t>(task.begin),
+            .max = {bounds.max[0], bounds.max[1], bounds.max[2]},
+            .count = static_cast<std::uint32_t>(task.end - task.begin),
+        };
+        if (middle != task.begin && middle != task.end) {
+            auto children = nodes_.size();
+            nodes_.resize(children + 2);
+            node.first = static_cast<std::uint32_t>(children);
+            node.count = 0;
+            tasks.push_back({.node = children, .begin = task.begin, .end = middle, .depth = task.depth + 1});
+            tasks.push_back({.node = children + 1, .begin = middle, .end = task.end, .depth = task.depth + 1});
+        }
+        nodes_[task.node] = node;
+    }
+
+    // Leaves index triangles in tree order, so each leaf's triangles sit together.
+    triangles_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto const &tri = triangles[order[i]];
+        triangles_[i] = {.a = tri.a, .ab = tri.b - tri.a, .ac = tri.c - tri.a};
+    }
+}
+
+// Where the ray enters the node's box, if it does before max_distance. Axes the
+// ray runs parallel to give NaNs, which the comparisons drop.
+static bool enter_box(GLfloat const (&min)[3], GLfloat const (&max)[3], Vec3<GLfloat> const &origin,
+                      Vec3<GLfloat> const &inv_direction, GLfloat max_distance, GLfloat &entry) noexcept {
+    GLfloat t_min = 0;
+    GLfloat t_max = max_distance;
+    for (int i = 0; i < 3; ++i) {
+        auto t0 = (min[i] - origin[i]) * inv_direction[i];
+        auto t1 = (max[i] - origin[i]) * inv_direction[i];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        t_min = std::max(t_min, t0);
+        t_max = std::min(t_max, t1);
+    }
+    entry = t_min;
+    return t_min <= t_max;
+}
+
+static GLfloat distance_sq_to_box(GLfloat const (&min)[3], GLfloat const (&max)[3], Vec3<GLfloat> const &p) noexcept {
+    GLfloat ret = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto d = std::max({min[i] - p[i], 0.0f, p[i] - max[i]});
+        ret += d * d;
+    }
+    return ret;
+}
+
+// The point of triangle (a, a + ab, a + ac) closest to p, found from the
+// Voronoi region of the triangle that p lies in.
+static Vec3<GLfloat> closest_point_on_triangle(Vec3<GLfloat> const &p, Vec3<GLfloat> const &a,
+                                               Vec3<GLfloat> const &ab, Vec3<GLfloat> const &ac) noexcept {
+    auto ap = p - a;
+    auto d1 = dot(ab, ap);
+    auto d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) {
+        return a;
+    }
+    auto bp = ap - ab;
+    auto d3 = dot(ab, bp);
+    auto d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) {
+        return a + ab;
+    }
+    auto vc = d1*d4 - d3*d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        return a + d1 / (d1 - d3) * ab;
+    }
+    auto cp = ap - ac;
+    auto d5 = dot(ab, cp);
+    auto d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) {
+        return a + ac;
+    }
+    auto vb = d5*d2 - d1*d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        return a + d2 / (d2 - d6) * ac;
+    }
+    auto va = d3*d6 - d5*d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        return a + ab + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (ac - ab);
+    }
+    auto denom = 1 / (va + vb + vc);
+    return a + vb * denom * ab + vc * denom * ac;
+}
+
+struct TraversalEntry {
+    std::uint32_t node;
+    // How far the query is from the node's box; the node is skipped if the best answer got closer meanwhile.
+    GLfloat distance;
+};
+
+std::optional<ObstacleBvh::RayHit> ObstacleBvh::raycast(Vec3<GLfloat> const &origin, Vec3<GLfloat> const &direction, GLfloat max_distance) const noexcept {
+    if (triangles_.empty()) {
+        return std::nullopt;
+    }
+    Vec3<GLfloat> inv_direction = {{1 / direction[0], 1 / direction[1], 1 / direction[2]}};
+    auto best = max_distance;
+    std::size_t best_triangle = triangles_.size();
+
+    TraversalEntry stack[STACK_SIZE];
+    std::size_t stack_size = 0;
+    GLfloat entry;
+    if (enter_box(nodes_[0].min, nodes_[0].max, origin, inv_direction, best, entry)) {
+        stack[stack_size++] = {0, entry};
+    }
+    while (stack_size > 0) {
+        auto [index, distance] = stack[--stack_size];
+        if (distance > best) {
+            continue;
+        }
+        auto const &node = nodes_[index];
+        if (node.count > 0) {
+            // Möller-Trumbore: solve origin + t * direction = a + u * ab + v * ac.
+            for (auto t = node.first; t < node.first + node.count; ++t) {
+                auto const &tri = triangles_[t];
+                auto p = cross(direction, tri.ac);
+                auto det = dot(tri.ab, p);
+                if (det == 0) {
+                    continue;
+                }
+                auto inv_det = 1 / det;
+                auto s = origin - tri.a;
+                auto u = dot(s, p) * inv_det;
+                if (u < 0 || u > 1) {
+                    continue;
+                }
+                auto q = cross(s, tri.ab);
+                auto v = dot(direction, q) * inv_det;
+                if (v < 0 || u + v > 1) {
+                    continue;
+                }
+                auto hit = dot(tri.ac, q) * inv_det;
+                if (hit >= 0 && hit < best) {
+                    best = hit;
+                    best_triangle = t;
+                }
+            }
+            continue;
+        }
+        GLfloat entries[2];
+        bool hits[2];
+        for (std::uint32_t c = 0; c < 2; ++c) {
+            auto const &child = nodes_[node.first + c];
+            hits[c] = enter_box(child.min, child.max, origin, inv_direction, best, entries[c]);
+        }
+        // The nearer child goes on top.
+        std::uint32_t nearer = (hits[1] && (!hits[0] || entries[1] < entries[0])) ? 1 : 0;
+        if (hits[1 - nearer]) {
+            stack[stack_size++] = {node.first + 1 - nearer, entries[1 - nearer]};
+        }
+        if (hits[nearer]) {
+            stack[stack_size++] = {node.first + nearer, entries[nearer]};
+        }
+    }
+
+    if (best_triangle == triangles_.size()) {
+        return std::nullopt;
+    }
+    auto const &tri = triangles_[best_triangle];
+    auto normal = cross(tri.ab, tri.ac);
+    normal *= ((dot(normal, direction) > 0) ? -1.0f : 1.0f) / std::sqrt(dot(normal, normal));
+    return RayHit{.distance = best, .normal = normal};
+}
+
+std::optional<ObstacleBvh::Contact> ObstacleBvh::nearest(Vec3<GLfloat> const &center, GLfloat radius) const noexcept {
+    if (triangles_.empty()) {
+        return std::nullopt;
+    }
+    auto best_sq = radius * radius;
+    std::optional<Contact> ret;
+
+    TraversalEntry stack[STACK_SIZE];
+    std::size_t stack_size = 0;
+    auto root_distance_sq = distance_sq_to_box(nodes_[0].min, nodes_[0].max, center);
+    if (root_distance_sq <= best_sq) {
+        stack[stack_size++] = {0, root_distance_sq};
+    }
+    while (stack_size > 0) {
+        auto [index, distance_sq] = stack[--stack_size];
+        if (distance_sq > best_sq) {
+            continue;
+        }
+        auto const &node = nodes_[index];
+        if (node.count > 0) {
+            for (auto t = node.first; t < node.first + node.count; ++t) {
+                auto const &tri = triangles_[t];
+                auto point = closest_point_on_triangle(center, tri.a, tri.ab, tri.ac);
+                auto diff = point - center;
+                auto d_sq = dot(diff, diff);
+                if (d_sq <= best_sq) {
+                    best_sq = d_sq;
+                    ret = Contact{.distance = 0, .point = point};
+                }
+            }
+            continue;
+        }
+        GLfloat distances[2];
+        for (std::uint32_t c = 0; c < 2; ++c) {
+            auto const &child = nodes_[node.first + c];
+            distances[c] = distance_sq_to_box(child.min, child.max, center);
+        }
+        std::uint32_t nearer = (distances[1] < distances[0]) ? 1 : 0;
+        if (distances[1 - nearer] <= best_sq) {
+            stack[stack_size++] = {node.first + 1 - nearer, distances[1 - nearer]};
+        }
+        if (distances[nearer] <= best_sq) {
+            stack[stack_size++] = {node.first + nearer, distances[nearer]};
+        }
+    }
+    if (ret) {
+        ret->distance = std::sqrt(best_sq);
+    }
+    return ret;
+}
+
+std::size_t ObstacleBvh::triangle_count() const noexcept {
+    return triangles_.size();
+}
+
+std::size_t ObstacleBvh::node_count() const noexcept {
+    return nodes_.size();
+}
+
+std::size_t ObstacleBvh::depth() const noexcept {
+    return depth_;
+}
+
+void append_obstacle_triangles(std::vector<ObstacleBvh::Triangle> &triangles, ObjFormat const &mesh, ObstaclePlacement const &placement) {
+    auto place = [&](ObjFormat::FaceVertex const &fv) -> Vec3<GLfloat> {
+        auto const &v = mesh.v[fv.v_idx - 1];
+        return placement.offset + placement.scale * Vec3<GLfloat>{{v[0], v[1], v[2]}};
+    };
+    for (auto const &face : mesh.f) {
+        auto root = place(face.vertices[0]);
+        auto prev = place(face.vertices[1]);
+        for (auto it = face.vertices.begin() + 2; it != face.vertices.end(); ++it) {
+            auto cur = place(*it);
+            triangles.push_back({.a = root, .b = prev, .c = cur});
+            prev = cur;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_OBSTACLE_BVH_HPP
+#define SDL_GLEW_TEST_OBSTACLE_BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "GL/glew.h"
+#include "matrix.hpp"
+#include "obj_format.hpp"
+
+// Where obstacle meshes go in the world: scaled about their origin, then moved by offset.
+struct ObstaclePlacement {
+    Vec3<GLfloat> offset = {{0, 0, 0}};
+    GLfloat scale = 1;
+};
+
+// Static triangles in world space, in a bounding volume hierarchy: a binary
+// tree of boxes split by the surface area heuristic over binned centroids,
+// stored flat with siblings next to each other. Queries visit the nearer child
+// first and skip every box farther away than the best answer so far, so their
+// cost grows with the depth of the tree rather than with the triangle count.
+class ObstacleBvh {
+public:
+    struct Triangle {
+        Vec3<GLfloat> a;
+        Vec3<GLfloat> b;
+        Vec3<GLfloat> c;
+    };
+
+    struct RayHit {
+        GLfloat distance;
+        // Unit normal of the surface hit, facing the ray's origin.
+        Vec3<GLfloat> normal;
+    };
+
+    struct Contact {
+        GLfloat distance;
+        Vec3<GLfloat> point;
+    };
+
+    explicit ObstacleBvh(std::vector<Triangle> const &triangles);
+
+    // The first surface along a unit direction, within max_distance.
+    [[nodiscard]] std::optional<RayHit> raycast(Vec3<GLfloat> const &origin, Vec3<GLfloat> const &direction, GLfloat max_distance) const noexcept;
+    // The closest point of any surface within radius.
+    [[nodiscard]] std::optional<Contact> nearest(Vec3<GLfloat> const &center, GLfloat radius) const noexcept;
+
+    [[nodiscard]] std::size_t triangle_count() const noexcept;
+    [[nodiscard]] std::size_t node_count() const noexcept;
+    [[nodiscard]] std::size_t depth() const noexcept;
+
+private:
+    // Leaves hold triangles [first, first + count); inner nodes have a count of
+    // zero and children first and first + 1.
+    struct Node {
+        GLfloat min[3];
+        std::uint32_t first;
+        GLfloat max[3];
+        std::uint32_t count;
+    };
+
+    // A corner and the two edges leaving it, as the ray test uses them.
+    struct StoredTriangle {
+        Vec3<GLfloat> a;
+        Vec3<GLfloat> ab;
+        Vec3<GLfloat> ac;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<StoredTriangle> triangles_;
+    std::size_t depth_ = 0;
+};
+
+// Appends the faces of a mesh, fanned into triangles, as placed in the world.
+void append_obstacle_triangles(std::vector<ObstacleBvh::Triangle> &triangles, ObjFormat const &mesh, ObstaclePlacement const &placement);
+
+#endif //SDL_GLEW_TEST_OBSTACLE_BVH_HPP
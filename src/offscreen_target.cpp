@@ -0,0 +1,97 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "offscreen_target.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#include "trace.hpp"
+
+OffscreenTarget::OffscreenTarget(GLSession const &, GLsizei width, GLsizei height):
+    width_(width),
+    height_(height)
+{
+    GLint max_renderbuffer_size = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_renderbuffer_size);
+    GLint max_viewport[2] = {};
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, max_viewport);
+    if (width <= 0 || height <= 0
+        || width > max_renderbuffer_size || width > max_viewport[0]
+        || height > max_renderbuffer_size || height > max_viewport[1]) {
+        throw std::runtime_error(std::format("Cannot render {}x{} frames; the GL allows up to {}x{}",
+                                             width, height,
+                                             std::min(max_renderbuffer_size, max_viewport[0]),
+                                             std::min(max_renderbuffer_size, max_viewport[1])));
+    }
+
+    glGenRenderbuffers(2, renderbuffers_);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers_[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers_[1]);
+    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(2, renderbuffers_);
+        throw std::runtime_error(std::format("Offscreen framebuffer incomplete: {:#x}", status));
+    }
+}
+
+OffscreenTarget::~OffscreenTarget() noexcept {
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteRenderbuffers(2, renderbuffers_);
+}
+
+void OffscreenTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+}
+
+float OffscreenTarget::aspect_ratio() const noexcept {
+    return static_cast<float>(width_) / static_cast<float>(height_);
+}
+
+void OffscreenTarget::write_ppm(char const *path) {
+    TRACE_SCOPE("write_frame", "render");
+    auto row_bytes = 3 * static_cast<std::size_t>(width_);
+    auto height = static_cast<std::size_t>(height_);
+    rows_.resize(row_bytes * height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, rows_.data());
+
+    // GL rows run bottom to top, PPM rows top to bottom.
+    auto header = std::format("P6\n{} {}\n255\n", width_, height_);
+    image_.resize(header.size() + rows_.size());
+    std::memcpy(image_.data(), header.data(), header.size());
+    auto *pixels = image_.data() + header.size();
+    for (std::size_t y = 0; y < height; ++y) {
+        std::memcpy(pixels + y * row_bytes, rows_.data() + (height - 1 - y) * row_bytes, row_bytes);
+    }
+
+    FILE *file;
+    if (fopen_s(&file, path, "wb") != 0) {
+        throw std::runtime_error(std::format("Could not open frame '{}' for writing", path));
+    }
+    auto written = fwrite(image_.data(), 1, image_.size(), file);
+    bool ok = fclose(file) == 0 && written == image_.size();
+    if (!ok) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        throw std::runtime_error(std::format("Error writing frame '{}'", path));
+    }
+}
@@ -0,0 +1,47 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_OFFSCREEN_TARGET_HPP
+#define SDL_GLEW_TEST_OFFSCREEN_TARGET_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "GL/glew.h"
+
+class GLSession;
+
+// A framebuffer object with color and depth renderbuffers of any size the GL
+// allows, drawn into in place of a window and read back as image files.
+class OffscreenTarget {
+public:
+    OffscreenTarget(GLSession const &gl, GLsizei width, GLsizei height);
+    ~OffscreenTarget() noexcept;
+
+    OffscreenTarget(OffscreenTarget const &other) = delete;
+    OffscreenTarget(OffscreenTarget &&other) = delete;
+    OffscreenTarget &operator=(OffscreenTarget const &other) = delete;
+    OffscreenTarget &operator=(OffscreenTarget &&other) = delete;
+
+    // Binds the framebuffer for drawing and sets the viewport to cover it.
+    void bind() const;
+
+    [[nodiscard]] float aspect_ratio() const noexcept;
+
+    // Reads the framebuffer back, which waits for drawing to finish, and writes
+    // it to path as a binary PPM.
+    void write_ppm(char const *path);
+
+private:
+    GLuint framebuffer_ = 0;
+    // Color, then depth.
+    GLuint renderbuffers_[2] = {};
+    GLsizei width_;
+    GLsizei height_;
+    // Header and rows of the last frame written, kept to reuse the allocation.
+    std::vector<unsigned char> image_;
+    std::vector<unsigned char> rows_;
+};
+
+#endif //SDL_GLEW_TEST_OFFSCREEN_TARGET_HPP
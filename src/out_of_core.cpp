@@ -0,0 +1,223 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "out_of_core.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+#include "trace.hpp"
+
+constexpr std::size_t MAX_TILES_PER_AXIS = 128;
+// Span of the staging file regrouped between paging hints.
+constexpr std::size_t REGROUP_WINDOW_BYTES = 32 * 1024 * 1024;
+
+static GLfloat distance_sq(Vec3<GLfloat> const &a, Vec3<GLfloat> const &b) noexcept {
+    GLfloat ret = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto d = b[i] - a[i];
+        ret += d * d;
+    }
+    return ret;
+}
+
+// Checked while the members are initialized, before the state files are created.
+static GLfloat checked_radius_sq(GLfloat perception_radius) {
+    if (!std::isfinite(perception_radius) || perception_radius <= 0) {
+        throw std::runtime_error(std::format(
+            "Out-of-core simulation needs a finite positive perception radius (got {})", perception_radius));
+    }
+    return perception_radius * perception_radius;
+}
+
+static std::string state_file(std::string const &directory, char const *name) {
+    std::filesystem::create_directories(directory);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+OutOfCoreSimulation::OutOfCoreSimulation(
+    std::string const &directory,
+    std::uint64_t count,
+    Spawner const &spawn,
+    Boid::Mindset mindset,
+    WorldBounds bounds,
+    GLfloat perception_radius,
+    std::size_t thread_count
+):
+    mindset_(mindset),
+    bounds_(bounds),
+    radius_sq_(checked_radius_sq(perception_radius)),
+    count_(count),
+    tiles_(state_file(directory, "tiles.bin").c_str(), count * sizeof(Record)),
+    staging_(state_file(directory, "staging.bin").c_str(), count * sizeof(Record)),
+    pool_(thread_count)
+{
+    std::size_t tile_count = 1;
+    for (int i = 0; i < 3; ++i) {
+        auto extent = bounds.max[i] - bounds.min[i];
+        grid_[i] = std::clamp<std::size_t>(static_cast<std::size_t>(extent / perception_radius), 1, MAX_TILES_PER_AXIS);
+        tile_size_[i] = extent / static_cast<GLfloat>(grid_[i]);
+        tile_count *= grid_[i];
+    }
+
+    auto tile_bytes = tiles_.writable_bytes();
+    auto staged_bytes = staging_.writable_bytes();
+    tile_records_ = {reinterpret_cast<Record *>(tile_bytes.data()), count};
+    staged_records_ = {reinterpret_cast<Record *>(staged_bytes.data()), count};
+    tile_starts_.resize(tile_count + 1);
+    staged_counts_ = std::make_unique<std::atomic<std::uint64_t>[]>(tile_count);
+    cursors_.resize(tile_count);
+
+    {
+        TRACE_SCOPE("out_of_core_spawn", "sim");
+        for (std::uint64_t id = 0; id < count; ++id) {
+            auto &record = staged_records_[id];
+            record = {.boid = spawn(id), .id = id};
+            bounds_.wrap(record.boid.pos);
+            staged_counts_[tile_of(record.boid.pos)].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    regroup();
+}
+
+void OutOfCoreSimulation::step() {
+    TRACE_SCOPE("out_of_core_step", "sim");
+    auto tile_count = tile_starts_.size() - 1;
+    for (std::size_t t = 0; t < tile_count; ++t) {
+        staged_counts_[t].store(0, std::memory_order_relaxed);
+    }
+
+    auto planes = grid_[2];
+    for (std::size_t z = 0; z < std::min<std::size_t>(planes, 2); ++z) {
+        auto [offset, size] = plane_range(z);
+        tiles_.prefetch(offset, size);
+    }
+    for (std::size_t z = 0; z < planes; ++z) {
+        if (z + 2 < planes) {
+            auto [offset, size] = plane_range(z + 2);
+            tiles_.prefetch(offset, size);
+        }
+        step_plane(z);
+
+        auto [offset, size] = plane_range(z);
+        staging_.release(offset, size);
+        if (z >= 1) {
+            auto [behind_offset, behind_size] = plane_range(z - 1);
+            tiles_.release(behind_offset, behind_size);
+        }
+    }
+    auto [offset, size] = plane_range(planes - 1);
+    tiles_.release(offset, size);
+
+    regroup();
+}
+
+void OutOfCoreSimulation::step_plane(std::size_t z) {
+    TRACE_SCOPE("out_of_core_plane", "sim");
+    auto nx = grid_[0];
+    auto ny = grid_[1];
+    auto nz = grid_[2];
+    auto plane = nx * ny;
+    pool_.parallel_for(plane, 1, [&](std::size_t begin, std::size_t end) {
+        for (auto local = begin; local < end; ++local) {
+            auto x = local % nx;
+            auto y = local / nx;
+            auto tile = z * plane + local;
+            for (auto r = tile_starts_[tile]; r < tile_starts_[tile + 1]; ++r) {
+                Record const &self = tile_records_[r];
+                Boid::SituationalAwareness awareness;
+                for (auto cz = (z > 0) ? z - 1 : z; cz <= std::min(z + 1, nz - 1); ++cz) {
+                    for (auto cy = (y > 0) ? y - 1 : y; cy <= std::min(y + 1, ny - 1); ++cy) {
+                        for (auto cx = (x > 0) ? x - 1 : x; cx <= std::min(x + 1, nx - 1); ++cx) {
+                            for (auto const &other : tile_records((cz * ny + cy) * nx + cx)) {
+                                if (&other != &self && distance_sq(self.boid.pos, other.boid.pos) < radius_sq_) {
+                                    self.boid.consider(awareness, other.boid);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                Record &next = staged_records_[r];
+                next = self;
+                if (awareness.total_inv_dist_sq > 0) {
+                    next.boid.act_upon(awareness.into_decision(mindset_));
+                } else {
+                    // Nobody in sight: keep going the same way.
+                    next.boid.act_upon({next.boid.velocity});
+                }
+                bounds_.wrap(next.boid.pos);
+                staged_counts_[tile_of(next.boid.pos)].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+void OutOfCoreSimulation::regroup() {
+    TRACE_SCOPE("out_of_core_regroup", "sim");
+    auto tile_count = tile_starts_.size() - 1;
+    tile_starts_[0] = 0;
+    for (std::size_t t = 0; t < tile_count; ++t) {
+        tile_starts_[t + 1] = tile_starts_[t] + staged_counts_[t].load(std::memory_order_relaxed);
+    }
+    std::copy(tile_starts_.begin(), tile_starts_.end() - 1, cursors_.begin());
+
+    // One pass over the staging file; each tile's records are appended in order,
+    // so the writes are as many sequential streams as there are tiles.
+    constexpr std::size_t window = REGROUP_WINDOW_BYTES / sizeof(Record);
+    staging_.prefetch(0, std::min<std::uint64_t>(window, count_) * sizeof(Record));
+    for (std::uint64_t begin = 0; begin < count_; begin += window) {
+        auto end = std::min<std::uint64_t>(begin + window, count_);
+        if (end < count_) {
+            staging_.prefetch(end * sizeof(Record), (std::min<std::uint64_t>(end + window, count_) - end) * sizeof(Record));
+        }
+        for (auto i = begin; i < end; ++i) {
+            auto const &record = staged_records_[i];
+            tile_records_[cursors_[tile_of(record.boid.pos)]++] = record;
+        }
+        staging_.release(begin * sizeof(Record), (end - begin) * sizeof(Record));
+    }
+}
+
+std::uint64_t OutOfCoreSimulation::boid_count() const noexcept {
+    return count_;
+}
+
+std::array<std::size_t, 3> OutOfCoreSimulation::tile_grid() const noexcept {
+    return grid_;
+}
+
+std::uint64_t OutOfCoreSimulation::bytes_per_step() const noexcept {
+    // Tiles read, staging written, staging read, tiles written.
+    return 4 * count_ * sizeof(Record);
+}
+
+void OutOfCoreSimulation::for_each_boid(std::function<void(Record const &record)> const &fn) const {
+    for (auto const &record : tile_records_) {
+        fn(record);
+    }
+}
+
+std::size_t OutOfCoreSimulation::tile_of(Vec3<GLfloat> const &pos) const noexcept {
+    std::size_t cell[3];
+    for (int i = 0; i < 3; ++i) {
+        auto c = static_cast<std::ptrdiff_t>((pos[i] - bounds_.min[i]) / tile_size_[i]);
+        cell[i] = static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(c, 0, static_cast<std::ptrdiff_t>(grid_[i]) - 1));
+    }
+    return (cell[2] * grid_[1] + cell[1]) * grid_[0] + cell[0];
+}
+
+std::span<OutOfCoreSimulation::Record const> OutOfCoreSimulation::tile_records(std::size_t tile) const noexcept {
+    return tile_records_.subspan(tile_starts_[tile], tile_starts_[tile + 1] - tile_starts_[tile]);
+}
+
+std::pair<std::size_t, std::size_t> OutOfCoreSimulation::plane_range(std::size_t z) const noexcept {
+    auto plane = grid_[0] * grid_[1];
+    auto begin = tile_starts_[z * plane];
+    auto end = tile_starts_[(z + 1) * plane];
+    return {begin * sizeof(Record), (end - begin) * sizeof(Record)};
+}
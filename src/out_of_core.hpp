@@ -0,0 +1,96 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_OUT_OF_CORE_HPP
+#define SDL_GLEW_TEST_OUT_OF_CORE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+#include "mapped_file.hpp"
+#include "simulation.hpp"
+#include "worker_pool.hpp"
+
+// A flock kept in memory-mapped files rather than memory, for offline runs of
+// flocks larger than RAM. The world is cut into tiles at least one perception
+// radius wide, and boids are stored grouped by tile, tiles in z, y, x order.
+//
+// A step streams through the tiles one z plane at a time. Each boid sees only
+// boids in its own and adjacent tiles, so only three planes have to be in memory;
+// the plane after them is prefetched and the one behind is written back and
+// dropped. Stepped boids go to a staging file in the same order, and are then
+// re-grouped by their new tiles in one sequential pass over it. Every file is
+// thus read and written front to back, never randomly.
+class OutOfCoreSimulation {
+public:
+    struct Record {
+        Boid boid;
+        std::uint64_t id;
+    };
+
+    // Called with every id from 0 up, in order.
+    using Spawner = std::function<Boid(std::uint64_t id)>;
+
+    OutOfCoreSimulation(
+        std::string const &directory,
+        std::uint64_t count,
+        Spawner const &spawn,
+        Boid::Mindset mindset,
+        WorldBounds bounds,
+        GLfloat perception_radius,
+        std::size_t thread_count = 0);
+
+    OutOfCoreSimulation(OutOfCoreSimulation const &other) = delete;
+    OutOfCoreSimulation(OutOfCoreSimulation &&other) = delete;
+    OutOfCoreSimulation &operator=(OutOfCoreSimulation const &other) = delete;
+    OutOfCoreSimulation &operator=(OutOfCoreSimulation &&other) = delete;
+
+    void step();
+
+    [[nodiscard]] std::uint64_t boid_count() const noexcept;
+    [[nodiscard]] std::array<std::size_t, 3> tile_grid() const noexcept;
+    // Bytes read and written through the file mappings by one step.
+    [[nodiscard]] std::uint64_t bytes_per_step() const noexcept;
+    // Every boid, in storage order.
+    void for_each_boid(std::function<void(Record const &record)> const &fn) const;
+
+private:
+    [[nodiscard]] std::size_t tile_of(Vec3<GLfloat> const &pos) const noexcept;
+    [[nodiscard]] std::span<Record const> tile_records(std::size_t tile) const noexcept;
+    // Byte offset and size of a z plane of tiles, the same in both files.
+    [[nodiscard]] std::pair<std::size_t, std::size_t> plane_range(std::size_t z) const noexcept;
+    void step_plane(std::size_t z);
+    // Groups the staged boids by tile, from the counts taken while staging them.
+    void regroup();
+
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    GLfloat radius_sq_;
+    std::uint64_t count_;
+    std::array<std::size_t, 3> grid_;
+    Vec3<GLfloat> tile_size_;
+
+    MappedFile tiles_;
+    MappedFile staging_;
+    std::span<Record> tile_records_;
+    std::span<Record> staged_records_;
+    // Start of each tile's records, plus the total.
+    std::vector<std::uint64_t> tile_starts_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> staged_counts_;
+    std::vector<std::uint64_t> cursors_;
+
+    WorkerPool pool_;
+};
+
+#endif //SDL_GLEW_TEST_OUT_OF_CORE_HPP
@@ -0,0 +1,93 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "page_allocator.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::size_t mapped_size(std::size_t bytes) noexcept {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+#ifdef __linux__
+
+void *map_pages(std::size_t bytes, PagePolicy policy) noexcept {
+    auto size = mapped_size(bytes);
+    if (policy == PagePolicy::ExplicitHuge) {
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (data != MAP_FAILED) {
+            return data;
+        }
+    }
+    if (policy == PagePolicy::Default) {
+        return nullptr;
+    }
+    // mmap only aligns to small pages, and a transparent huge page can only back
+    // an aligned 2 MiB range, so map one huge page more and trim both ends.
+    auto *raw = static_cast<char *>(mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    auto lead = (HUGE_PAGE_SIZE - reinterpret_cast<std::uintptr_t>(raw) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if (lead != 0) {
+        munmap(raw, lead);
+    }
+    munmap(raw + lead + size, HUGE_PAGE_SIZE - lead);
+    void *data = raw + lead;
+    // Only advice: the kernel may have transparent huge pages disabled.
+    madvise(data, size, MADV_HUGEPAGE);
+    return data;
+}
+
+void unmap_pages(void *data, std::size_t bytes) noexcept {
+    munmap(data, mapped_size(bytes));
+}
+
+int current_numa_node() noexcept {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return -1;
+    }
+    return static_cast<int>(node);
+}
+
+bool query_page_nodes(std::span<void const *const> pages, std::span<int> nodes) noexcept {
+    // With no target nodes, move_pages only reports where each page is.
+    auto result = syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, nodes.data(), 0);
+    return result == 0;
+}
+
+PageFaults process_page_faults() noexcept {
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return {static_cast<std::uint64_t>(usage.ru_minflt), static_cast<std::uint64_t>(usage.ru_majflt)};
+}
+
+#else
+
+void *map_pages(std::size_t, PagePolicy) noexcept {
+    return nullptr;
+}
+
+void unmap_pages(void *, std::size_t) noexcept {}
+
+int current_numa_node() noexcept {
+    return -1;
+}
+
+bool query_page_nodes(std::span<void const *const>, std::span<int>) noexcept {
+    return false;
+}
+
+PageFaults process_page_faults() noexcept {
+    return {};
+}
+
+#endif
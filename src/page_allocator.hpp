@@ -0,0 +1,47 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_PAGE_ALLOCATOR_HPP
+#define SDL_GLEW_TEST_PAGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+enum class PagePolicy {
+    // Ordinary heap allocation.
+    Default,
+    // Anonymous mapping advised for transparent huge pages.
+    TransparentHuge,
+    // Mapping from the reserved huge page pool (vm.nr_hugepages), falling back to
+    // transparent huge pages when the pool is exhausted.
+    ExplicitHuge,
+};
+
+// Allocations smaller than this stay on the heap whatever the policy.
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Maps `bytes` (rounded up to HUGE_PAGE_SIZE) of zeroed memory that is not
+// touched yet, so physical pages are placed on the NUMA node of whichever thread
+// first writes them. Returns nullptr if the policy is not supported here.
+[[nodiscard]] void *map_pages(std::size_t bytes, PagePolicy policy) noexcept;
+void unmap_pages(void *data, std::size_t bytes) noexcept;
+[[nodiscard]] std::size_t mapped_size(std::size_t bytes) noexcept;
+
+// NUMA node of the CPU the calling thread is running on, or -1 if unknown.
+[[nodiscard]] int current_numa_node() noexcept;
+
+// NUMA node currently holding each page (negative where unknown or not yet
+// touched). Returns false if placement cannot be queried.
+bool query_page_nodes(std::span<void const *const> pages, std::span<int> nodes) noexcept;
+
+struct PageFaults {
+    std::uint64_t minor = 0;
+    std::uint64_t major = 0;
+};
+
+// Faults taken by the whole process so far.
+[[nodiscard]] PageFaults process_page_faults() noexcept;
+
+#endif //SDL_GLEW_TEST_PAGE_ALLOCATOR_HPP
@@ -0,0 +1,153 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "quality_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "SDL_log.h"
+
+#include "trace.hpp"
+
+// Weight of each new frame in the smoothed load.
+constexpr double LOAD_SMOOTHING = 0.1;
+// Longest wait for a level that keeps overloading, as a multiple of recover_frames.
+constexpr std::size_t MAX_RECOVER_BACKOFF = 64;
+
+struct QualityLevel {
+    GLfloat perception_scale;
+    // Zero keeps the configured interaction.
+    std::size_t neighbor_limit;
+    // Of the configured full-rate distance, with multi-rate updates forced on;
+    // zero keeps multi-rate as configured.
+    GLfloat full_rate_distance_scale;
+    std::size_t sim_sub_rate;
+};
+
+// Cheapest measures first: multi-rate updates only lose precision far away,
+// limiting neighbors changes how boids flock, and a lower step rate is visible
+// everywhere.
+constexpr QualityLevel LEVELS[] = {
+    {1.0f, 0, 0.0f, 1},
+    {1.0f, 0, 1.0f, 1},
+    {1.0f, 0, 0.5f, 1},
+    {1.0f, 16, 0.5f, 1},
+    {0.75f, 8, 0.5f, 1},
+    {0.5f, 4, 0.25f, 1},
+    {0.5f, 4, 0.25f, 2},
+    {0.5f, 4, 0.25f, 4},
+};
+
+QualityController::QualityController(QualityControllerConfig config, InteractionConfig const &interaction, MultiRateConfig const &multi_rate):
+    config_(config),
+    base_interaction_(interaction),
+    base_multi_rate_(multi_rate),
+    recover_frames_(std::size(LEVELS), config.recover_frames),
+    restored_at_(std::size(LEVELS), 0)
+{
+    knobs_ = {.interaction = interaction, .multi_rate = multi_rate, .sim_sub_rate = 1};
+}
+
+bool QualityController::update(double sim_ms, double render_ms) {
+    TRACE_SCOPE("quality_update", "render");
+    ++frame_;
+    // The simulation runs beside the renderer, with sim_sub_rate frames per step.
+    auto target = config_.target_frame_ms;
+    auto frame_load = std::max(sim_ms / (target * static_cast<double>(knobs_.sim_sub_rate)), render_ms / target);
+    load_ = (frame_ == 1) ? frame_load : load_ + LOAD_SMOOTHING * (frame_load - load_);
+
+    if (settle_ > 0) {
+        --settle_;
+        return false;
+    }
+    if (load_ > 1) {
+        ++frames_over_;
+        frames_under_ = 0;
+    } else if (load_ < config_.recover_fraction) {
+        ++frames_under_;
+        frames_over_ = 0;
+    } else {
+        frames_over_ = 0;
+        frames_under_ = 0;
+    }
+
+    if (frames_over_ >= config_.degrade_frames && level_ + 1 < std::size(LEVELS)) {
+        auto restored_at = restored_at_[level_];
+        if (restored_at != 0 && frame_ - restored_at < 2 * recover_frames_[level_]) {
+            recover_frames_[level_] = std::min(2 * recover_frames_[level_], MAX_RECOVER_BACKOFF * config_.recover_frames);
+        }
+        set_level(level_ + 1);
+        return true;
+    }
+    if (level_ > 0 && frames_under_ >= recover_frames_[level_ - 1]) {
+        set_level(level_ - 1);
+        restored_at_[level_] = frame_;
+        return true;
+    }
+    return false;
+}
+
+void QualityController::set_level(std::size_t level) {
+    auto const &settings = LEVELS[level];
+    level_ = level;
+
+    knobs_.interaction = base_interaction_;
+    knobs_.interaction.perception_radius = base_interaction_.perception_radius * settings.perception_scale;
+    if (settings.neighbor_limit != 0) {
+        auto configured = (base_interaction_.mode == InteractionMode::Knn) ? base_interaction_.neighbor_count : settings.neighbor_limit;
+        knobs_.interaction.mode = InteractionMode::Knn;
+        knobs_.interaction.neighbor_count = std::min(settings.neighbor_limit, configured);
+    }
+    knobs_.multi_rate = base_multi_rate_;
+    if (settings.full_rate_distance_scale != 0) {
+        knobs_.multi_rate.enabled = true;
+        knobs_.multi_rate.full_rate_distance = base_multi_rate_.full_rate_distance * settings.full_rate_distance_scale;
+    }
+    knobs_.sim_sub_rate = settings.sim_sub_rate;
+
+    settle_ = config_.settle_frames;
+    frames_over_ = 0;
+    frames_under_ = 0;
+}
+
+std::size_t QualityController::level() const noexcept {
+    return level_;
+}
+
+std::size_t QualityController::level_count() const noexcept {
+    return std::size(LEVELS);
+}
+
+QualityKnobs const &QualityController::knobs() const noexcept {
+    return knobs_;
+}
+
+double QualityController::load() const noexcept {
+    return load_;
+}
+
+void QualityController::export_metrics() {
+    // Unlimited settings are reported as zero.
+    auto perception_radius = std::isfinite(knobs_.interaction.perception_radius) ? static_cast<double>(knobs_.interaction.perception_radius) : 0.0;
+    auto neighbor_limit = (knobs_.interaction.mode == InteractionMode::Knn) ? knobs_.interaction.neighbor_count : 0;
+    auto full_rate_distance = knobs_.multi_rate.enabled ? static_cast<double>(knobs_.multi_rate.full_rate_distance) : 0.0;
+
+    TRACE_COUNTER("quality_level", static_cast<double>(level_));
+    TRACE_COUNTER("quality_load", load_);
+    TRACE_COUNTER("quality_perception_radius", perception_radius);
+    TRACE_COUNTER("quality_neighbor_limit", static_cast<double>(neighbor_limit));
+    TRACE_COUNTER("quality_full_rate_distance", full_rate_distance);
+    TRACE_COUNTER("quality_sim_sub_rate", static_cast<double>(knobs_.sim_sub_rate));
+
+    if (logged_level_ == level_) {
+        return;
+    }
+    logged_level_ = level_;
+    SDL_Log("Quality level %zu/%zu at %.0f%% of the frame budget: perception radius %g, neighbor limit %zu, "
+            "full-rate distance %g, one step per %zu frames",
+            level_, std::size(LEVELS) - 1, 100.0 * load_,
+            perception_radius, neighbor_limit, full_rate_distance, knobs_.sim_sub_rate);
+}
@@ -0,0 +1,83 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_QUALITY_CONTROLLER_HPP
+#define SDL_GLEW_TEST_QUALITY_CONTROLLER_HPP
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "interaction.hpp"
+#include "simulation.hpp"
+
+// Settings traded for speed when frames run over budget.
+struct QualityKnobs {
+    // How boids find neighbors: the perception radius and, once neighbors are
+    // limited, topological interaction with that many neighbors.
+    InteractionConfig interaction;
+    // Distances beyond which boids are updated less often.
+    MultiRateConfig multi_rate;
+    // The simulation steps once every this many ticks.
+    std::size_t sim_sub_rate = 1;
+};
+
+struct QualityControllerConfig {
+    double target_frame_ms = 1000.0 / 60;
+    // Quality drops after the smoothed load stays above the target for
+    // degrade_frames, and rises again only after it stays below
+    // recover_fraction of the target for recover_frames.
+    double recover_fraction = 0.7;
+    std::size_t degrade_frames = 10;
+    std::size_t recover_frames = 120;
+    // Frames ignored after a change, while its effect shows up in the timings.
+    std::size_t settle_frames = 30;
+};
+
+// Keeps frames within a time budget by stepping down a ladder of quality
+// levels, from the scenario's own settings through multi-rate updates with
+// shrinking full-rate distance, fewer neighbors within a smaller radius, to
+// simulating at a half and a quarter of the tick rate. Measured times are
+// smoothed and compared with the budget with hysteresis, so that noise does not
+// make the level flap; a level that had to be left again soon after being
+// restored waits twice as long before the next attempt.
+class QualityController {
+public:
+    QualityController(QualityControllerConfig config, InteractionConfig const &interaction, MultiRateConfig const &multi_rate);
+
+    // Takes one rendered frame's render time and the latest simulation step time,
+    // and returns whether the level changed.
+    bool update(double sim_ms, double render_ms);
+
+    [[nodiscard]] std::size_t level() const noexcept;
+    [[nodiscard]] std::size_t level_count() const noexcept;
+    [[nodiscard]] QualityKnobs const &knobs() const noexcept;
+    // Smoothed frame cost as a fraction of the budget.
+    [[nodiscard]] double load() const noexcept;
+    // Reports the level and knob values as trace counters, and logs them
+    // whenever the level has changed since the last call (zero meaning
+    // unlimited or off).
+    void export_metrics();
+
+private:
+    void set_level(std::size_t level);
+
+    QualityControllerConfig config_;
+    InteractionConfig base_interaction_;
+    MultiRateConfig base_multi_rate_;
+
+    std::size_t level_ = 0;
+    QualityKnobs knobs_;
+    double load_ = 0;
+    std::size_t frames_over_ = 0;
+    std::size_t frames_under_ = 0;
+    std::size_t settle_ = 0;
+    std::size_t frame_ = 0;
+    std::optional<std::size_t> logged_level_;
+    // Per level: frames under budget needed to return to it, and when it was last restored.
+    std::vector<std::size_t> recover_frames_;
+    std::vector<std::size_t> restored_at_;
+};
+
+#endif //SDL_GLEW_TEST_QUALITY_CONTROLLER_HPP
@@ -0,0 +1,289 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "replay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "SDL_log.h"
+
+#include "flock_codec.hpp"
+#include "trace.hpp"
+
+constexpr char REPLAY_MAGIC[4] = {'B', 'R', 'E', 'C'};
+constexpr std::uint32_t REPLAY_VERSION = 2;
+constexpr std::uint32_t KEYFRAME_FLAG = 1;
+
+struct ReplayHeader {
+    char magic[4];
+    std::uint32_t version;
+    float mindset[5];
+    float bounds_min[3];
+    float bounds_max[3];
+};
+
+struct ReplayFrameHeader {
+    std::uint64_t step;
+    std::uint32_t boid_count;
+    std::uint32_t flags;
+    std::uint64_t payload_bytes;
+};
+
+static void zero_state(ReplayState &state, std::size_t count) {
+    state.resize(count);
+    for (int i = 0; i < 3; ++i) {
+        std::fill(state.pos[i].begin(), state.pos[i].end(), std::uint16_t{0});
+        std::fill(state.velocity[i].begin(), state.velocity[i].end(), std::int16_t{0});
+    }
+}
+
+void ReplayState::resize(std::size_t count) {
+    for (int i = 0; i < 3; ++i) {
+        pos[i].resize(count);
+        velocity[i].resize(count);
+    }
+}
+
+std::size_t ReplayState::size() const noexcept {
+    return pos[0].size();
+}
+
+ReplayRecorder::ReplayRecorder(char const *path, Boid::Mindset mindset, WorldBounds bounds, std::size_t buffered_frames):
+    mindset_(mindset),
+    bounds_(bounds),
+    frames_since_keyframe_(KEYFRAME_INTERVAL),
+    free_(std::max<std::size_t>(buffered_frames, 1))
+{
+    if (fopen_s(&file_, path, "wb") != 0) {
+        throw std::runtime_error(std::format("Could not open replay '{}' for writing", path));
+    }
+    ReplayHeader header = {};
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header.version = REPLAY_VERSION;
+    float mindset_values[5] = {mindset.obstacle_avoiding_bias, mindset.centering_bias, mindset.conforming_bias, mindset.maximum_movement,
+                               mindset.geometry_avoiding_bias};
+    std::memcpy(header.mindset, mindset_values, sizeof(mindset_values));
+    for (int i = 0; i < 3; ++i) {
+        header.bounds_min[i] = bounds.min[i];
+        header.bounds_max[i] = bounds.max[i];
+    }
+    if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+        fclose(file_);
+        throw std::runtime_error(std::format("Error writing replay '{}'", path));
+    }
+    writer_ = std::jthread([this](std::stop_token stop) { writer_loop(std::move(stop)); });
+}
+
+ReplayRecorder::~ReplayRecorder() noexcept {
+    writer_.request_stop();
+    writer_.join();
+    fclose(file_);
+}
+
+void ReplayRecorder::record(std::uint64_t step, std::span<Boid const> boids, std::span<std::uint32_t const> ids) {
+    TRACE_SCOPE("record_frame", "sim");
+    std::unique_lock lock(mutex_);
+    if (free_.empty()) {
+        ++dropped_;
+        dropped_since_last_ = true;
+        return;
+    }
+    auto frame = std::move(free_.back());
+    free_.pop_back();
+    frame.follows_drop = std::exchange(dropped_since_last_, false);
+    lock.unlock();
+
+    frame.step = step;
+    frame.boids.assign(boids.begin(), boids.end());
+    frame.ids.assign(ids.begin(), ids.end());
+
+    lock.lock();
+    queued_.push_back(std::move(frame));
+    ++recorded_;
+    lock.unlock();
+    frames_queued_.notify_one();
+}
+
+std::uint64_t ReplayRecorder::recorded_frames() const noexcept {
+    std::scoped_lock lock(mutex_);
+    return recorded_;
+}
+
+std::uint64_t ReplayRecorder::dropped_frames() const noexcept {
+    std::scoped_lock lock(mutex_);
+    return dropped_;
+}
+
+void ReplayRecorder::writer_loop(std::stop_token stop) {
+    TRACE_THREAD_NAME("replay_writer");
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock lock(mutex_);
+            // Once stopped, keeps going until the queue is drained.
+            frames_queued_.wait(lock, stop, [this] { return !queued_.empty(); });
+            if (queued_.empty()) {
+                return;
+            }
+            frame = std::move(queued_.front());
+            queued_.pop_front();
+        }
+        write_frame(frame);
+        std::scoped_lock lock(mutex_);
+        free_.push_back(std::move(frame));
+    }
+}
+
+void ReplayRecorder::write_frame(Frame const &frame) {
+    TRACE_SCOPE("encode_frame", "replay");
+    if (failed_) {
+        return;
+    }
+    FlockQuantizer quantizer(mindset_, bounds_);
+    auto count = frame.boids.size();
+    current_.resize(count);
+    for (std::size_t slot = 0; slot < count; ++slot) {
+        auto id = frame.ids[slot];
+        auto const &boid = frame.boids[slot];
+        for (int i = 0; i < 3; ++i) {
+            current_.pos[i][id] = quantizer.pos(boid.pos[i], i);
+            current_.velocity[i][id] = quantizer.velocity(boid.velocity[i]);
+        }
+    }
+
+    bool keyframe = frame.follows_drop || count != previous_.size() || frames_since_keyframe_ >= KEYFRAME_INTERVAL;
+    if (keyframe) {
+        zero_state(previous_, count);
+        frames_since_keyframe_ = 0;
+    }
+    ++frames_since_keyframe_;
+
+    payload_.clear();
+    for (std::size_t id = 0; id < count; ++id) {
+        for (int i = 0; i < 3; ++i) {
+            auto predicted = quantizer.predict(previous_.pos[i][id], previous_.velocity[i][id], i);
+            write_varint(payload_, zigzag(current_.velocity[i][id] - previous_.velocity[i][id]));
+            write_varint(payload_, zigzag(static_cast<std::int16_t>(current_.pos[i][id] - predicted)));
+        }
+    }
+    std::swap(previous_, current_);
+
+    ReplayFrameHeader header = {
+        .step = frame.step,
+        .boid_count = static_cast<std::uint32_t>(count),
+        .flags = keyframe ? KEYFRAME_FLAG : 0,
+        .payload_bytes = payload_.size(),
+    };
+    if (fwrite(&header, sizeof(header), 1, file_) != 1 || fwrite(payload_.data(), 1, payload_.size(), file_) != payload_.size()) {
+        SDL_Log("Error writing replay frame of step %llu; recording stopped", static_cast<unsigned long long>(frame.step));
+        failed_ = true;
+    }
+}
+
+ReplayPlayer::ReplayPlayer(char const *path):
+    file_(path)
+{
+    auto bytes = file_.bytes();
+    ReplayHeader header;
+    if (bytes.size() < sizeof(header)) {
+        throw std::runtime_error(std::format("Replay '{}' is truncated", path));
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) != 0) {
+        throw std::runtime_error(std::format("'{}' is not a replay", path));
+    }
+    if (header.version != REPLAY_VERSION) {
+        throw std::runtime_error(std::format("Replay '{}' has unsupported version {}", path, header.version));
+    }
+    mindset_ = {
+        .obstacle_avoiding_bias = header.mindset[0],
+        .centering_bias = header.mindset[1],
+        .conforming_bias = header.mindset[2],
+        .maximum_movement = header.mindset[3],
+        .geometry_avoiding_bias = header.mindset[4],
+    };
+    bounds_ = {
+        .min = {{header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]}},
+        .max = {{header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]}},
+    };
+    first_frame_offset_ = sizeof(header);
+    offset_ = first_frame_offset_;
+}
+
+Boid::Mindset ReplayPlayer::mindset() const noexcept {
+    return mindset_;
+}
+
+WorldBounds const &ReplayPlayer::bounds() const noexcept {
+    return bounds_;
+}
+
+bool ReplayPlayer::next_frame() {
+    TRACE_SCOPE("decode_frame", "replay");
+    auto bytes = file_.bytes();
+    ReplayFrameHeader header;
+    if (bytes.size() - offset_ < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, bytes.data() + offset_, sizeof(header));
+    if (bytes.size() - offset_ - sizeof(header) < header.payload_bytes) {
+        return false;
+    }
+    auto count = static_cast<std::size_t>(header.boid_count);
+    if (header.flags & KEYFRAME_FLAG) {
+        zero_state(state_, count);
+    } else if (count != state_.size()) {
+        throw std::runtime_error("Replay frame does not follow the previous one");
+    }
+
+    FlockQuantizer quantizer(mindset_, bounds_);
+    auto const *p = reinterpret_cast<std::uint8_t const *>(bytes.data() + offset_ + sizeof(header));
+    auto const *end = p + header.payload_bytes;
+    for (std::size_t id = 0; id < count; ++id) {
+        for (int i = 0; i < 3; ++i) {
+            auto predicted = quantizer.predict(state_.pos[i][id], state_.velocity[i][id], i);
+            std::uint32_t velocity_residual, pos_residual;
+            p = read_varint(p, end, velocity_residual);
+            p = read_varint(p, end, pos_residual);
+            state_.velocity[i][id] = static_cast<std::int16_t>(state_.velocity[i][id] + unzigzag(velocity_residual));
+            state_.pos[i][id] = static_cast<std::uint16_t>(predicted + unzigzag(pos_residual));
+        }
+    }
+    offset_ += sizeof(header) + header.payload_bytes;
+    step_ = header.step;
+
+    boids_.resize(count);
+    for (std::size_t id = 0; id < count; ++id) {
+        for (int i = 0; i < 3; ++i) {
+            boids_[id].pos[i] = quantizer.unpack_pos(state_.pos[i][id], i);
+            boids_[id].velocity[i] = quantizer.unpack_velocity(state_.velocity[i][id]);
+        }
+    }
+    if (ids_.size() != count) {
+        ids_.resize(count);
+        std::iota(ids_.begin(), ids_.end(), std::uint32_t{0});
+    }
+    return true;
+}
+
+void ReplayPlayer::rewind() noexcept {
+    offset_ = first_frame_offset_;
+}
+
+std::uint64_t ReplayPlayer::step() const noexcept {
+    return step_;
+}
+
+std::span<Boid const> ReplayPlayer::boids() const noexcept {
+    return boids_;
+}
+
+std::span<std::uint32_t const> ReplayPlayer::ids() const noexcept {
+    return ids_;
+}
@@ -0,0 +1,123 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_REPLAY_HPP
+#define SDL_GLEW_TEST_REPLAY_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+#include "mapped_file.hpp"
+#include "simulation.hpp"
+
+// Flock state quantized by FlockQuantizer, in stable id order: the unit that
+// replays are coded in.
+struct ReplayState {
+    std::vector<std::uint16_t> pos[3];
+    std::vector<std::int16_t> velocity[3];
+
+    void resize(std::size_t count);
+    [[nodiscard]] std::size_t size() const noexcept;
+};
+
+// Streams a simulation to a file. record() only copies the flock into one of a
+// fixed number of buffers; a background thread quantizes each frame, predicts
+// every position from the previous position and velocity, and writes the
+// prediction residuals as variable-length integers. Every KEYFRAME_INTERVAL
+// frames, and whenever the flock was resized or a frame was dropped, the frame
+// is coded against a zero state instead, so a replay can start there.
+class ReplayRecorder {
+public:
+    static constexpr std::size_t KEYFRAME_INTERVAL = 60;
+
+    ReplayRecorder(char const *path, Boid::Mindset mindset, WorldBounds bounds, std::size_t buffered_frames = 4);
+    // Writes every frame still buffered.
+    ~ReplayRecorder() noexcept;
+
+    ReplayRecorder(ReplayRecorder const &other) = delete;
+    ReplayRecorder(ReplayRecorder &&other) = delete;
+    ReplayRecorder &operator=(ReplayRecorder const &other) = delete;
+    ReplayRecorder &operator=(ReplayRecorder &&other) = delete;
+
+    // Never waits for the writer: with every buffer still queued, the frame is dropped.
+    void record(std::uint64_t step, std::span<Boid const> boids, std::span<std::uint32_t const> ids);
+
+    [[nodiscard]] std::uint64_t recorded_frames() const noexcept;
+    [[nodiscard]] std::uint64_t dropped_frames() const noexcept;
+
+private:
+    struct Frame {
+        std::uint64_t step;
+        bool follows_drop;
+        std::vector<Boid> boids;
+        std::vector<std::uint32_t> ids;
+    };
+
+    void writer_loop(std::stop_token stop);
+    void write_frame(Frame const &frame);
+
+    FILE *file_;
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+
+    // Writer thread only.
+    ReplayState previous_;
+    ReplayState current_;
+    std::vector<std::uint8_t> payload_;
+    std::size_t frames_since_keyframe_ = 0;
+    bool failed_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any frames_queued_;
+    std::vector<Frame> free_;
+    std::deque<Frame> queued_;
+    bool dropped_since_last_ = false;
+    std::uint64_t recorded_ = 0;
+    std::uint64_t dropped_ = 0;
+
+    std::jthread writer_;
+};
+
+// Decodes a recording frame by frame, straight from a memory map. A recording
+// cut short, e.g. by a crash, plays up to its last complete frame.
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(char const *path);
+
+    [[nodiscard]] Boid::Mindset mindset() const noexcept;
+    [[nodiscard]] WorldBounds const &bounds() const noexcept;
+
+    // Returns false, leaving the current frame as it is, at the end of the recording.
+    bool next_frame();
+    // Goes back to the first frame; the next call to next_frame() decodes it.
+    void rewind() noexcept;
+
+    [[nodiscard]] std::uint64_t step() const noexcept;
+    // The boids of the current frame in id order.
+    [[nodiscard]] std::span<Boid const> boids() const noexcept;
+    [[nodiscard]] std::span<std::uint32_t const> ids() const noexcept;
+
+private:
+    MappedFile file_;
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    std::size_t first_frame_offset_;
+    std::size_t offset_;
+
+    std::uint64_t step_ = 0;
+    ReplayState state_;
+    std::vector<Boid> boids_;
+    std::vector<std::uint32_t> ids_;
+};
+
+#endif //SDL_GLEW_TEST_REPLAY_HPP
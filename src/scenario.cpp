@@ -0,0 +1,421 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "scenario.hpp"
+
+#include <charconv>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "snapshot.hpp"
+#include "obj_format.hpp"
+#include "trace.hpp"
+
+static std::string_view trim(std::string_view s) noexcept {
+    auto first = s.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    auto last = s.find_last_not_of(" \t\r");
+    return s.substr(first, last - first + 1);
+}
+
+template<typename T>
+static T parse_number(std::string_view key, std::string_view value) {
+    value = trim(value);
+    T ret;
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), ret);
+    if (ec != std::errc() || end != value.data() + value.size()) {
+        throw std::runtime_error(std::format("Scenario: invalid value '{}' for {}", value, key));
+    }
+    return ret;
+}
+
+static bool parse_bool(std::string_view key, std::string_view value) {
+    if (value == "true" || value == "1") {
+        return true;
+    } else if (value == "false" || value == "0") {
+        return false;
+    }
+    throw std::runtime_error(std::format("Scenario: {} expects true or false, got '{}'", key, value));
+}
+
+static Vec3<GLfloat> parse_vec3(std::string_view key, std::string_view value) {
+    Vec3<GLfloat> ret;
+    for (int i = 0; i < 3; ++i) {
+        auto comma = value.find(',');
+        if ((i < 2) == (comma == std::string_view::npos)) {
+            throw std::runtime_error(std::format("Scenario: {} expects three comma-separated values", key));
+        }
+        ret[i] = parse_number<GLfloat>(key, value.substr(0, comma));
+        value = (comma == std::string_view::npos) ? std::string_view{} : value.substr(comma + 1);
+    }
+    return ret;
+}
+
+Scenario Scenario::from_command_line(int argc, char *argv[]) {
+    std::vector<std::pair<std::string, std::string_view>> flags;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (!arg.starts_with("--") || i + 1 >= argc) {
+            throw std::runtime_error(std::format("Expected '--key value' arguments, got '{}'", arg));
+        }
+        std::string key(arg.substr(2));
+        for (auto &c : key) {
+            if (c == '-') {
+                c = '_';
+            }
+        }
+        flags.emplace_back(std::move(key), argv[++i]);
+    }
+
+    Scenario ret;
+    ret.command_line.assign(argv, argv + argc);
+    for (auto const &[key, value] : flags) {
+        if (key == "scenario") {
+            ret.load_file(std::string(value).c_str());
+        }
+    }
+    for (auto const &[key, value] : flags) {
+        if (key != "scenario") {
+            ret.set(key, value);
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (ret.bounds.min[i] >= ret.bounds.max[i]) {
+            throw std::runtime_error("Scenario: bounds_min must be below bounds_max on every axis");
+        }
+    }
+    if (ret.first_frame != 0 && (!ret.headless || !ret.stream_connect.empty())) {
+        throw std::runtime_error("Scenario: first_frame only applies to headless runs of a simulation or replay");
+    }
+    // Headless runs step their simulation on the render thread, one frame at a time.
+    if (ret.headless && (!ret.record.empty() || !ret.shared_memory.empty() || ret.stream_port != 0 || ret.frame_budget_ms > 0)) {
+        throw std::runtime_error("Scenario: headless runs cannot record, publish, serve or budget their simulation");
+    }
+    // Only Simulation steers boids around obstacle geometry.
+    if (!ret.obstacle_meshes.empty() && (ret.domain_count > 1 || ret.domain_scaling || !ret.out_of_core.empty() || ret.gpu)) {
+        throw std::runtime_error("Scenario: obstacles are not supported with domains, out_of_core or gpu");
+    }
+    ret.load_obstacles();
+    return ret;
+}
+
+void Scenario::load_obstacles() {
+    obstacle_objs.clear();
+    if (obstacle_meshes.empty()) {
+        obstacles.bvh.reset();
+        return;
+    }
+    TRACE_SCOPE("load_obstacles", "load");
+    std::vector<ObstacleBvh::Triangle> triangles;
+    for (auto const &path : obstacle_meshes) {
+        auto const &obj = obstacle_objs.emplace_back(std::make_shared<ObjFormat const>(path.c_str()));
+        append_obstacle_triangles(triangles, *obj, obstacle_placement);
+    }
+    obstacles.bvh = std::make_shared<ObstacleBvh const>(triangles);
+}
+
+void Scenario::load_file(char const *path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open scenario file {}", path));
+    }
+    std::string line;
+    for (int line_number = 1; std::getline(file, line); ++line_number) {
+        std::string_view text = line;
+        text = trim(text.substr(0, text.find('#')));
+        if (text.empty()) {
+            continue;
+        }
+        auto equals = text.find('=');
+        if (equals == std::string_view::npos) {
+            throw std::runtime_error(std::format("{}:{}: expected 'key = value'", path, line_number));
+        }
+        set(trim(text.substr(0, equals)), trim(text.substr(equals + 1)));
+    }
+}
+
+void Scenario::set(std::string_view key, std::string_view value) {
+    if (key == "boids") {
+        boid_count = parse_number<std::size_t>(key, value);
+    } else if (key == "layout") {
+        if (value == "lattice") {
+            layout = SpawnLayout::Lattice;
+        } else if (value == "random") {
+            layout = SpawnLayout::Random;
+        } else {
+            throw std::runtime_error(std::format("Scenario: unknown layout '{}'", value));
+        }
+    } else if (key == "seed") {
+        seed = parse_number<std::uint32_t>(key, value);
+    } else if (key == "bounds_min") {
+        bounds.min = parse_vec3(key, value);
+    } else if (key == "bounds_max") {
+        bounds.max = parse_vec3(key, value);
+    } else if (key == "obstacle_avoiding_bias") {
+        mindset.obstacle_avoiding_bias = parse_number<GLfloat>(key, value);
+    } else if (key == "centering_bias") {
+        mindset.centering_bias = parse_number<GLfloat>(key, value);
+    } else if (key == "conforming_bias") {
+        mindset.conforming_bias = parse_number<GLfloat>(key, value);
+    } else if (key == "maximum_movement") {
+        mindset.maximum_movement = parse_number<GLfloat>(key, value);
+    } else if (key == "geometry_avoiding_bias") {
+        mindset.geometry_avoiding_bias = parse_number<GLfloat>(key, value);
+    } else if (key == "interaction") {
+        if (value == "all_pairs") {
+            interaction.mode = InteractionMode::AllPairs;
+        } else if (value == "verlet") {
+            interaction.mode = InteractionMode::Verlet;
+        } else if (value == "knn") {
+            interaction.mode = InteractionMode::Knn;
+        } else if (value == "auto") {
+            interaction.mode = InteractionMode::Auto;
+        } else {
+            throw std::runtime_error(std::format("Scenario: unknown interaction '{}'", value));
+        }
+    } else if (key == "perception_radius") {
+        interaction.perception_radius = parse_number<GLfloat>(key, value);
+    } else if (key == "verlet_skin") {
+        interaction.verlet_skin = parse_number<GLfloat>(key, value);
+    } else if (key == "neighbors") {
+        interaction.neighbor_count = parse_number<std::size_t>(key, value);
+    } else if (key == "threads") {
+        thread_count = parse_number<std::size_t>(key, value);
+    } else if (key == "reorder_interval") {
+        reorder_interval = parse_number<std::size_t>(key, value);
+    } else if (key == "deterministic") {
+        deterministic = parse_bool(key, value);
+    } else if (key == "huge_pages") {
+        if (value == "off") {
+            memory.page_policy = PagePolicy::Default;
+        } else if (value == "transparent") {
+            memory.page_policy = PagePolicy::TransparentHuge;
+        } else if (value == "explicit") {
+            memory.page_policy = PagePolicy::ExplicitHuge;
+        } else {
+            throw std::runtime_error(std::format("Scenario: unknown huge_pages setting '{}'", value));
+        }
+    } else if (key == "numa_first_touch") {
+        memory.numa_first_touch = parse_bool(key, value);
+    } else if (key == "pin_threads") {
+        memory.pin_threads = parse_bool(key, value);
+    } else if (key == "multi_rate") {
+        multi_rate.enabled = parse_bool(key, value);
+    } else if (key == "camera") {
+        multi_rate.camera = parse_vec3(key, value);
+        camera_set = true;
+    } else if (key == "multi_rate_distance") {
+        multi_rate.full_rate_distance = parse_number<GLfloat>(key, value);
+    } else if (key == "multi_rate_density") {
+        multi_rate.dense_inv_dist_sq = parse_number<GLfloat>(key, value);
+    } else if (key == "obstacles") {
+        obstacle_meshes.clear();
+        while (!value.empty()) {
+            auto comma = value.find(',');
+            obstacle_meshes.emplace_back(trim(value.substr(0, comma)));
+            value = (comma == std::string_view::npos) ? std::string_view{} : value.substr(comma + 1);
+        }
+    } else if (key == "obstacle_offset") {
+        obstacle_placement.offset = parse_vec3(key, value);
+    } else if (key == "obstacle_scale") {
+        obstacle_placement.scale = parse_number<GLfloat>(key, value);
+    } else if (key == "obstacle_look_ahead") {
+        obstacles.look_ahead = parse_number<GLfloat>(key, value);
+    } else if (key == "obstacle_clearance") {
+        obstacles.clearance = parse_number<GLfloat>(key, value);
+    } else if (key == "gpu") {
+        gpu = parse_bool(key, value);
+    } else if (key == "gpu_validate_interval") {
+        gpu_validate_interval = parse_number<std::size_t>(key, value);
+    } else if (key == "headless") {
+        headless = parse_bool(key, value);
+    } else if (key == "frames") {
+        frames = parse_number<std::size_t>(key, value);
+    } else if (key == "frame_width") {
+        frame_width = parse_number<GLsizei>(key, value);
+    } else if (key == "frame_height") {
+        frame_height = parse_number<GLsizei>(key, value);
+    } else if (key == "frame_output") {
+        frame_output = value;
+    } else if (key == "first_frame") {
+        first_frame = parse_number<std::size_t>(key, value);
+    } else if (key == "frame_budget_ms") {
+        frame_budget_ms = parse_number<double>(key, value);
+    } else if (key == "benchmark_steps") {
+        benchmark_steps = parse_number<std::size_t>(key, value);
+    } else if (key == "snapshot") {
+        snapshot = value;
+        Snapshot file(snapshot.c_str());
+        layout = SpawnLayout::Snapshot;
+        boid_count = file.boid_count();
+        mindset = file.mindset();
+        bounds = file.bounds();
+    } else if (key == "record") {
+        record = value;
+    } else if (key == "replay") {
+        replay = value;
+    } else if (key == "replay_speed") {
+        replay_speed = parse_number<std::size_t>(key, value);
+    } else if (key == "out_of_core") {
+        out_of_core = value;
+    } else if (key == "shared_memory") {
+        shared_memory = value;
+    } else if (key == "shared_memory_capacity") {
+        shared_memory_capacity = parse_number<std::size_t>(key, value);
+    } else if (key == "stream_port") {
+        stream_port = parse_number<std::uint16_t>(key, value);
+    } else if (key == "stream_bandwidth") {
+        stream_bandwidth = parse_number<double>(key, value);
+    } else if (key == "stream_connect") {
+        stream_connect = value;
+    } else if (key == "stream_view_min") {
+        stream_view_min = parse_vec3(key, value);
+    } else if (key == "stream_view_max") {
+        stream_view_max = parse_vec3(key, value);
+    } else if (key == "domains") {
+        domain_count = parse_number<std::size_t>(key, value);
+    } else if (key == "domain_rank") {
+        domain_rank = parse_number<std::size_t>(key, value);
+    } else if (key == "domain_transport") {
+        if (value == "tcp") {
+            domain_transport = DomainTransportMode::Tcp;
+        } else if (value == "shared_memory") {
+            domain_transport = DomainTransportMode::SharedMemory;
+        } else {
+            throw std::runtime_error(std::format("Scenario: unknown domain_transport '{}'", value));
+        }
+    } else if (key == "domain_hosts") {
+        domain_hosts.clear();
+        while (!value.empty()) {
+            auto comma = value.find(',');
+            domain_hosts.emplace_back(trim(value.substr(0, comma)));
+            value = (comma == std::string_view::npos) ? std::string_view{} : value.substr(comma + 1);
+        }
+    } else if (key == "domain_port") {
+        domain_port = parse_number<std::uint16_t>(key, value);
+    } else if (key == "domain_name") {
+        domain_name = value;
+    } else if (key == "domain_scaling") {
+        domain_scaling = parse_bool(key, value);
+    } else {
+        throw std::runtime_error(std::format("Scenario: unknown key '{}'", key));
+    }
+}
+
+// Boid `i` of the initial flock. Random layouts draw from `rng`, so boids must be
+// spawned in order.
+static Boid spawn_boid(Scenario const &scenario, std::size_t i, std::minstd_rand &rng, Snapshot const *saved) {
+    switch (scenario.layout) {
+        case SpawnLayout::Lattice: {
+            auto n = static_cast<int>(i);
+            return {
+                .pos = {{
+                    static_cast<GLfloat>(n%5) * 10.0f,
+                    static_cast<GLfloat>(n/5%5) * 10.0f,
+                    static_cast<GLfloat>(-n%25) * 10.0f - 150.0f
+                }},
+                .velocity = {{0, 0, 0}},
+            };
+        }
+        case SpawnLayout::Snapshot: {
+            if (i < saved->boid_count()) {
+                return saved->boid(i);
+            }
+            // Boids beyond the snapshot's flock start at rest at random points.
+            break;
+        }
+        case SpawnLayout::Random: {
+            break;
+        }
+    }
+    return {.pos = scenario.bounds.random_point(rng), .velocity = {{0, 0, 0}}};
+}
+
+std::vector<Boid> Scenario::spawn_boids() const {
+    std::optional<Snapshot> saved;
+    if (layout == SpawnLayout::Snapshot) {
+        saved.emplace(snapshot.c_str());
+    }
+    std::minstd_rand rng(seed);
+    std::vector<Boid> ret(boid_count);
+    for (std::size_t i = 0; i < boid_count; ++i) {
+        ret[i] = spawn_boid(*this, i, rng, saved ? &*saved : nullptr);
+    }
+    return ret;
+}
+
+Simulation Scenario::create_simulation() const {
+    Simulation ret(spawn_boids(), mindset, bounds, seed);
+    ret.set_interaction(make_interaction_backend(interaction, bounds));
+    ret.set_thread_count(thread_count);
+    ret.set_memory_config(memory);
+    ret.set_reorder_interval(reorder_interval);
+    ret.set_deterministic(deterministic);
+    ret.set_multi_rate(multi_rate);
+    ret.set_obstacles(obstacles);
+    return ret;
+}
+
+std::unique_ptr<OutOfCoreSimulation> Scenario::create_out_of_core_simulation() const {
+    std::optional<Snapshot> saved;
+    if (layout == SpawnLayout::Snapshot) {
+        saved.emplace(snapshot.c_str());
+    }
+    std::minstd_rand rng(seed);
+    return std::make_unique<OutOfCoreSimulation>(
+        out_of_core,
+        boid_count,
+        [&](std::uint64_t id) { return spawn_boid(*this, id, rng, saved ? &*saved : nullptr); },
+        mindset,
+        bounds,
+        interaction.perception_radius,
+        thread_count);
+}
+
+std::unique_ptr<DomainSimulation> Scenario::create_domain_simulation() const {
+    std::unique_ptr<DomainTransport> transport;
+    if (domain_count > 1) {
+        switch (domain_transport) {
+            case DomainTransportMode::Tcp: {
+                auto hosts = domain_hosts;
+                if (hosts.empty()) {
+                    hosts.assign(domain_count, "127.0.0.1");
+                } else if (hosts.size() != domain_count) {
+                    throw std::runtime_error(std::format("Scenario: domain_hosts lists {} hosts for {} domains", hosts.size(), domain_count));
+                }
+                transport = std::make_unique<TcpDomainTransport>(domain_rank, hosts, domain_port);
+                break;
+            }
+            case DomainTransportMode::SharedMemory: {
+                transport = std::make_unique<SharedMemoryDomainTransport>(domain_name, domain_rank, domain_count);
+                break;
+            }
+        }
+    }
+    if (boid_count > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error(std::format("Scenario: {} boids exceed the 32-bit ids of domains", boid_count));
+    }
+    std::optional<Snapshot> saved;
+    if (layout == SpawnLayout::Snapshot) {
+        saved.emplace(snapshot.c_str());
+    }
+    std::minstd_rand rng(seed);
+    return std::make_unique<DomainSimulation>(
+        static_cast<std::uint32_t>(boid_count),
+        [&](std::uint32_t id) { return spawn_boid(*this, id, rng, saved ? &*saved : nullptr); },
+        mindset,
+        bounds,
+        interaction,
+        domain_rank,
+        domain_count,
+        std::move(transport),
+        thread_count);
+}
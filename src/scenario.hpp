@@ -0,0 +1,186 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SCENARIO_HPP
+#define SDL_GLEW_TEST_SCENARIO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "boid.hpp"
+#include "simulation.hpp"
+#include "interaction.hpp"
+#include "out_of_core.hpp"
+#include "domain_simulation.hpp"
+#include "obstacle_bvh.hpp"
+
+enum class DomainTransportMode {
+    Tcp,
+    SharedMemory,
+};
+
+enum class SpawnLayout {
+    // Rows of five boids stepping back into the screen.
+    Lattice,
+    // Uniformly scattered inside the world bounds.
+    Random,
+    // As saved in a snapshot file.
+    Snapshot,
+};
+
+// Startup parameters of a run. Scenario files hold one `key = value` per line,
+// with `#` starting a comment; the same keys are accepted as `--key value` flags
+// (dashes and underscores are interchangeable). Vectors are written `x,y,z`.
+//
+//   boids                   flock size
+//   layout                  lattice | random
+//   seed                    random number seed
+//   bounds_min, bounds_max  corners of the world box
+//   obstacle_avoiding_bias, centering_bias, conforming_bias, maximum_movement, geometry_avoiding_bias
+//   interaction             all_pairs | verlet | knn | auto
+//   perception_radius       inf by default
+//   verlet_skin
+//   neighbors               neighbor count for knn
+//   threads                 simulation threads, 0 for one per hardware thread
+//   reorder_interval        steps between Morton reorders, 0 to never reorder
+//   deterministic           true to sum neighbors in stable id order
+//   huge_pages              off | transparent | explicit
+//   numa_first_touch        true to place each worker's block of boids on its node
+//   pin_threads             true to pin simulation threads to CPUs
+//   multi_rate              true to update boids far from the camera or from others less often
+//   camera                  camera position, for multi_rate
+//   multi_rate_distance     camera distance within which boids update every step
+//   multi_rate_density      inverse squared neighbor distance summed, below which boids count as sparse
+//   obstacles               obj files of static geometry for boids to avoid, comma-separated;
+//                           not supported with domains, out_of_core or gpu
+//   obstacle_offset, obstacle_scale  where the obstacle meshes go in the world
+//   obstacle_look_ahead     how far along their velocity boids look for obstacles
+//   obstacle_clearance      distance boids keep from obstacle surfaces
+//   gpu                     true to simulate on the GPU by transform feedback and draw from its
+//                           buffers; boids see all others within perception_radius
+//   gpu_validate_interval   frames between GPU steps checked against a CPU step, 0 for never
+//   headless                true to render into an offscreen framebuffer instead of a window and
+//                           write every frame to frame_output, then exit; needs a build with
+//                           BOIDS_ENABLE_HEADLESS
+//   frames                  frames to render headless
+//   frame_width, frame_height  size of headless frames in pixels
+//   frame_output            directory headless frames are written to, as frame_NNNNNN.ppm
+//   first_frame             number of the first headless frame; the simulation or replay starts
+//                           that many frames in, so that several machines can render parts of
+//                           one run. Frames match across machines with deterministic = true
+//   benchmark_steps         if non-zero, time this many steps without rendering and exit
+//   frame_budget_ms         if non-zero, lower simulation quality to keep frames within this time
+//   snapshot                start from a snapshot file, taking its flock size, mindset and bounds
+//   record                  stream every step to this replay file
+//   replay                  play this replay file instead of simulating
+//   replay_speed            replay frames, or headless simulation steps, per rendered frame
+//   out_of_core             keep the flock in files in this directory, for benchmark runs
+//   shared_memory           publish every step to this shared memory segment, e.g. /boids
+//   shared_memory_capacity  boids the segment holds, 0 for four times the initial flock
+//   stream_port             serve the flock to remote viewers on this TCP port, 0 for none
+//   stream_bandwidth        Mbit/s per remote viewer
+//   stream_connect          view a remote flock served at host:port instead of simulating
+//   stream_view_min, stream_view_max  box of boids to receive as a remote viewer
+//   domains                 split the world along x into this many processes, for benchmark runs
+//   domain_rank             which of them this process simulates
+//   domain_transport        tcp | shared_memory, between neighboring domains
+//   domain_hosts            host of each domain, comma-separated; when empty, domain 0 starts
+//                           the others on this machine, otherwise each is started by hand
+//   domain_port             TCP port of domain 0; domain i listens on domain_port + i
+//   domain_name             shared memory segment prefix, unique to the run
+//   domain_scaling          true to benchmark 1, 2, 4 and 8 local domains
+struct Scenario {
+    std::size_t boid_count = 100;
+    SpawnLayout layout = SpawnLayout::Lattice;
+    std::uint32_t seed = 1;
+
+    WorldBounds bounds = {
+        .min = {{-50*3, -40*3, -410}},
+        .max = {{50*3, 40*3, -10}},
+    };
+
+    Boid::Mindset mindset = {
+        .obstacle_avoiding_bias = 1.0/5,
+        .centering_bias = 1.0/60,
+        .conforming_bias = 1.0,
+        .maximum_movement = 2.0,
+    };
+
+    InteractionConfig interaction;
+    std::size_t thread_count = 0;
+    std::size_t reorder_interval = 100;
+    bool deterministic = false;
+    MemoryConfig memory;
+    MultiRateConfig multi_rate;
+    // Whether multi_rate.camera came from the scenario rather than the default.
+    bool camera_set = false;
+    std::vector<std::string> obstacle_meshes;
+    // Parsed from obstacle_meshes by load_obstacles, to be drawn as well.
+    std::vector<std::shared_ptr<ObjFormat const>> obstacle_objs;
+    ObstaclePlacement obstacle_placement;
+    // Built from obstacle_meshes by load_obstacles.
+    ObstacleConfig obstacles;
+    bool gpu = false;
+    std::size_t gpu_validate_interval = 0;
+    bool headless = false;
+    std::size_t frames = 600;
+    GLsizei frame_width = 1920;
+    GLsizei frame_height = 1080;
+    std::string frame_output = "frames";
+    std::size_t first_frame = 0;
+    std::size_t benchmark_steps = 0;
+    double frame_budget_ms = 0;
+
+    std::string snapshot;
+    std::string record;
+    std::string replay;
+    std::size_t replay_speed = 1;
+    std::string out_of_core;
+    std::string shared_memory;
+    std::size_t shared_memory_capacity = 0;
+
+    std::uint16_t stream_port = 0;
+    double stream_bandwidth = 4;
+    std::string stream_connect;
+    static constexpr GLfloat UNBOUNDED = std::numeric_limits<GLfloat>::infinity();
+    Vec3<GLfloat> stream_view_min = {{-UNBOUNDED, -UNBOUNDED, -UNBOUNDED}};
+    Vec3<GLfloat> stream_view_max = {{UNBOUNDED, UNBOUNDED, UNBOUNDED}};
+
+    std::size_t domain_count = 1;
+    std::size_t domain_rank = 0;
+    DomainTransportMode domain_transport = DomainTransportMode::Tcp;
+    std::vector<std::string> domain_hosts;
+    std::uint16_t domain_port = 7900;
+    std::string domain_name = "/boids_domain";
+    bool domain_scaling = false;
+
+    // The executable and arguments this scenario was read from, to start more
+    // processes of the same run.
+    std::vector<std::string> command_line;
+
+    // `--scenario <path>` is applied first, so other flags override the file.
+    [[nodiscard]] static Scenario from_command_line(int argc, char *argv[]);
+
+    void load_file(char const *path);
+    void set(std::string_view key, std::string_view value);
+    // Parses obstacle_meshes and builds the obstacle BVH from them as placed;
+    // from_command_line calls it.
+    void load_obstacles();
+
+    [[nodiscard]] std::vector<Boid> spawn_boids() const;
+    // A simulation of the initial flock with every setting above applied.
+    [[nodiscard]] Simulation create_simulation() const;
+    // The same flock spawned straight into the out_of_core directory, never held in memory.
+    [[nodiscard]] std::unique_ptr<OutOfCoreSimulation> create_out_of_core_simulation() const;
+    // This process's domain of the flock, connected to its neighbors. Every domain
+    // spawns the same initial flock one boid at a time and keeps only its own part.
+    [[nodiscard]] std::unique_ptr<DomainSimulation> create_domain_simulation() const;
+};
+
+#endif //SDL_GLEW_TEST_SCENARIO_HPP
@@ -7,6 +7,9 @@
 #include "SDL_image.h"
 #include <stdexcept>
 #include <string>
+#include <vector>
+#include <cstring>
+#include <utility>
 
 #include "sdl_session.hpp"
 
@@ -18,35 +21,58 @@ SdlImageLoader::~SdlImageLoader() noexcept {
     IMG_Quit();
 }
 
-SDL_Surface *SdlImageLoader::load_rgb24_image_flipped(const char *path) const  {
-    SDL_Surface *texture_surface = IMG_Load(path);
-    if (texture_surface == nullptr) {
-        throw std::runtime_error(std::string("Error loading image: ") + IMG_GetError());
+static bool is_gl_compatible(Uint32 format) noexcept {
+    switch (format) {
+        case SDL_PIXELFORMAT_RGB24:
+        case SDL_PIXELFORMAT_BGR24:
+        case SDL_PIXELFORMAT_RGBA32:
+        case SDL_PIXELFORMAT_BGRA32:
+            return true;
+        default:
+            return false;
     }
+}
 
-    int height = texture_surface->h;
-    int width = texture_surface->w;
-
-    SDL_Surface *ret = SDL_CreateRGBSurfaceWithFormat(0, width, height, SDL_BITSPERPIXEL(SDL_PIXELFORMAT_RGB24), SDL_PIXELFORMAT_RGB24);
-    if (ret == nullptr) {
-        SDL_FreeSurface(texture_surface);
-        sdl_->throw_current_error("Error creating RGB24 surface when loading flipped image");
+static void flip_rows(SDL_Surface *surface) {
+    auto *pixels = static_cast<unsigned char *>(surface->pixels);
+    auto pitch = static_cast<std::size_t>(surface->pitch);
+    std::vector<unsigned char> row(pitch);
+    for (int top = 0, bottom = surface->h - 1; top < bottom; ++top, --bottom) {
+        unsigned char *top_row = pixels + top * pitch;
+        unsigned char *bottom_row = pixels + bottom * pitch;
+        std::memcpy(row.data(), top_row, pitch);
+        std::memcpy(top_row, bottom_row, pitch);
+        std::memcpy(bottom_row, row.data(), pitch);
     }
+}
 
-    SDL_Rect src_rect = {0, 0, width, 1};
-    SDL_Rect dest_rect = {0, height - 1, width, 1};
-
-    for (int i = 0; i < height; ++i) {
-        SDL_BlitSurface(texture_surface, &src_rect, ret, &dest_rect);
-        ++src_rect.y;
-        --dest_rect.y;
+static SDL_Surface *load_surface(char const *path) {
+    SDL_Surface *surface = IMG_Load(path);
+    if (surface == nullptr) {
+        throw std::runtime_error(std::string("Error loading image: ") + IMG_GetError());
     }
+    return surface;
+}
 
-    SDL_FreeSurface(texture_surface);
+SDL_Surface *SdlImageLoader::load_image(char const *path, ImageOrientation orientation) const {
+    SDL_Surface *ret = load_surface(path);
 
-    if (SDL_SetSurfaceRLE(ret, 0) != 0) {
+    if (!is_gl_compatible(ret->format->format)) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat(ret, SDL_PIXELFORMAT_RGBA32, 0);
         SDL_FreeSurface(ret);
-        sdl_->throw_current_error("Error setting surface RLE when loading flipped image");
+        if (converted == nullptr) {
+            sdl_->throw_current_error("Error converting image to RGBA32");
+        }
+        ret = converted;
+    }
+
+    if (orientation == ImageOrientation::FlippedForGL) {
+        if (SDL_LockSurface(ret) != 0) {
+            SDL_FreeSurface(ret);
+            sdl_->throw_current_error("Error locking surface when flipping image");
+        }
+        flip_rows(ret);
+        SDL_UnlockSurface(ret);
     }
 
     return ret;
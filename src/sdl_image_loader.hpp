@@ -8,6 +8,13 @@
 struct SDL_Surface;
 class SdlSession;
 
+enum class ImageOrientation {
+    // Rows are kept in file order (top row first); flip texture coordinates instead.
+    AsStored,
+    // Rows are reversed so that the first row is the bottom of the image, as GL expects.
+    FlippedForGL,
+};
+
 class SdlImageLoader {
 public:
 
@@ -15,7 +22,9 @@ public:
 
     ~SdlImageLoader() noexcept;
 
-    [[nodiscard]] SDL_Surface *load_rgb24_image_flipped(char const* path) const;
+    // Keeps the decoded pixel format whenever GL can consume it directly (RGB8, BGR8,
+    // RGBA8, BGRA8), only converting other formats to RGBA8.
+    [[nodiscard]] SDL_Surface *load_image(char const *path, ImageOrientation orientation) const;
 
 private:
     SdlSession const *sdl_;
@@ -8,8 +8,12 @@
 #include <string>
 #include "SDL.h"
 
-SdlSession::SdlSession()  {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER) != 0) {
+SdlSession::SdlSession(SdlSessionConfig config)  {
+    Uint32 subsystems = SDL_INIT_EVENTS | SDL_INIT_TIMER;
+    if (config.video) {
+        subsystems |= SDL_INIT_VIDEO;
+    }
+    if (SDL_Init(subsystems) != 0) {
         throw std::runtime_error(std::string("Error initializing SDL: ") + SDL_GetError());
     }
 }
@@ -7,9 +7,14 @@
 
 #include <string>
 
+struct SdlSessionConfig {
+    // Off for headless runs, which have no windows and may have no display to open.
+    bool video = true;
+};
+
 class SdlSession {
 public:
-    SdlSession();
+    explicit SdlSession(SdlSessionConfig config = {});
 
     ~SdlSession() noexcept;
 
@@ -0,0 +1,67 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SHARED_FLOCK_LAYOUT_HPP
+#define SDL_GLEW_TEST_SHARED_FLOCK_LAYOUT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the shared memory segment the simulation exports its state to,
+// shared by SharedFlockWriter and SharedFlockReader.
+//
+// The header is followed by a ring of slots, each a seqlock: the slot's sequence
+// is odd while the writer fills it and 2 * (frame + 1) once frame `frame` is
+// complete. A reader copies a slot out and keeps the copy only if the sequence
+// was even and unchanged across the copy, so the writer never waits for readers.
+//
+// Within a slot, after its header, come seven arrays of `capacity` elements,
+// each starting on a cache line: position x, y, z and velocity x, y, z as
+// floats, then the boids' stable ids as uint32. Boids are in the simulation's
+// storage order.
+
+constexpr char SHARED_FLOCK_MAGIC[4] = {'B', 'S', 'H', 'M'};
+constexpr std::uint32_t SHARED_FLOCK_VERSION = 1;
+constexpr std::size_t SHARED_FLOCK_ALIGNMENT = 64;
+constexpr std::size_t SHARED_FLOCK_ARRAYS = 7;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory counters must be lock-free");
+
+struct SharedFlockHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint32_t capacity;
+    std::uint64_t slot_bytes;
+    // Number of frames published; the latest is in slot (published - 1) % slot_count.
+    alignas(SHARED_FLOCK_ALIGNMENT) std::atomic<std::uint64_t> published;
+};
+
+struct alignas(SHARED_FLOCK_ALIGNMENT) SharedFlockSlotHeader {
+    std::atomic<std::uint64_t> sequence;
+    std::uint64_t step;
+    // Boids in the flock, and how many of them fit in the slot.
+    std::uint32_t boid_count;
+    std::uint32_t stored_count;
+};
+
+[[nodiscard]] constexpr std::size_t shared_flock_align(std::size_t n) noexcept {
+    return (n + SHARED_FLOCK_ALIGNMENT - 1) / SHARED_FLOCK_ALIGNMENT * SHARED_FLOCK_ALIGNMENT;
+}
+
+// Offset of array `index` from the start of its slot.
+[[nodiscard]] constexpr std::size_t shared_flock_array_offset(std::uint32_t capacity, std::size_t index) noexcept {
+    return sizeof(SharedFlockSlotHeader) + index * shared_flock_align(capacity * sizeof(float));
+}
+
+[[nodiscard]] constexpr std::size_t shared_flock_slot_bytes(std::uint32_t capacity) noexcept {
+    return shared_flock_array_offset(capacity, SHARED_FLOCK_ARRAYS);
+}
+
+[[nodiscard]] constexpr std::size_t shared_flock_segment_bytes(std::uint32_t capacity, std::uint32_t slot_count) noexcept {
+    return shared_flock_align(sizeof(SharedFlockHeader)) + slot_count * shared_flock_slot_bytes(capacity);
+}
+
+#endif //SDL_GLEW_TEST_SHARED_FLOCK_LAYOUT_HPP
@@ -0,0 +1,123 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "shared_flock_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SharedFlockReader::SharedFlockReader(std::string const &name) {
+#ifdef _WIN32
+    mapping_ = OpenFileMappingA(FILE_MAP_READ, false, name.c_str());
+    if (mapping_ == nullptr) {
+        throw std::runtime_error(std::format("Could not open shared memory '{}'", name));
+    }
+    data_ = static_cast<std::byte const *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        throw std::runtime_error(std::format("Could not map shared memory '{}'", name));
+    }
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(data_, &info, sizeof(info));
+    size_ = info.RegionSize;
+#else
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+        throw std::runtime_error(std::format("Could not open shared memory '{}'", name));
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error(std::format("Could not get size of shared memory '{}'", name));
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(std::format("Could not map shared memory '{}'", name));
+    }
+    data_ = static_cast<std::byte const *>(data);
+#endif
+
+    header_ = std::launder(reinterpret_cast<SharedFlockHeader const *>(data_));
+    bool valid = size_ >= sizeof(SharedFlockHeader)
+        && std::memcmp(header_->magic, SHARED_FLOCK_MAGIC, sizeof(SHARED_FLOCK_MAGIC)) == 0
+        && header_->version == SHARED_FLOCK_VERSION
+        && header_->slot_bytes == shared_flock_slot_bytes(header_->capacity)
+        && size_ >= shared_flock_segment_bytes(header_->capacity, header_->slot_count);
+    if (!valid) {
+        unmap();
+        throw std::runtime_error(std::format("Shared memory '{}' does not hold an exported flock", name));
+    }
+}
+
+SharedFlockReader::~SharedFlockReader() noexcept {
+    unmap();
+}
+
+void SharedFlockReader::unmap() noexcept {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+#else
+    munmap(const_cast<std::byte *>(data_), size_);
+#endif
+}
+
+bool SharedFlockReader::read_latest(SharedFlockFrame &out) {
+    for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        auto published = header_->published.load(std::memory_order_acquire);
+        if (published == 0 || published == out.frame) {
+            return false;
+        }
+        auto frame = published - 1;
+        auto const *slot_data = data_ + shared_flock_align(sizeof(SharedFlockHeader))
+            + (frame % header_->slot_count) * header_->slot_bytes;
+        auto const *slot = std::launder(reinterpret_cast<SharedFlockSlotHeader const *>(slot_data));
+
+        auto sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * frame + 2) {
+            continue;
+        }
+        auto step = slot->step;
+        auto boid_count = slot->boid_count;
+        auto stored = std::min(slot->stored_count, header_->capacity);
+        for (int c = 0; c < 3; ++c) {
+            out.pos[c].resize(stored);
+            out.velocity[c].resize(stored);
+            std::memcpy(out.pos[c].data(), slot_data + shared_flock_array_offset(header_->capacity, c), stored * sizeof(float));
+            std::memcpy(out.velocity[c].data(), slot_data + shared_flock_array_offset(header_->capacity, 3 + c), stored * sizeof(float));
+        }
+        out.ids.resize(stored);
+        std::memcpy(out.ids.data(), slot_data + shared_flock_array_offset(header_->capacity, 6), stored * sizeof(std::uint32_t));
+
+        // The copy is only good if the writer did not start on this slot meanwhile.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) == sequence) {
+            out.frame = published;
+            out.step = step;
+            out.boid_count = boid_count;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::uint32_t SharedFlockReader::capacity() const noexcept {
+    return header_->capacity;
+}
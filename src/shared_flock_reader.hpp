@@ -0,0 +1,60 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SHARED_FLOCK_READER_HPP
+#define SDL_GLEW_TEST_SHARED_FLOCK_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "shared_flock_layout.hpp"
+
+// One frame of flock state copied out of shared memory.
+struct SharedFlockFrame {
+    // Number of frames the writer had published when this one was the latest.
+    std::uint64_t frame = 0;
+    std::uint64_t step = 0;
+    // May exceed the number of boids stored, if the flock outgrew the segment.
+    std::uint32_t boid_count = 0;
+    std::vector<float> pos[3];
+    std::vector<float> velocity[3];
+    std::vector<std::uint32_t> ids;
+};
+
+// Reads the state a running simulation publishes with SharedFlockWriter. Reading
+// never blocks the writer; a read that the writer overtakes is retried on a
+// newer frame, and given up after a few attempts.
+class SharedFlockReader {
+public:
+    // Throws if no simulation is exporting under this name.
+    explicit SharedFlockReader(std::string const &name);
+    ~SharedFlockReader() noexcept;
+
+    SharedFlockReader(SharedFlockReader const &other) = delete;
+    SharedFlockReader(SharedFlockReader &&other) = delete;
+    SharedFlockReader &operator=(SharedFlockReader const &other) = delete;
+    SharedFlockReader &operator=(SharedFlockReader &&other) = delete;
+
+    // Copies the latest frame into `out` if it is newer than the one already
+    // there. Returns whether it did.
+    bool read_latest(SharedFlockFrame &out);
+
+    [[nodiscard]] std::uint32_t capacity() const noexcept;
+
+private:
+    static constexpr int MAX_ATTEMPTS = 4;
+
+    void unmap() noexcept;
+
+    std::size_t size_;
+    std::byte const *data_;
+#ifdef _WIN32
+    void *mapping_;
+#endif
+    SharedFlockHeader const *header_;
+};
+
+#endif //SDL_GLEW_TEST_SHARED_FLOCK_READER_HPP
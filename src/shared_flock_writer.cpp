@@ -0,0 +1,117 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "shared_flock_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "trace.hpp"
+
+SharedFlockWriter::SharedFlockWriter(std::string name, std::uint32_t capacity, std::uint32_t slot_count):
+    name_(std::move(name)),
+    capacity_(capacity),
+    size_(shared_flock_segment_bytes(capacity, std::max<std::uint32_t>(slot_count, 2)))
+{
+    slot_count = std::max<std::uint32_t>(slot_count, 2);
+#ifdef _WIN32
+    auto size = static_cast<std::uint64_t>(size_);
+    mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), name_.c_str());
+    if (mapping_ == nullptr) {
+        throw std::runtime_error(std::format("Could not create shared memory '{}'", name_));
+    }
+    data_ = static_cast<std::byte *>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_);
+        throw std::runtime_error(std::format("Could not map shared memory '{}'", name_));
+    }
+#else
+    // A segment left behind by an earlier run would keep its old layout.
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd == -1) {
+        throw std::runtime_error(std::format("Could not create shared memory '{}'", name_));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error(std::format("Could not size shared memory '{}' to {} bytes", name_, size_));
+    }
+    void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(name_.c_str());
+        throw std::runtime_error(std::format("Could not map shared memory '{}'", name_));
+    }
+    data_ = static_cast<std::byte *>(data);
+#endif
+
+    // The segment starts zeroed, so every slot's sequence starts out even and
+    // `published` at zero; the header is complete before any frame is published.
+    header_ = new (data_) SharedFlockHeader;
+    std::memcpy(header_->magic, SHARED_FLOCK_MAGIC, sizeof(SHARED_FLOCK_MAGIC));
+    header_->version = SHARED_FLOCK_VERSION;
+    header_->slot_count = slot_count;
+    header_->capacity = capacity_;
+    header_->slot_bytes = shared_flock_slot_bytes(capacity_);
+    header_->published.store(0, std::memory_order_release);
+    for (std::uint32_t i = 0; i < slot_count; ++i) {
+        auto *slot = data_ + shared_flock_align(sizeof(SharedFlockHeader)) + i * header_->slot_bytes;
+        new (slot) SharedFlockSlotHeader{};
+    }
+}
+
+SharedFlockWriter::~SharedFlockWriter() noexcept {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+#else
+    munmap(data_, size_);
+    shm_unlink(name_.c_str());
+#endif
+}
+
+void SharedFlockWriter::publish(std::uint64_t step, std::span<Boid const> boids, std::span<std::uint32_t const> ids) noexcept {
+    TRACE_SCOPE("shared_memory_publish", "sim");
+    auto frame = published_++;
+    auto *slot_data = data_ + shared_flock_align(sizeof(SharedFlockHeader)) + (frame % header_->slot_count) * header_->slot_bytes;
+    auto *slot = std::launder(reinterpret_cast<SharedFlockSlotHeader *>(slot_data));
+
+    slot->sequence.store(2 * frame + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto stored = static_cast<std::uint32_t>(std::min<std::size_t>(boids.size(), capacity_));
+    slot->step = step;
+    slot->boid_count = static_cast<std::uint32_t>(boids.size());
+    slot->stored_count = stored;
+    float *arrays[6];
+    for (std::size_t a = 0; a < 6; ++a) {
+        arrays[a] = reinterpret_cast<float *>(slot_data + shared_flock_array_offset(capacity_, a));
+    }
+    for (std::uint32_t i = 0; i < stored; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            arrays[c][i] = boids[i].pos[c];
+            arrays[3 + c][i] = boids[i].velocity[c];
+        }
+    }
+    std::memcpy(slot_data + shared_flock_array_offset(capacity_, 6), ids.data(), stored * sizeof(std::uint32_t));
+
+    slot->sequence.store(2 * frame + 2, std::memory_order_release);
+    header_->published.store(frame + 1, std::memory_order_release);
+}
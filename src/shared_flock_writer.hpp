@@ -0,0 +1,45 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SHARED_FLOCK_WRITER_HPP
+#define SDL_GLEW_TEST_SHARED_FLOCK_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "boid.hpp"
+#include "shared_flock_layout.hpp"
+
+// Publishes flock state to a named shared memory segment (under /dev/shm on
+// Linux) for other processes to read with SharedFlockReader. Publishing is plain
+// stores into the mapping, without system calls or waiting on readers. Boids
+// beyond the capacity are left out of the slots.
+class SharedFlockWriter {
+public:
+    SharedFlockWriter(std::string name, std::uint32_t capacity, std::uint32_t slot_count = 4);
+    // Removes the segment; readers that have it mapped keep their mapping.
+    ~SharedFlockWriter() noexcept;
+
+    SharedFlockWriter(SharedFlockWriter const &other) = delete;
+    SharedFlockWriter(SharedFlockWriter &&other) = delete;
+    SharedFlockWriter &operator=(SharedFlockWriter const &other) = delete;
+    SharedFlockWriter &operator=(SharedFlockWriter &&other) = delete;
+
+    void publish(std::uint64_t step, std::span<Boid const> boids, std::span<std::uint32_t const> ids) noexcept;
+
+private:
+    std::string name_;
+    std::uint32_t capacity_;
+    std::size_t size_;
+    std::byte *data_;
+#ifdef _WIN32
+    void *mapping_;
+#endif
+    SharedFlockHeader *header_;
+    std::uint64_t published_ = 0;
+};
+
+#endif //SDL_GLEW_TEST_SHARED_FLOCK_WRITER_HPP
@@ -0,0 +1,432 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "trace.hpp"
+
+void WorldBounds::wrap(Vec3<GLfloat> &pos) const noexcept {
+    for (int i = 0; i < 3; ++i) {
+        auto extent = max[i] - min[i];
+        if (pos[i] > max[i]) {
+            pos[i] -= extent;
+        } else if (pos[i] < min[i]) {
+            pos[i] += extent;
+        }
+    }
+}
+
+Vec3<GLfloat> WorldBounds::random_point(std::minstd_rand &rng) const {
+    Vec3<GLfloat> ret;
+    for (int i = 0; i < 3; ++i) {
+        ret[i] = std::uniform_real_distribution<GLfloat>(min[i], max[i])(rng);
+    }
+    return ret;
+}
+
+static std::uint32_t spread_bits(std::uint32_t x) noexcept {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+std::uint32_t WorldBounds::morton_code(Vec3<GLfloat> const &pos) const noexcept {
+    std::uint32_t ret = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto t = std::clamp((pos[i] - min[i]) / (max[i] - min[i]), 0.0f, 1.0f);
+        ret |= spread_bits(static_cast<std::uint32_t>(t * 1023.0f)) << i;
+    }
+    return ret;
+}
+
+Simulation::Simulation(std::span<Boid const> boids, Boid::Mindset mindset, WorldBounds bounds, std::uint32_t seed):
+    current_(boids.size()),
+    next_(boids.size()),
+    ids_(boids.size()),
+    next_ids_(boids.size()),
+    slot_of_id_(boids.size()),
+    tier_of_id_(boids.size()),
+    mindset_(mindset),
+    bounds_(bounds),
+    rng_(seed),
+    interaction_(std::make_unique<AllPairsInteraction>(std::numeric_limits<GLfloat>::infinity())),
+    pool_(std::make_unique<WorkerPool>())
+{
+    std::copy(boids.begin(), boids.end(), current_.begin());
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        ids_[i] = static_cast<std::uint32_t>(i);
+    }
+    update_slots_of_ids();
+}
+
+constexpr std::size_t STEP_GRAIN = 256;
+
+void Simulation::set_interaction(std::unique_ptr<InteractionBackend> interaction) noexcept {
+    interaction_ = std::move(interaction);
+}
+
+void Simulation::set_thread_count(std::size_t thread_count) {
+    thread_count_ = thread_count;
+    pool_ = std::make_unique<WorkerPool>(thread_count_, memory_.pin_threads);
+    if (memory_.numa_first_touch) {
+        placement_pending_ = true;
+    }
+}
+
+void Simulation::set_memory_config(MemoryConfig config) {
+    auto repin = config.pin_threads != memory_.pin_threads;
+    memory_ = config;
+    if (repin) {
+        pool_ = std::make_unique<WorkerPool>(thread_count_, memory_.pin_threads);
+    }
+    placement_pending_ = true;
+}
+
+void Simulation::place_buffers() {
+    TRACE_SCOPE("place_buffers", "sim");
+    placement_pending_ = false;
+    block_nodes_.assign(pool_->thread_count(), -1);
+    place(current_);
+    place(next_);
+    place(ids_);
+    place(next_ids_);
+    place(slot_of_id_);
+    place(tier_of_id_);
+    place(geometry_avoidance_);
+}
+
+template<typename T>
+void Simulation::place(AlignedBuffer<T> &buffer) {
+    AlignedBuffer<T> placed(memory_.page_policy);
+    placed.reserve(buffer.capacity());
+    placed.resize_for_overwrite(buffer.size());
+    auto copy = [&](std::size_t begin, std::size_t end) {
+        std::memcpy(placed.data() + begin, buffer.data() + begin, (end - begin) * sizeof(T));
+    };
+    if (memory_.numa_first_touch) {
+        auto block = (buffer.size() + pool_->thread_count() - 1) / pool_->thread_count();
+        pool_->parallel_for_static(buffer.size(), [&](std::size_t begin, std::size_t end) {
+            copy(begin, end);
+            block_nodes_[begin / block] = current_numa_node();
+        });
+    } else {
+        copy(0, buffer.size());
+    }
+    buffer = std::move(placed);
+}
+
+void Simulation::for_each_boid(WorkerPool::RangeFunction const &fn) {
+    if (memory_.numa_first_touch) {
+        pool_->parallel_for_static(current_.size(), fn);
+    } else {
+        pool_->parallel_for(current_.size(), STEP_GRAIN, fn);
+    }
+}
+
+void Simulation::set_reorder_interval(std::size_t steps) noexcept {
+    reorder_interval_ = steps;
+    steps_since_reorder_ = 0;
+}
+
+void Simulation::set_deterministic(bool deterministic) noexcept {
+    deterministic_ = deterministic;
+    interaction_->invalidate();
+}
+
+void Simulation::set_multi_rate(MultiRateConfig config) noexcept {
+    multi_rate_ = config;
+    multi_rate_stats_ = {};
+    std::fill(tier_of_id_.begin(), tier_of_id_.end(), std::uint8_t{0});
+}
+
+void Simulation::set_obstacles(ObstacleConfig config) noexcept {
+    obstacles_ = std::move(config);
+    obstacle_stats_ = {};
+    geometry_avoidance_.resize(obstacles_.bvh ? current_.size() : 0);
+    // The new buffer goes where the others are, as the next step places them all.
+    if (memory_.numa_first_touch || memory_.page_policy != PagePolicy::Default) {
+        placement_pending_ = true;
+    }
+}
+
+// Tiers add up over camera distance and sparseness, so a distant isolated boid
+// is updated least often.
+static std::uint8_t multi_rate_tier(MultiRateConfig const &config, Vec3<GLfloat> const &pos, GLfloat inv_dist_sq) noexcept {
+    constexpr int max_tier = MultiRateConfig::TIER_COUNT - 1;
+    auto diff = pos - config.camera;
+    auto distance_sq = diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2];
+    int tier = 0;
+    for (auto reach = 2 * config.full_rate_distance; distance_sq >= reach * reach && tier < max_tier; reach *= 2) {
+        ++tier;
+    }
+    for (auto density = config.dense_inv_dist_sq; inv_dist_sq < density && tier < max_tier; density /= 2) {
+        ++tier;
+    }
+    return static_cast<std::uint8_t>(tier);
+}
+
+void Simulation::step() {
+    TRACE_SCOPE("boid_step", "sim");
+    if (placement_pending_) {
+        place_buffers();
+    }
+    std::span<Boid const> current = current_;
+    FlockView flock = {
+        .boids = current,
+        .ids = ids_,
+        .slots = slot_of_id_,
+        .id_order = deterministic_,
+    };
+    auto start = std::chrono::steady_clock::now();
+    interaction_->prepare(flock, *pool_);
+    auto step = steps_++;
+    std::uint64_t updates = 0;
+    std::array<std::size_t, MultiRateConfig::TIER_COUNT> tier_counts = {};
+    ObstacleStats obstacle_stats;
+    // Boids of a tier are spread over its steps by id.
+    auto updates_now = [&](std::size_t i) {
+        return !multi_rate_.enabled || (step + ids_[i]) % (1u << tier_of_id_[ids_[i]]) == 0;
+    };
+    for_each_boid([&](std::size_t begin, std::size_t end) {
+        if (obstacles_.bvh) {
+            // The whole range queries the obstacles before gathering neighbors, so
+            // that the BVH nodes around these boids stay in cache from one query to
+            // the next.
+            auto query_start = std::chrono::steady_clock::now();
+            ObstacleStats range_stats;
+            for (auto i = begin; i < end; ++i) {
+                Boid::SituationalAwareness awareness;
+                if (updates_now(i)) {
+                    current[i].consider(awareness, *obstacles_.bvh, obstacles_.look_ahead, obstacles_.clearance);
+                    ++range_stats.queries;
+                    range_stats.avoiding += awareness.sees_geometry() ? 1 : 0;
+                }
+                geometry_avoidance_[i] = awareness.geometry_avoidance;
+            }
+            std::chrono::nanoseconds query_time = std::chrono::steady_clock::now() - query_start;
+            std::atomic_ref(obstacle_stats.queries).fetch_add(range_stats.queries, std::memory_order_relaxed);
+            std::atomic_ref(obstacle_stats.avoiding).fetch_add(range_stats.avoiding, std::memory_order_relaxed);
+            std::atomic_ref(obstacle_stats.query_ns).fetch_add(static_cast<std::uint64_t>(query_time.count()), std::memory_order_relaxed);
+        }
+
+        std::uint64_t range_updates = 0;
+        std::array<std::size_t, MultiRateConfig::TIER_COUNT> range_tier_counts = {};
+        for (auto i = begin; i < end; ++i) {
+            Boid &next = next_[i];
+            next = current[i];
+            auto *tier = multi_rate_.enabled ? &tier_of_id_[ids_[i]] : nullptr;
+            if (!updates_now(i)) {
+                // Between updates a boid keeps the velocity it last decided on.
+                next.act_upon({next.velocity});
+            } else {
+                Boid::SituationalAwareness awareness;
+                if (obstacles_.bvh) {
+                    awareness.geometry_avoidance = geometry_avoidance_[i];
+                }
+                interaction_->gather(flock, i, awareness);
+
+                if (awareness.total_inv_dist_sq > 0) {
+                    next.act_upon(awareness.into_decision(mindset_));
+                } else {
+                    // Nobody in sight: keep going the same way, unless that leads into geometry.
+                    next.act_upon(awareness.into_lone_decision(next.velocity, mindset_));
+                }
+                if (tier) {
+                    // Boids steering around obstacles are updated every step until clear of them.
+                    *tier = awareness.sees_geometry() ? 0 : multi_rate_tier(multi_rate_, current[i].pos, awareness.total_inv_dist_sq);
+                }
+                ++range_updates;
+            }
+            bounds_.wrap(next.pos);
+            if (tier) {
+                ++range_tier_counts[*tier];
+            }
+        }
+        if (multi_rate_.enabled) {
+            std::atomic_ref(updates).fetch_add(range_updates, std::memory_order_relaxed);
+            for (std::size_t t = 0; t < MultiRateConfig::TIER_COUNT; ++t) {
+                std::atomic_ref(tier_counts[t]).fetch_add(range_tier_counts[t], std::memory_order_relaxed);
+            }
+        }
+    });
+    if (multi_rate_.enabled) {
+        multi_rate_stats_.boid_steps += current.size();
+        multi_rate_stats_.updates += updates;
+        multi_rate_stats_.tier_counts = tier_counts;
+        TRACE_COUNTER("multi_rate_updates", static_cast<double>(updates));
+    }
+    if (obstacles_.bvh) {
+        obstacle_stats_.queries += obstacle_stats.queries;
+        obstacle_stats_.avoiding += obstacle_stats.avoiding;
+        obstacle_stats_.query_ns += obstacle_stats.query_ns;
+        TRACE_COUNTER("obstacle_avoiding", static_cast<double>(obstacle_stats.avoiding));
+    }
+    std::chrono::duration<double, std::milli> interaction_time = std::chrono::steady_clock::now() - start;
+    interaction_->step_finished(interaction_time.count());
+    std::swap(current_, next_);
+
+    if (reorder_interval_ != 0 && ++steps_since_reorder_ >= reorder_interval_) {
+        reorder();
+        steps_since_reorder_ = 0;
+    }
+}
+
+void Simulation::reorder() {
+    TRACE_SCOPE("morton_reorder", "sim");
+    auto count = current_.size();
+    sort_keys_.resize(count);
+    pool_->parallel_for(count, 4096, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            sort_keys_[i] = {bounds_.morton_code(current_[i].pos), ids_[i]};
+        }
+    });
+    // Ties broken by id, so the order depends only on positions and ids.
+    std::sort(sort_keys_.begin(), sort_keys_.end());
+
+    pool_->parallel_for(count, 4096, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            auto id = sort_keys_[i].second;
+            next_[i] = current_[slot_of_id_[id]];
+            next_ids_[i] = id;
+        }
+    });
+    std::swap(current_, next_);
+    std::swap(ids_, next_ids_);
+    update_slots_of_ids();
+    interaction_->invalidate();
+}
+
+void Simulation::update_slots_of_ids() noexcept {
+    for (std::size_t i = 0; i < ids_.size(); ++i) {
+        slot_of_id_[ids_[i]] = static_cast<std::uint32_t>(i);
+    }
+}
+
+void Simulation::resize(std::size_t count) {
+    auto old_count = current_.size();
+    auto reallocates = count > current_.capacity();
+    if (count < old_count) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < old_count; ++i) {
+            if (ids_[i] < count) {
+                current_[kept] = current_[i];
+                ids_[kept] = ids_[i];
+                ++kept;
+            }
+        }
+    }
+
+    current_.resize(count);
+    next_.resize(count);
+    ids_.resize(count);
+    next_ids_.resize(count);
+    slot_of_id_.resize(count);
+    tier_of_id_.resize(count);
+    if (obstacles_.bvh) {
+        geometry_avoidance_.resize(count);
+    }
+    for (auto i = old_count; i < count; ++i) {
+        current_[i] = {.pos = bounds_.random_point(rng_), .velocity = {{0, 0, 0}}};
+        ids_[i] = static_cast<std::uint32_t>(i);
+    }
+    update_slots_of_ids();
+    if (reallocates && (memory_.numa_first_touch || memory_.page_policy != PagePolicy::Default)) {
+        place_buffers();
+    }
+    interaction_->invalidate();
+}
+
+std::span<Boid const> Simulation::boids() const noexcept {
+    return current_;
+}
+
+Boid::Mindset const &Simulation::mindset() const noexcept {
+    return mindset_;
+}
+
+WorldBounds const &Simulation::bounds() const noexcept {
+    return bounds_;
+}
+
+std::span<std::uint32_t const> Simulation::ids() const noexcept {
+    return ids_;
+}
+
+std::uint32_t Simulation::slot_of(std::uint32_t id) const noexcept {
+    return slot_of_id_[id];
+}
+
+CacheCounters::Sample Simulation::cache_counts() {
+    return pool_->cache_counts();
+}
+
+MemoryStats Simulation::memory_stats() const {
+    constexpr std::size_t SAMPLES_PER_BLOCK = 16;
+    constexpr std::uintptr_t PAGE_SIZE = 4096;
+
+    MemoryStats ret;
+    ret.faults = process_page_faults();
+    auto count = current_.size();
+    if (count == 0) {
+        return ret;
+    }
+
+    std::vector<void const *> pages;
+    std::vector<int> owner_nodes;
+    auto blocks = std::max<std::size_t>(block_nodes_.size(), 1);
+    auto block = (count + blocks - 1) / blocks;
+    for (std::size_t b = 0; b < blocks && b * block < count; ++b) {
+        auto end = std::min((b + 1) * block, count);
+        for (std::size_t s = 0; s < SAMPLES_PER_BLOCK; ++s) {
+            auto i = b * block + (end - b * block) * s / SAMPLES_PER_BLOCK;
+            auto address = reinterpret_cast<std::uintptr_t>(current_.data() + i) & ~(PAGE_SIZE - 1);
+            if (pages.empty() || pages.back() != reinterpret_cast<void const *>(address)) {
+                pages.push_back(reinterpret_cast<void const *>(address));
+                owner_nodes.push_back(block_nodes_.empty() ? -1 : block_nodes_[b]);
+            }
+        }
+    }
+
+    std::vector<int> nodes(pages.size(), -1);
+    if (!query_page_nodes(pages, nodes)) {
+        return ret;
+    }
+    for (std::size_t p = 0; p < pages.size(); ++p) {
+        if (nodes[p] < 0) {
+            continue;
+        }
+        auto node = static_cast<std::size_t>(nodes[p]);
+        if (ret.pages_per_node.size() <= node) {
+            ret.pages_per_node.resize(node + 1);
+        }
+        ++ret.pages_per_node[node];
+        ++ret.sampled_pages;
+        if (nodes[p] == owner_nodes[p]) {
+            ++ret.local_pages;
+        }
+    }
+    return ret;
+}
+
+MultiRateStats const &Simulation::multi_rate_stats() const noexcept {
+    return multi_rate_stats_;
+}
+
+ObstacleStats const &Simulation::obstacle_stats() const noexcept {
+    return obstacle_stats_;
+}
+
+InteractionBackend const &Simulation::interaction() const noexcept {
+    return *interaction_;
+}
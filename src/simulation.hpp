@@ -0,0 +1,181 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SIMULATION_HPP
+#define SDL_GLEW_TEST_SIMULATION_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "GL/glew.h"
+#include "matrix.hpp"
+#include "boid.hpp"
+#include "aligned_buffer.hpp"
+#include "interaction.hpp"
+#include "worker_pool.hpp"
+#include "page_allocator.hpp"
+#include "obstacle_bvh.hpp"
+
+// Boids leaving the box re-enter on the opposite side.
+struct WorldBounds {
+    Vec3<GLfloat> min;
+    Vec3<GLfloat> max;
+
+    void wrap(Vec3<GLfloat> &pos) const noexcept;
+    [[nodiscard]] Vec3<GLfloat> random_point(std::minstd_rand &rng) const;
+    // Interleaves the bits of the position's 10-bit grid coordinates, so that
+    // boids close in space tend to get close codes.
+    [[nodiscard]] std::uint32_t morton_code(Vec3<GLfloat> const &pos) const noexcept;
+};
+
+// Where per-boid arrays live. With first-touch placement each worker thread
+// writes, and thereby places on its own NUMA node, the block of every array that
+// it then steps; this only pays off with pinned threads.
+struct MemoryConfig {
+    PagePolicy page_policy = PagePolicy::Default;
+    bool numa_first_touch = false;
+    bool pin_threads = false;
+};
+
+// Boids far from the camera or from other boids are updated every 2, 4 or 8
+// steps instead of every step, and keep the velocity they decided on in
+// between, which is where errors are too small to see. Each boid's tier is
+// picked at its updates: one tier up per doubling of camera distance beyond
+// twice full_rate_distance, plus one per halving of neighbor density below
+// dense_inv_dist_sq (the summed inverse squared distance of the neighbors it
+// saw; one neighbor 10 away by default).
+struct MultiRateConfig {
+    static constexpr std::size_t TIER_COUNT = 4;
+
+    bool enabled = false;
+    Vec3<GLfloat> camera = {{0, 0, 0}};
+    GLfloat full_rate_distance = 100;
+    GLfloat dense_inv_dist_sq = 0.01f;
+};
+
+// Totals since multi-rate stepping was enabled.
+struct MultiRateStats {
+    // Boids times steps, and how many of those boids gathered neighbors and decided anew.
+    std::uint64_t boid_steps = 0;
+    std::uint64_t updates = 0;
+    // Boids in each tier after the last step.
+    std::array<std::size_t, MultiRateConfig::TIER_COUNT> tier_counts = {};
+};
+
+// Static geometry boids steer clear of: each boid casts a ray look_ahead along
+// its velocity and looks for the nearest surface within clearance.
+struct ObstacleConfig {
+    std::shared_ptr<ObstacleBvh const> bvh;
+    GLfloat look_ahead = 40;
+    GLfloat clearance = 6;
+};
+
+// Totals since obstacles were set.
+struct ObstacleStats {
+    // Boids that queried the obstacles, and how many of them had to steer away.
+    std::uint64_t queries = 0;
+    std::uint64_t avoiding = 0;
+    // Summed over threads.
+    std::uint64_t query_ns = 0;
+};
+
+struct MemoryStats {
+    PageFaults faults;
+    // Sampled pages of the boid array, and how many sit on the node of the thread that steps them.
+    std::size_t sampled_pages = 0;
+    std::size_t local_pages = 0;
+    std::vector<std::size_t> pages_per_node;
+};
+
+// Flock state, double-buffered: each step reads only the current state and
+// writes the next one, so every boid decides on the same snapshot. That also lets
+// boids be stepped in parallel.
+//
+// Boids are stored in slots that may be periodically re-sorted along a Z-order
+// curve, so that neighbors in space are also neighbors in memory. Each boid
+// keeps a stable id in [0, count) for anything that must follow it across
+// reorders.
+class Simulation {
+public:
+    // Starts with unlimited-range all-pairs interaction, on one thread per hardware thread.
+    Simulation(std::span<Boid const> boids, Boid::Mindset mindset, WorldBounds bounds, std::uint32_t seed);
+
+    void set_interaction(std::unique_ptr<InteractionBackend> interaction) noexcept;
+    // Zero means one per hardware thread.
+    void set_thread_count(std::size_t thread_count);
+    // Moves every per-boid array into storage allocated as configured, at the start
+    // of the next step, so that the thread stepping the simulation is the one that
+    // first touches the caller's block.
+    void set_memory_config(MemoryConfig config);
+    // Re-sorts boids into Morton order every `steps` steps; zero disables it.
+    void set_reorder_interval(std::size_t steps) noexcept;
+    // Sums every boid's neighbors in stable id order, so that results are
+    // bit-identical regardless of thread count and reordering.
+    void set_deterministic(bool deterministic) noexcept;
+    void set_multi_rate(MultiRateConfig config) noexcept;
+    void set_obstacles(ObstacleConfig config) noexcept;
+
+    void step();
+    // Drops the boids with the highest ids, or adds boids at rest at random points
+    // in the world. Storage only grows, so resizing within the largest size so far
+    // never allocates.
+    void resize(std::size_t count);
+
+    [[nodiscard]] std::span<Boid const> boids() const noexcept;
+    // Stable id of the boid in each slot.
+    [[nodiscard]] std::span<std::uint32_t const> ids() const noexcept;
+    [[nodiscard]] std::uint32_t slot_of(std::uint32_t id) const noexcept;
+    [[nodiscard]] CacheCounters::Sample cache_counts();
+    [[nodiscard]] MemoryStats memory_stats() const;
+    [[nodiscard]] MultiRateStats const &multi_rate_stats() const noexcept;
+    [[nodiscard]] ObstacleStats const &obstacle_stats() const noexcept;
+    [[nodiscard]] Boid::Mindset const &mindset() const noexcept;
+    [[nodiscard]] WorldBounds const &bounds() const noexcept;
+    [[nodiscard]] InteractionBackend const &interaction() const noexcept;
+
+private:
+    void reorder();
+    void update_slots_of_ids() noexcept;
+    void place_buffers();
+    template<typename T>
+    void place(AlignedBuffer<T> &buffer);
+    void for_each_boid(WorkerPool::RangeFunction const &fn);
+
+    AlignedBuffer<Boid> current_;
+    AlignedBuffer<Boid> next_;
+    AlignedBuffer<std::uint32_t> ids_;
+    AlignedBuffer<std::uint32_t> next_ids_;
+    AlignedBuffer<std::uint32_t> slot_of_id_;
+    // Indexed by id, so that tiers follow boids across reorders.
+    AlignedBuffer<std::uint8_t> tier_of_id_;
+    // Per slot, what each boid's obstacle query found this step.
+    AlignedBuffer<Vec3<GLfloat>> geometry_avoidance_;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> sort_keys_;
+    std::size_t reorder_interval_ = 0;
+    bool deterministic_ = false;
+    std::size_t steps_since_reorder_ = 0;
+    std::uint64_t steps_ = 0;
+    MultiRateConfig multi_rate_;
+    MultiRateStats multi_rate_stats_;
+    ObstacleConfig obstacles_;
+    ObstacleStats obstacle_stats_;
+
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    std::minstd_rand rng_;
+    std::unique_ptr<InteractionBackend> interaction_;
+    std::size_t thread_count_ = 0;
+    MemoryConfig memory_;
+    std::vector<int> block_nodes_;
+    bool placement_pending_ = false;
+    std::unique_ptr<WorkerPool> pool_;
+};
+
+#endif //SDL_GLEW_TEST_SIMULATION_HPP
@@ -0,0 +1,190 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "simulation_thread.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "SDL_log.h"
+
+#include "snapshot.hpp"
+#include "trace.hpp"
+
+void fill_instances(
+    std::span<Boid const> boids,
+    std::span<std::uint32_t const> ids,
+    std::size_t skin_count,
+    std::vector<InstanceBuffer::Instance> &instances)
+{
+    instances.resize(boids.size());
+    for (std::size_t i = 0; i < boids.size(); ++i) {
+        auto trans = boids[i].transform().matrix;
+        auto &instance = instances[i];
+        std::memcpy(instance.model, trans.data(), sizeof(instance.model));
+        instance.layer = static_cast<GLuint>(ids[i] % skin_count);
+    }
+}
+
+SimulationThread::SimulationThread(
+    Simulation simulation,
+    std::size_t skin_count,
+    std::chrono::nanoseconds tick,
+    SimulationOutputs outputs
+):
+    simulation_(std::move(simulation)),
+    skin_count_(skin_count),
+    tick_(tick),
+    outputs_(std::move(outputs))
+{
+    thread_ = std::jthread([this](std::stop_token stop) { run(std::move(stop)); });
+}
+
+SimulationThread::~SimulationThread() noexcept {
+    thread_.request_stop();
+    thread_.join();
+}
+
+void SimulationThread::request_boid_count(std::size_t count) noexcept {
+    requested_count_.store(count, std::memory_order_relaxed);
+}
+
+void SimulationThread::request_snapshot(std::string path) {
+    std::scoped_lock lock(snapshot_mutex_);
+    snapshot_path_ = std::move(path);
+    snapshot_requested_.store(true, std::memory_order_release);
+}
+
+void SimulationThread::request_quality(QualityKnobs const &knobs) {
+    std::scoped_lock lock(quality_mutex_);
+    quality_ = knobs;
+    quality_requested_.store(true, std::memory_order_release);
+}
+
+bool SimulationThread::acquire_latest_frame() {
+    if (failed_.load(std::memory_order_acquire)) {
+        std::rethrow_exception(error_);
+    }
+    return frames_.acquire();
+}
+
+bool SimulationThread::has_frame() const noexcept {
+    return frames_.has_front();
+}
+
+SimulationFrame const &SimulationThread::latest_frame() const noexcept {
+    return frames_.front();
+}
+
+void SimulationThread::run(std::stop_token stop) {
+    TRACE_THREAD_NAME("simulation");
+    try {
+        simulate(std::move(stop));
+    } catch (...) {
+        // Stepping stops; the render thread rethrows this on its next acquire.
+        error_ = std::current_exception();
+        failed_.store(true, std::memory_order_release);
+    }
+}
+
+void SimulationThread::simulate(std::stop_token stop) {
+    using clock = std::chrono::steady_clock;
+
+    publish_frame(0, 0, {});
+    export_step(0);
+    auto next_tick = clock::now();
+    for (std::uint64_t step = 1; !stop.stop_requested(); ++step) {
+        if (auto count = requested_count_.exchange(NO_REQUEST, std::memory_order_relaxed); count != NO_REQUEST) {
+            TRACE_SCOPE("resize_flock", "sim");
+            simulation_.resize(count);
+        }
+        if (quality_requested_.load(std::memory_order_acquire)) {
+            apply_requested_quality();
+        }
+
+        // Per-step miss rates only go to the trace; frames carry the totals.
+#ifdef BOIDS_ENABLE_TRACE
+        auto counts_before = simulation_.cache_counts();
+#endif
+        auto start = clock::now();
+        simulation_.step();
+        std::chrono::duration<double, std::milli> step_time = clock::now() - start;
+        auto cache_counts = simulation_.cache_counts();
+#ifdef BOIDS_ENABLE_TRACE
+        TRACE_COUNTER("cache_miss_rate", (cache_counts - counts_before).miss_rate());
+#endif
+        publish_frame(step, step_time.count(), cache_counts);
+        export_step(step);
+        if (snapshot_requested_.load(std::memory_order_acquire)) {
+            save_requested_snapshot(step);
+        }
+
+        next_tick += tick_ * sub_rate_;
+        auto now = clock::now();
+        if (now > next_tick + tick_) {
+            // Too far behind to catch up; drop the missed ticks instead of bursting.
+            next_tick = now;
+        }
+        std::this_thread::sleep_until(next_tick);
+    }
+}
+
+void SimulationThread::publish_frame(std::uint64_t step, double step_ms, CacheCounters::Sample cache_counts) {
+    TRACE_SCOPE("publish_frame", "sim");
+    auto boids = simulation_.boids();
+    auto ids = simulation_.ids();
+    auto &frame = frames_.back();
+    frame.step = step;
+    frame.step_ms = step_ms;
+    frame.cache_counts = cache_counts;
+    frame.page_faults = process_page_faults();
+    TRACE_COUNTER("minor_page_faults", static_cast<double>(frame.page_faults.minor));
+    fill_instances(boids, ids, skin_count_, frame.instances);
+    frames_.publish();
+}
+
+void SimulationThread::export_step(std::uint64_t step) {
+    auto boids = simulation_.boids();
+    auto ids = simulation_.ids();
+    if (outputs_.recorder) {
+        outputs_.recorder->record(step, boids, ids);
+    }
+    if (outputs_.shared_memory) {
+        outputs_.shared_memory->publish(step, boids, ids);
+    }
+    if (outputs_.stream) {
+        outputs_.stream->publish(step, boids, ids);
+    }
+}
+
+void SimulationThread::save_requested_snapshot(std::uint64_t step) {
+    TRACE_SCOPE("save_snapshot", "sim");
+    std::string path;
+    {
+        std::scoped_lock lock(snapshot_mutex_);
+        path = std::move(snapshot_path_);
+        snapshot_requested_.store(false, std::memory_order_relaxed);
+    }
+    try {
+        Snapshot::write(path.c_str(), simulation_, step);
+        SDL_Log("Saved snapshot of step %llu to %s", static_cast<unsigned long long>(step), path.c_str());
+    } catch (std::runtime_error const &err) {
+        SDL_Log("%s", err.what());
+    }
+}
+
+void SimulationThread::apply_requested_quality() {
+    TRACE_SCOPE("apply_quality", "sim");
+    QualityKnobs knobs;
+    {
+        std::scoped_lock lock(quality_mutex_);
+        knobs = quality_;
+        quality_requested_.store(false, std::memory_order_relaxed);
+    }
+    simulation_.set_interaction(make_interaction_backend(knobs.interaction, simulation_.bounds()));
+    simulation_.set_multi_rate(knobs.multi_rate);
+    sub_rate_ = std::max<std::size_t>(knobs.sim_sub_rate, 1);
+}
@@ -0,0 +1,116 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SIMULATION_THREAD_HPP
+#define SDL_GLEW_TEST_SIMULATION_THREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "simulation.hpp"
+#include "instance_buffer.hpp"
+#include "triple_buffer.hpp"
+#include "replay.hpp"
+#include "shared_flock_writer.hpp"
+#include "stream_server.hpp"
+#include "quality_controller.hpp"
+
+// Everything the renderer needs from one completed simulation step.
+struct SimulationFrame {
+    std::vector<InstanceBuffer::Instance> instances;
+    std::uint64_t step = 0;
+    double step_ms = 0;
+    // Cache events on the simulation threads since the simulation started.
+    CacheCounters::Sample cache_counts;
+    // Page faults of the whole process so far.
+    PageFaults page_faults;
+};
+
+// Model matrices of the boids, with skins assigned round-robin by id.
+void fill_instances(
+    std::span<Boid const> boids,
+    std::span<std::uint32_t const> ids,
+    std::size_t skin_count,
+    std::vector<InstanceBuffer::Instance> &instances);
+
+// Optional consumers of the state after every step.
+struct SimulationOutputs {
+    std::unique_ptr<ReplayRecorder> recorder;
+    std::unique_ptr<SharedFlockWriter> shared_memory;
+    std::unique_ptr<StreamServer> stream;
+};
+
+// Steps a Simulation at a fixed rate on its own thread, so that simulating the
+// next step overlaps with rendering the previous one. Every step, including the
+// initial state, is also handed to each of the outputs.
+class SimulationThread {
+public:
+    SimulationThread(
+        Simulation simulation,
+        std::size_t skin_count,
+        std::chrono::nanoseconds tick,
+        SimulationOutputs outputs = {});
+    ~SimulationThread() noexcept;
+
+    SimulationThread(SimulationThread const &other) = delete;
+    SimulationThread(SimulationThread &&other) = delete;
+    SimulationThread &operator=(SimulationThread const &other) = delete;
+    SimulationThread &operator=(SimulationThread &&other) = delete;
+
+    // Applied before the next step; later requests replace earlier pending ones.
+    void request_boid_count(std::size_t count) noexcept;
+    // Saves a snapshot after the next step. Errors are logged, not thrown.
+    void request_snapshot(std::string path);
+    // Switches interaction, multi-rate updates and step rate before the next step.
+    void request_quality(QualityKnobs const &knobs);
+
+    // Render thread only. Returns whether a newer frame became available, or
+    // rethrows the error that stopped the simulation thread.
+    bool acquire_latest_frame();
+    [[nodiscard]] bool has_frame() const noexcept;
+    [[nodiscard]] SimulationFrame const &latest_frame() const noexcept;
+
+private:
+    void run(std::stop_token stop);
+    void simulate(std::stop_token stop);
+    void publish_frame(std::uint64_t step, double step_ms, CacheCounters::Sample cache_counts);
+    void save_requested_snapshot(std::uint64_t step);
+    void export_step(std::uint64_t step);
+    void apply_requested_quality();
+
+    static constexpr std::size_t NO_REQUEST = static_cast<std::size_t>(-1);
+
+    Simulation simulation_;
+    std::size_t skin_count_;
+    std::chrono::nanoseconds tick_;
+    TripleBuffer<SimulationFrame> frames_;
+    std::atomic<std::size_t> requested_count_ = NO_REQUEST;
+    SimulationOutputs outputs_;
+
+    std::mutex snapshot_mutex_;
+    std::string snapshot_path_;
+    std::atomic<bool> snapshot_requested_ = false;
+
+    std::mutex quality_mutex_;
+    QualityKnobs quality_;
+    std::atomic<bool> quality_requested_ = false;
+    std::size_t sub_rate_ = 1;
+
+    // Set once by the simulation thread before it gives up.
+    std::exception_ptr error_;
+    std::atomic<bool> failed_ = false;
+
+    std::jthread thread_;
+};
+
+#endif //SDL_GLEW_TEST_SIMULATION_THREAD_HPP
@@ -0,0 +1,157 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "snapshot.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+constexpr char SNAPSHOT_MAGIC[4] = {'B', 'S', 'N', 'P'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+constexpr std::size_t SNAPSHOT_ALIGNMENT = 64;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t boid_count;
+    std::uint64_t step;
+    float mindset[5];
+    float bounds_min[3];
+    float bounds_max[3];
+    std::uint64_t component_offsets[Snapshot::COMPONENT_COUNT];
+};
+
+static std::size_t align_up(std::size_t n) noexcept {
+    return (n + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+static GLfloat component_of(Boid const &boid, int component) noexcept {
+    return (component < 3) ? boid.pos[component] : boid.velocity[component - 3];
+}
+
+Snapshot::Snapshot(char const *path):
+    file_(path)
+{
+    auto bytes = file_.bytes();
+    SnapshotHeader header;
+    if (bytes.size() < sizeof(header)) {
+        throw std::runtime_error(std::format("Snapshot '{}' is truncated", path));
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::runtime_error(std::format("'{}' is not a snapshot", path));
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error(std::format("Snapshot '{}' has unsupported version {}", path, header.version));
+    }
+
+    step_ = header.step;
+    mindset_ = {
+        .obstacle_avoiding_bias = header.mindset[0],
+        .centering_bias = header.mindset[1],
+        .conforming_bias = header.mindset[2],
+        .maximum_movement = header.mindset[3],
+        .geometry_avoiding_bias = header.mindset[4],
+    };
+    bounds_ = {
+        .min = {{header.bounds_min[0], header.bounds_min[1], header.bounds_min[2]}},
+        .max = {{header.bounds_max[0], header.bounds_max[1], header.bounds_max[2]}},
+    };
+    // Checked before multiplying, so that a corrupt count cannot wrap the block size.
+    if (header.boid_count > bytes.size() / sizeof(GLfloat)) {
+        throw std::runtime_error(std::format("Snapshot '{}' is truncated", path));
+    }
+    boid_count_ = header.boid_count;
+
+    auto block_bytes = boid_count_ * sizeof(GLfloat);
+    for (int c = 0; c < COMPONENT_COUNT; ++c) {
+        auto offset = header.component_offsets[c];
+        if (offset % alignof(GLfloat) != 0 || offset > bytes.size() || bytes.size() - offset < block_bytes) {
+            throw std::runtime_error(std::format("Snapshot '{}' is truncated", path));
+        }
+        components_[c] = {reinterpret_cast<GLfloat const *>(bytes.data() + offset), boid_count_};
+    }
+}
+
+void Snapshot::write(char const *path, Simulation const &simulation, std::uint64_t step) {
+    auto boids = simulation.boids();
+    auto mindset = simulation.mindset();
+    auto const &bounds = simulation.bounds();
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.boid_count = boids.size();
+    header.step = step;
+    float mindset_values[5] = {mindset.obstacle_avoiding_bias, mindset.centering_bias, mindset.conforming_bias, mindset.maximum_movement,
+                               mindset.geometry_avoiding_bias};
+    std::memcpy(header.mindset, mindset_values, sizeof(mindset_values));
+    for (int i = 0; i < 3; ++i) {
+        header.bounds_min[i] = bounds.min[i];
+        header.bounds_max[i] = bounds.max[i];
+    }
+    auto block_bytes = align_up(boids.size() * sizeof(GLfloat));
+    for (int c = 0; c < COMPONENT_COUNT; ++c) {
+        header.component_offsets[c] = align_up(sizeof(header)) + c * block_bytes;
+    }
+
+    std::vector<std::byte> bytes(align_up(sizeof(header)) + COMPONENT_COUNT * block_bytes);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    for (int c = 0; c < COMPONENT_COUNT; ++c) {
+        auto *block = reinterpret_cast<GLfloat *>(bytes.data() + header.component_offsets[c]);
+        for (std::uint32_t id = 0; id < boids.size(); ++id) {
+            block[id] = component_of(boids[simulation.slot_of(id)], c);
+        }
+    }
+
+    FILE *file;
+    if (fopen_s(&file, path, "wb") != 0) {
+        throw std::runtime_error(std::format("Could not open snapshot '{}' for writing", path));
+    }
+    auto written = fwrite(bytes.data(), 1, bytes.size(), file);
+    bool ok = fclose(file) == 0 && written == bytes.size();
+    if (!ok) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        throw std::runtime_error(std::format("Error writing snapshot '{}'", path));
+    }
+}
+
+std::uint64_t Snapshot::step() const noexcept {
+    return step_;
+}
+
+Boid::Mindset Snapshot::mindset() const noexcept {
+    return mindset_;
+}
+
+WorldBounds Snapshot::bounds() const noexcept {
+    return bounds_;
+}
+
+std::size_t Snapshot::boid_count() const noexcept {
+    return boid_count_;
+}
+
+std::span<GLfloat const> Snapshot::component(Component component) const noexcept {
+    return components_[component];
+}
+
+Boid Snapshot::boid(std::size_t id) const noexcept {
+    return {
+        .pos = {{components_[PosX][id], components_[PosY][id], components_[PosZ][id]}},
+        .velocity = {{components_[VelX][id], components_[VelY][id], components_[VelZ][id]}},
+    };
+}
+
+std::vector<Boid> Snapshot::boids() const {
+    std::vector<Boid> ret(boid_count_);
+    for (std::size_t i = 0; i < boid_count_; ++i) {
+        ret[i] = boid(i);
+    }
+    return ret;
+}
@@ -0,0 +1,52 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_SNAPSHOT_HPP
+#define SDL_GLEW_TEST_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "GL/glew.h"
+#include "boid.hpp"
+#include "mapped_file.hpp"
+#include "simulation.hpp"
+
+// Complete flock state in a file that can be memory-mapped back: a versioned
+// header with the mindset and world bounds, followed by six cache-line-aligned
+// blocks of floats (position x, y, z, then velocity x, y, z) in stable id order.
+class Snapshot {
+public:
+    enum Component {
+        PosX, PosY, PosZ,
+        VelX, VelY, VelZ,
+        COMPONENT_COUNT,
+    };
+
+    explicit Snapshot(char const *path);
+
+    static void write(char const *path, Simulation const &simulation, std::uint64_t step);
+
+    [[nodiscard]] std::uint64_t step() const noexcept;
+    [[nodiscard]] Boid::Mindset mindset() const noexcept;
+    [[nodiscard]] WorldBounds bounds() const noexcept;
+    [[nodiscard]] std::size_t boid_count() const noexcept;
+    [[nodiscard]] std::span<GLfloat const> component(Component component) const noexcept;
+
+    [[nodiscard]] Boid boid(std::size_t id) const noexcept;
+    // Boids in id order.
+    [[nodiscard]] std::vector<Boid> boids() const;
+
+private:
+    MappedFile file_;
+    std::uint64_t step_;
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    std::size_t boid_count_;
+    std::span<GLfloat const> components_[COMPONENT_COUNT];
+};
+
+#endif //SDL_GLEW_TEST_SNAPSHOT_HPP
@@ -0,0 +1,166 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "stream_client.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include "trace.hpp"
+
+constexpr auto HELLO_TIMEOUT = std::chrono::seconds(5);
+
+StreamClient::StreamClient(std::string const &host, std::uint16_t port, StreamView view):
+    connection_(TcpSocket::connect(host, port))
+{
+    auto deadline = std::chrono::steady_clock::now() + HELLO_TIMEOUT;
+    while (!quantizer_) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error(std::format("No greeting from stream server {}:{}", host, port));
+        }
+        connection_.socket().wait_readable(std::chrono::milliseconds(100));
+        auto message = connection_.next_message();
+        if (!message) {
+            continue;
+        }
+        StreamHello hello;
+        if (message->type != StreamMessage::Hello || message->payload.size() != sizeof(hello)) {
+            throw std::runtime_error(std::format("{}:{} is not a stream server", host, port));
+        }
+        std::memcpy(&hello, message->payload.data(), sizeof(hello));
+        mindset_ = {
+            .obstacle_avoiding_bias = hello.mindset[0],
+            .centering_bias = hello.mindset[1],
+            .conforming_bias = hello.mindset[2],
+            .maximum_movement = hello.mindset[3],
+            .geometry_avoiding_bias = hello.mindset[4],
+        };
+        bounds_ = {
+            .min = {{hello.bounds_min[0], hello.bounds_min[1], hello.bounds_min[2]}},
+            .max = {{hello.bounds_max[0], hello.bounds_max[1], hello.bounds_max[2]}},
+        };
+        quantizer_.emplace(mindset_, bounds_, hello.velocity_levels);
+    }
+    set_view(view);
+}
+
+bool StreamClient::poll() {
+    bool decoded = false;
+    while (auto message = connection_.next_message()) {
+        bytes_received_ += message->payload.size();
+        if (message->type != StreamMessage::Frame) {
+            throw std::runtime_error("Unexpected message from stream server");
+        }
+        decode(message->payload);
+        decoded = true;
+    }
+    connection_.flush();
+    if (decoded) {
+        auto const &latest = history_.back();
+        boids_.resize(latest.boids.size());
+        for (std::size_t k = 0; k < latest.boids.size(); ++k) {
+            boids_[k] = quantizer_->unpack(latest.boids[k]);
+        }
+    }
+    return decoded;
+}
+
+void StreamClient::set_view(StreamView view) {
+    connection_.queue(StreamMessage::View, view);
+    connection_.flush();
+}
+
+void StreamClient::decode(std::span<std::byte const> payload) {
+    TRACE_SCOPE("stream_decode", "stream");
+    StreamFrameHeader header;
+    if (payload.size() < sizeof(header)) {
+        throw std::runtime_error("Truncated stream frame");
+    }
+    std::memcpy(&header, payload.data(), sizeof(header));
+
+    DecodedFrame const *baseline = nullptr;
+    if (header.baseline != 0) {
+        for (auto const &frame : history_) {
+            if (frame.frame == header.baseline) {
+                baseline = &frame;
+            }
+        }
+        if (!baseline) {
+            throw std::runtime_error("Stream frame refers to a frame no longer kept");
+        }
+    }
+
+    DecodedFrame frame;
+    frame.frame = header.frame;
+    frame.step = header.step;
+    frame.ids.resize(header.boid_count);
+    frame.boids.resize(header.boid_count);
+    auto const *p = reinterpret_cast<std::uint8_t const *>(payload.data()) + sizeof(header);
+    auto const *end = reinterpret_cast<std::uint8_t const *>(payload.data()) + payload.size();
+    std::uint32_t next_id = 0;
+    for (auto &id : frame.ids) {
+        std::uint32_t gap;
+        p = read_varint(p, end, gap);
+        id = next_id + gap;
+        next_id = id + 1;
+    }
+
+    std::size_t b = 0;
+    auto steps = baseline ? header.step - header.baseline_step : 0;
+    for (std::size_t k = 0; k < frame.ids.size(); ++k) {
+        while (baseline && b < baseline->ids.size() && baseline->ids[b] < frame.ids[k]) {
+            ++b;
+        }
+        QuantizedBoid reference = {};
+        bool predicted = baseline && b < baseline->ids.size() && baseline->ids[b] == frame.ids[k];
+        if (predicted) {
+            reference = baseline->boids[b];
+        }
+        auto &boid = frame.boids[k];
+        for (int i = 0; i < 3; ++i) {
+            auto pos = predicted ? quantizer_->predict(reference.pos[i], reference.velocity[i], i, steps) : std::uint16_t{0};
+            std::uint32_t velocity_residual, pos_residual;
+            p = read_varint(p, end, velocity_residual);
+            p = read_varint(p, end, pos_residual);
+            boid.velocity[i] = static_cast<std::int16_t>(reference.velocity[i] + unzigzag(velocity_residual));
+            boid.pos[i] = static_cast<std::uint16_t>(pos + unzigzag(pos_residual));
+        }
+    }
+
+    history_.push_back(std::move(frame));
+    // The server only codes against frames at or after the last acknowledged one.
+    while (history_.size() > HISTORY_FRAMES) {
+        history_.pop_front();
+    }
+    connection_.queue(StreamMessage::Ack, StreamAck{header.frame});
+}
+
+Boid::Mindset StreamClient::mindset() const noexcept {
+    return mindset_;
+}
+
+WorldBounds const &StreamClient::bounds() const noexcept {
+    return bounds_;
+}
+
+std::uint64_t StreamClient::step() const noexcept {
+    return history_.empty() ? 0 : history_.back().step;
+}
+
+std::span<Boid const> StreamClient::boids() const noexcept {
+    return boids_;
+}
+
+std::span<std::uint32_t const> StreamClient::ids() const noexcept {
+    if (history_.empty()) {
+        return {};
+    }
+    return history_.back().ids;
+}
+
+std::uint64_t StreamClient::bytes_received() const noexcept {
+    return bytes_received_;
+}
@@ -0,0 +1,62 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_STREAM_CLIENT_HPP
+#define SDL_GLEW_TEST_STREAM_CLIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "boid.hpp"
+#include "simulation.hpp"
+#include "flock_codec.hpp"
+#include "stream_protocol.hpp"
+
+// Receives the flock a StreamServer streams, decoding each frame against the
+// earlier frame it was coded from and acknowledging it in turn.
+class StreamClient {
+public:
+    // Connects, waits for the server's greeting, and asks for the boids inside the view box.
+    StreamClient(std::string const &host, std::uint16_t port, StreamView view);
+
+    // Decodes whatever has arrived. Returns whether there is a newer frame.
+    bool poll();
+    void set_view(StreamView view);
+
+    [[nodiscard]] Boid::Mindset mindset() const noexcept;
+    [[nodiscard]] WorldBounds const &bounds() const noexcept;
+
+    [[nodiscard]] std::uint64_t step() const noexcept;
+    // Boids in view in the latest frame, by ascending id.
+    [[nodiscard]] std::span<Boid const> boids() const noexcept;
+    [[nodiscard]] std::span<std::uint32_t const> ids() const noexcept;
+    [[nodiscard]] std::uint64_t bytes_received() const noexcept;
+
+private:
+    struct DecodedFrame {
+        std::uint64_t frame;
+        std::uint64_t step;
+        std::vector<std::uint32_t> ids;
+        std::vector<QuantizedBoid> boids;
+    };
+
+    static constexpr std::size_t HISTORY_FRAMES = 16;
+
+    void decode(std::span<std::byte const> payload);
+
+    StreamConnection connection_;
+    Boid::Mindset mindset_;
+    WorldBounds bounds_;
+    std::optional<FlockQuantizer> quantizer_;
+    std::deque<DecodedFrame> history_;
+    std::vector<Boid> boids_;
+    std::uint64_t bytes_received_ = 0;
+};
+
+#endif //SDL_GLEW_TEST_STREAM_CLIENT_HPP
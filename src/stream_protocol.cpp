@@ -0,0 +1,71 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "stream_protocol.hpp"
+
+#include <cstring>
+#include <utility>
+
+StreamConnection::StreamConnection(TcpSocket socket) noexcept:
+    socket_(std::move(socket))
+{}
+
+void StreamConnection::queue(StreamMessage type, std::span<std::byte const> payload) {
+    auto length = static_cast<std::uint32_t>(payload.size());
+    auto start = outbox_.size();
+    outbox_.resize(start + HEADER_BYTES + payload.size());
+    std::memcpy(outbox_.data() + start, &length, sizeof(length));
+    outbox_[start + 4] = static_cast<std::byte>(type);
+    std::memcpy(outbox_.data() + start + HEADER_BYTES, payload.data(), payload.size());
+}
+
+bool StreamConnection::flush() {
+    while (outbox_sent_ < outbox_.size()) {
+        auto sent = socket_.send(std::span(outbox_).subspan(outbox_sent_));
+        if (sent == 0) {
+            return false;
+        }
+        outbox_sent_ += sent;
+    }
+    outbox_.clear();
+    outbox_sent_ = 0;
+    return true;
+}
+
+std::size_t StreamConnection::queued_bytes() const noexcept {
+    return outbox_.size() - outbox_sent_;
+}
+
+std::optional<StreamConnection::Message> StreamConnection::next_message() {
+    // Drop what earlier messages used up before receiving more.
+    if (inbox_consumed_ != 0) {
+        inbox_.erase(inbox_.begin(), inbox_.begin() + static_cast<std::ptrdiff_t>(inbox_consumed_));
+        inbox_consumed_ = 0;
+    }
+    for (;;) {
+        if (inbox_.size() >= HEADER_BYTES) {
+            std::uint32_t length;
+            std::memcpy(&length, inbox_.data(), sizeof(length));
+            if (inbox_.size() >= HEADER_BYTES + length) {
+                inbox_consumed_ = HEADER_BYTES + length;
+                return Message{
+                    static_cast<StreamMessage>(inbox_[4]),
+                    std::span(inbox_).subspan(HEADER_BYTES, length),
+                };
+            }
+        }
+        constexpr std::size_t chunk = 64 * 1024;
+        auto start = inbox_.size();
+        inbox_.resize(start + chunk);
+        auto received = socket_.receive(std::span(inbox_).subspan(start));
+        inbox_.resize(start + received);
+        if (received == 0) {
+            return std::nullopt;
+        }
+    }
+}
+
+TcpSocket const &StreamConnection::socket() const noexcept {
+    return socket_;
+}
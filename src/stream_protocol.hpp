@@ -0,0 +1,99 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_STREAM_PROTOCOL_HPP
+#define SDL_GLEW_TEST_STREAM_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "tcp_socket.hpp"
+
+// Messages between StreamServer and StreamClient. Each is a 32-bit payload
+// length, a type byte and the payload; all integers are little-endian.
+//
+//   Hello  server -> client  StreamHello, once on connecting
+//   Frame  server -> client  StreamFrameHeader, then varints: the ids in view as
+//                            gaps from the previous id, then per boid and axis
+//                            the velocity and position residuals
+//   View   client -> server  StreamView, the box the client wants boids from
+//   Ack    client -> server  StreamAck, a frame the client has decoded
+//
+// A frame is coded against the baseline frame the client last acknowledged, if
+// the server still has it: boids present in the baseline are predicted from
+// their baseline position and velocity, others are coded against zero.
+enum class StreamMessage : std::uint8_t {
+    Hello = 1,
+    Frame = 2,
+    View = 3,
+    Ack = 4,
+};
+
+struct StreamHello {
+    // As Boid::Mindset, in declaration order.
+    float mindset[5];
+    float bounds_min[3];
+    float bounds_max[3];
+    // Of FlockQuantizer; velocities only orient boids on screen, so they are sent coarsely.
+    std::int32_t velocity_levels;
+};
+
+struct StreamFrameHeader {
+    std::uint64_t frame;
+    // Zero for none.
+    std::uint64_t baseline;
+    std::uint64_t step;
+    std::uint64_t baseline_step;
+    std::uint32_t boid_count;
+    std::uint32_t reserved;
+};
+
+struct StreamView {
+    float min[3];
+    float max[3];
+};
+
+struct StreamAck {
+    std::uint64_t frame;
+};
+
+// Message framing over a non-blocking socket, with buffering in both directions.
+class StreamConnection {
+public:
+    struct Message {
+        StreamMessage type;
+        std::span<std::byte const> payload;
+    };
+
+    explicit StreamConnection(TcpSocket socket) noexcept;
+
+    void queue(StreamMessage type, std::span<std::byte const> payload);
+    template<typename T>
+    void queue(StreamMessage type, T const &payload) {
+        queue(type, std::as_bytes(std::span(&payload, 1)));
+    }
+    // Sends as much queued data as the socket takes; returns whether all of it went.
+    bool flush();
+    [[nodiscard]] std::size_t queued_bytes() const noexcept;
+
+    // Receives what has arrived and returns the next complete message. The payload
+    // stays valid until the next call.
+    [[nodiscard]] std::optional<Message> next_message();
+
+    [[nodiscard]] TcpSocket const &socket() const noexcept;
+
+private:
+    static constexpr std::size_t HEADER_BYTES = 5;
+
+    TcpSocket socket_;
+    std::vector<std::byte> outbox_;
+    std::size_t outbox_sent_ = 0;
+    std::vector<std::byte> inbox_;
+    std::size_t inbox_consumed_ = 0;
+};
+
+#endif //SDL_GLEW_TEST_STREAM_PROTOCOL_HPP
@@ -0,0 +1,206 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "stream_server.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "SDL_log.h"
+
+#include "trace.hpp"
+
+// Burst a client may accumulate, in seconds of its bandwidth.
+constexpr double MAX_BURST_SECONDS = 0.25;
+
+StreamServer::Client::Client(StreamConnection connection) noexcept:
+    connection(std::move(connection)),
+    budget_updated(Clock::now())
+{}
+
+StreamServer::StreamServer(std::uint16_t port, Boid::Mindset mindset, WorldBounds bounds, double megabits_per_second):
+    quantizer_(mindset, bounds, VELOCITY_LEVELS),
+    bytes_per_second_(megabits_per_second * 1e6 / 8),
+    listener_(TcpSocket::listen(port))
+{
+    float mindset_values[5] = {mindset.obstacle_avoiding_bias, mindset.centering_bias, mindset.conforming_bias, mindset.maximum_movement,
+                               mindset.geometry_avoiding_bias};
+    std::memcpy(hello_.mindset, mindset_values, sizeof(mindset_values));
+    for (int i = 0; i < 3; ++i) {
+        hello_.bounds_min[i] = bounds.min[i];
+        hello_.bounds_max[i] = bounds.max[i];
+    }
+    hello_.velocity_levels = VELOCITY_LEVELS;
+    SDL_Log("Streaming flock state on port %u, %.1f Mbit/s per client", static_cast<unsigned>(port), megabits_per_second);
+    thread_ = std::jthread([this](std::stop_token stop) { serve(std::move(stop)); });
+}
+
+StreamServer::~StreamServer() noexcept {
+    thread_.request_stop();
+    thread_.join();
+}
+
+void StreamServer::publish(std::uint64_t step, std::span<Boid const> boids, std::span<std::uint32_t const> ids) {
+    TRACE_SCOPE("stream_publish", "sim");
+    auto &frame = frames_.back();
+    frame.step = step;
+    frame.boids.assign(boids.begin(), boids.end());
+    frame.ids.assign(ids.begin(), ids.end());
+    frames_.publish();
+}
+
+void StreamServer::serve(std::stop_token stop) {
+    TRACE_THREAD_NAME("stream_server");
+    while (!stop.stop_requested()) {
+        listener_.wait_readable(std::chrono::milliseconds(2));
+        accept_clients();
+        take_latest_frame();
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            try {
+                receive_messages(*it);
+                send_frame(*it);
+                it->connection.flush();
+                ++it;
+            } catch (std::runtime_error const &err) {
+                SDL_Log("Stream client dropped: %s", err.what());
+                it = clients_.erase(it);
+            }
+        }
+    }
+}
+
+void StreamServer::accept_clients() {
+    while (auto socket = listener_.accept()) {
+        auto &client = clients_.emplace_back(StreamConnection(std::move(*socket)));
+        // Everything, until the client says otherwise.
+        std::memcpy(client.view.min, hello_.bounds_min, sizeof(client.view.min));
+        std::memcpy(client.view.max, hello_.bounds_max, sizeof(client.view.max));
+        client.connection.queue(StreamMessage::Hello, hello_);
+        SDL_Log("Stream client connected (%zu total)", clients_.size());
+    }
+}
+
+void StreamServer::receive_messages(Client &client) {
+    while (auto message = client.connection.next_message()) {
+        switch (message->type) {
+            case StreamMessage::View: {
+                if (message->payload.size() == sizeof(StreamView)) {
+                    std::memcpy(&client.view, message->payload.data(), sizeof(StreamView));
+                }
+                break;
+            }
+            case StreamMessage::Ack: {
+                StreamAck ack;
+                if (message->payload.size() == sizeof(ack)) {
+                    std::memcpy(&ack, message->payload.data(), sizeof(ack));
+                    client.acked = std::max(client.acked, ack.frame);
+                }
+                break;
+            }
+            default: {
+                throw std::runtime_error("unexpected message from client");
+            }
+        }
+    }
+    // Frames older than the acknowledged one will never be a baseline again.
+    while (!client.history.empty() && client.history.front().frame < client.acked) {
+        client.history.pop_front();
+    }
+}
+
+void StreamServer::take_latest_frame() {
+    if (!frames_.acquire()) {
+        return;
+    }
+    TRACE_SCOPE("stream_quantize", "stream");
+    auto const &frame = frames_.front();
+    ++frame_number_;
+    step_ = frame.step;
+    positions_.resize(frame.boids.size());
+    quantized_.resize(frame.boids.size());
+    for (std::size_t slot = 0; slot < frame.boids.size(); ++slot) {
+        auto id = frame.ids[slot];
+        positions_[id] = frame.boids[slot].pos;
+        quantized_[id] = quantizer_.quantize(frame.boids[slot]);
+    }
+}
+
+void StreamServer::send_frame(Client &client) {
+    auto now = Clock::now();
+    std::chrono::duration<double> elapsed = now - client.budget_updated;
+    client.budget_updated = now;
+    client.budget_bytes = std::min(client.budget_bytes + elapsed.count() * bytes_per_second_, MAX_BURST_SECONDS * bytes_per_second_);
+    // Nothing new, out of budget, or the previous frame is still on its way.
+    if (client.last_sent == frame_number_ || client.budget_bytes < 0 || client.connection.queued_bytes() != 0) {
+        return;
+    }
+    TRACE_SCOPE("stream_encode", "stream");
+
+    SentFrame const *baseline = nullptr;
+    for (auto const &sent : client.history) {
+        if (sent.frame == client.acked) {
+            baseline = &sent;
+        }
+    }
+
+    SentFrame sent;
+    sent.frame = frame_number_;
+    sent.step = step_;
+    auto const &view = client.view;
+    for (std::uint32_t id = 0; id < positions_.size(); ++id) {
+        auto const &pos = positions_[id];
+        bool inside = true;
+        for (int i = 0; i < 3; ++i) {
+            inside = inside && pos[i] >= view.min[i] && pos[i] <= view.max[i];
+        }
+        if (inside) {
+            sent.ids.push_back(id);
+            sent.boids.push_back(quantized_[id]);
+        }
+    }
+
+    StreamFrameHeader header = {
+        .frame = sent.frame,
+        .baseline = baseline ? baseline->frame : 0,
+        .step = sent.step,
+        .baseline_step = baseline ? baseline->step : 0,
+        .boid_count = static_cast<std::uint32_t>(sent.ids.size()),
+        .reserved = 0,
+    };
+    payload_.resize(sizeof(header));
+    std::memcpy(payload_.data(), &header, sizeof(header));
+    std::uint32_t next_id = 0;
+    for (auto id : sent.ids) {
+        write_varint(payload_, id - next_id);
+        next_id = id + 1;
+    }
+    std::size_t b = 0;
+    auto steps = baseline ? sent.step - baseline->step : 0;
+    for (std::size_t k = 0; k < sent.ids.size(); ++k) {
+        while (baseline && b < baseline->ids.size() && baseline->ids[b] < sent.ids[k]) {
+            ++b;
+        }
+        QuantizedBoid reference = {};
+        bool predicted = baseline && b < baseline->ids.size() && baseline->ids[b] == sent.ids[k];
+        if (predicted) {
+            reference = baseline->boids[b];
+        }
+        auto const &boid = sent.boids[k];
+        for (int i = 0; i < 3; ++i) {
+            auto pos = predicted ? quantizer_.predict(reference.pos[i], reference.velocity[i], i, steps) : std::uint16_t{0};
+            write_varint(payload_, zigzag(boid.velocity[i] - reference.velocity[i]));
+            write_varint(payload_, zigzag(static_cast<std::int16_t>(boid.pos[i] - pos)));
+        }
+    }
+
+    client.connection.queue(StreamMessage::Frame, std::as_bytes(std::span(payload_)));
+    client.budget_bytes -= static_cast<double>(payload_.size());
+    client.last_sent = sent.frame;
+    client.history.push_back(std::move(sent));
+    if (client.history.size() > HISTORY_FRAMES) {
+        client.history.pop_front();
+    }
+}
@@ -0,0 +1,96 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_STREAM_SERVER_HPP
+#define SDL_GLEW_TEST_STREAM_SERVER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "boid.hpp"
+#include "simulation.hpp"
+#include "flock_codec.hpp"
+#include "stream_protocol.hpp"
+#include "triple_buffer.hpp"
+
+// Streams flock state over TCP to StreamClients, from a thread of its own. Each
+// client only gets the boids inside the box it asked for, quantized and coded
+// against the last frame it acknowledged, and at most `megabits_per_second`:
+// when a client's budget is spent, steps are skipped for it, which the delta
+// coding absorbs.
+class StreamServer {
+public:
+    StreamServer(std::uint16_t port, Boid::Mindset mindset, WorldBounds bounds, double megabits_per_second);
+    ~StreamServer() noexcept;
+
+    StreamServer(StreamServer const &other) = delete;
+    StreamServer(StreamServer &&other) = delete;
+    StreamServer &operator=(StreamServer const &other) = delete;
+    StreamServer &operator=(StreamServer &&other) = delete;
+
+    // Hands over the latest state; never waits for the network.
+    void publish(std::uint64_t step, std::span<Boid const> boids, std::span<std::uint32_t const> ids);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        std::uint64_t step = 0;
+        std::vector<Boid> boids;
+        std::vector<std::uint32_t> ids;
+    };
+
+    // What a client was sent, kept until it can no longer be a baseline.
+    struct SentFrame {
+        std::uint64_t frame;
+        std::uint64_t step;
+        std::vector<std::uint32_t> ids;
+        std::vector<QuantizedBoid> boids;
+    };
+
+    struct Client {
+        explicit Client(StreamConnection connection) noexcept;
+
+        StreamConnection connection;
+        StreamView view = {};
+        std::deque<SentFrame> history;
+        std::uint64_t acked = 0;
+        std::uint64_t last_sent = 0;
+        double budget_bytes = 0;
+        Clock::time_point budget_updated;
+    };
+
+    static constexpr std::size_t HISTORY_FRAMES = 16;
+    static constexpr std::int32_t VELOCITY_LEVELS = 127;
+
+    void serve(std::stop_token stop);
+    void accept_clients();
+    void receive_messages(Client &client);
+    void take_latest_frame();
+    void send_frame(Client &client);
+
+    StreamHello hello_;
+    FlockQuantizer quantizer_;
+    double bytes_per_second_;
+    TcpSocket listener_;
+    std::list<Client> clients_;
+
+    TripleBuffer<Frame> frames_;
+    // Latest frame, by id. Server thread only.
+    std::uint64_t frame_number_ = 0;
+    std::uint64_t step_ = 0;
+    std::vector<Vec3<GLfloat>> positions_;
+    std::vector<QuantizedBoid> quantized_;
+    std::vector<std::uint8_t> payload_;
+
+    std::jthread thread_;
+};
+
+#endif //SDL_GLEW_TEST_STREAM_SERVER_HPP
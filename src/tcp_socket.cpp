@@ -0,0 +1,205 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "tcp_socket.hpp"
+
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef _WIN32
+
+constexpr std::intptr_t NO_SOCKET = static_cast<std::intptr_t>(INVALID_SOCKET);
+
+static void ensure_initialized() {
+    static bool initialized = [] {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+            throw std::runtime_error("Could not initialize Winsock");
+        }
+        return true;
+    }();
+    (void)initialized;
+}
+
+static bool would_block() noexcept {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+static void set_non_blocking(std::intptr_t handle) {
+    u_long enabled = 1;
+    ioctlsocket(static_cast<SOCKET>(handle), FIONBIO, &enabled);
+}
+
+static void close_handle(std::intptr_t handle) noexcept {
+    closesocket(static_cast<SOCKET>(handle));
+}
+
+#else
+
+constexpr std::intptr_t NO_SOCKET = -1;
+
+static void ensure_initialized() {}
+
+static bool would_block() noexcept {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+static void set_non_blocking(std::intptr_t handle) {
+    auto fd = static_cast<int>(handle);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static void close_handle(std::intptr_t handle) noexcept {
+    ::close(static_cast<int>(handle));
+}
+
+#endif
+
+// Frames are small and latency matters more than packet count.
+static void disable_nagle(std::intptr_t handle) noexcept {
+    int enabled = 1;
+    setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const *>(&enabled), sizeof(enabled));
+}
+
+TcpSocket TcpSocket::listen(std::uint16_t port) {
+    ensure_initialized();
+    TcpSocket ret(static_cast<Handle>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)));
+    if (ret.handle_ == NO_SOCKET) {
+        throw std::runtime_error("Could not create socket");
+    }
+    int enabled = 1;
+    setsockopt(ret.handle_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char const *>(&enabled), sizeof(enabled));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(ret.handle_, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) != 0
+        || ::listen(ret.handle_, SOMAXCONN) != 0) {
+        throw std::runtime_error(std::format("Could not listen on port {}", port));
+    }
+    set_non_blocking(ret.handle_);
+    return ret;
+}
+
+TcpSocket TcpSocket::connect(std::string const &host, std::uint16_t port) {
+    ensure_initialized();
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+        throw std::runtime_error(std::format("Could not resolve '{}'", host));
+    }
+    for (auto *address = addresses; address != nullptr; address = address->ai_next) {
+        TcpSocket ret(static_cast<Handle>(socket(address->ai_family, address->ai_socktype, address->ai_protocol)));
+        if (ret.handle_ != NO_SOCKET && ::connect(ret.handle_, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+            freeaddrinfo(addresses);
+            set_non_blocking(ret.handle_);
+            disable_nagle(ret.handle_);
+            return ret;
+        }
+    }
+    freeaddrinfo(addresses);
+    throw std::runtime_error(std::format("Could not connect to {}:{}", host, port));
+}
+
+TcpSocket::TcpSocket(Handle handle) noexcept:
+    handle_(handle)
+{}
+
+TcpSocket::~TcpSocket() noexcept {
+    close();
+}
+
+TcpSocket::TcpSocket(TcpSocket &&other) noexcept:
+    handle_(std::exchange(other.handle_, NO_SOCKET))
+{}
+
+TcpSocket &TcpSocket::operator=(TcpSocket &&other) noexcept {
+    close();
+    handle_ = std::exchange(other.handle_, NO_SOCKET);
+    return *this;
+}
+
+void TcpSocket::close() noexcept {
+    if (handle_ != NO_SOCKET) {
+        close_handle(handle_);
+        handle_ = NO_SOCKET;
+    }
+}
+
+std::optional<TcpSocket> TcpSocket::accept() {
+    auto handle = static_cast<Handle>(::accept(handle_, nullptr, nullptr));
+    if (handle == NO_SOCKET) {
+        if (would_block()) {
+            return std::nullopt;
+        }
+        throw std::runtime_error("Could not accept connection");
+    }
+    set_non_blocking(handle);
+    disable_nagle(handle);
+    return TcpSocket(handle);
+}
+
+std::size_t TcpSocket::send(std::span<std::byte const> data) {
+#ifdef _WIN32
+    auto sent = ::send(handle_, reinterpret_cast<char const *>(data.data()), static_cast<int>(data.size()), 0);
+#else
+    auto sent = ::send(static_cast<int>(handle_), data.data(), data.size(), MSG_NOSIGNAL);
+#endif
+    if (sent < 0) {
+        if (would_block()) {
+            return 0;
+        }
+        throw std::runtime_error("Connection lost while sending");
+    }
+    return static_cast<std::size_t>(sent);
+}
+
+std::size_t TcpSocket::receive(std::span<std::byte> buffer) {
+#ifdef _WIN32
+    auto received = ::recv(handle_, reinterpret_cast<char *>(buffer.data()), static_cast<int>(buffer.size()), 0);
+#else
+    auto received = ::recv(static_cast<int>(handle_), buffer.data(), buffer.size(), 0);
+#endif
+    if (received == 0) {
+        throw std::runtime_error("Connection closed");
+    }
+    if (received < 0) {
+        if (would_block()) {
+            return 0;
+        }
+        throw std::runtime_error("Connection lost while receiving");
+    }
+    return static_cast<std::size_t>(received);
+}
+
+bool TcpSocket::wait_readable(std::chrono::milliseconds timeout) const {
+#ifdef _WIN32
+    WSAPOLLFD descriptor = {static_cast<SOCKET>(handle_), POLLIN, 0};
+    return WSAPoll(&descriptor, 1, static_cast<int>(timeout.count())) > 0;
+#else
+    pollfd descriptor = {static_cast<int>(handle_), POLLIN, 0};
+    return poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0;
+#endif
+}
@@ -0,0 +1,47 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_TCP_SOCKET_HPP
+#define SDL_GLEW_TEST_TCP_SOCKET_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+// Non-blocking TCP socket. Sending and receiving transfer what they can without
+// waiting; a closed connection or socket error is thrown.
+class TcpSocket {
+public:
+    // Accepts connections on every interface.
+    [[nodiscard]] static TcpSocket listen(std::uint16_t port);
+    // Waits for the connection to be established.
+    [[nodiscard]] static TcpSocket connect(std::string const &host, std::uint16_t port);
+
+    ~TcpSocket() noexcept;
+
+    TcpSocket(TcpSocket const &other) = delete;
+    TcpSocket(TcpSocket &&other) noexcept;
+    TcpSocket &operator=(TcpSocket const &other) = delete;
+    TcpSocket &operator=(TcpSocket &&other) noexcept;
+
+    [[nodiscard]] std::optional<TcpSocket> accept();
+    // Both return the number of bytes transferred, zero if the call would block.
+    std::size_t send(std::span<std::byte const> data);
+    std::size_t receive(std::span<std::byte> buffer);
+    // Returns whether data arrived before the timeout.
+    bool wait_readable(std::chrono::milliseconds timeout) const;
+
+private:
+    using Handle = std::intptr_t;
+
+    explicit TcpSocket(Handle handle) noexcept;
+    void close() noexcept;
+
+    Handle handle_;
+};
+
+#endif //SDL_GLEW_TEST_TCP_SOCKET_HPP
@@ -0,0 +1,406 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "texture_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+#include "SDL_surface.h"
+#include "SDL_log.h"
+
+#include "sdl_image_loader.hpp"
+#include "trace.hpp"
+
+constexpr char CACHE_MAGIC[4] = {'B', 'T', 'E', 'X'};
+constexpr std::uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint32_t level_count;
+};
+
+struct CacheLevel {
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+struct Rgba {
+    std::uint8_t r, g, b, a;
+};
+
+class RgbaImage {
+public:
+    int width;
+    int height;
+    std::vector<Rgba> pixels;
+
+    [[nodiscard]] Rgba clamped(int x, int y) const noexcept {
+        return pixels[std::min(y, height - 1) * width + std::min(x, width - 1)];
+    }
+
+    [[nodiscard]] RgbaImage half_size() const {
+        RgbaImage ret{std::max(1, width / 2), std::max(1, height / 2), {}};
+        ret.pixels.reserve(ret.width * ret.height);
+        for (int y = 0; y < ret.height; ++y) {
+            for (int x = 0; x < ret.width; ++x) {
+                Rgba const quad[4] = {
+                    clamped(2*x, 2*y), clamped(2*x + 1, 2*y),
+                    clamped(2*x, 2*y + 1), clamped(2*x + 1, 2*y + 1),
+                };
+                auto average = [&](std::uint8_t Rgba::*channel) {
+                    int sum = 2;
+                    for (auto const &p : quad) {
+                        sum += p.*channel;
+                    }
+                    return static_cast<std::uint8_t>(sum / 4);
+                };
+                ret.pixels.push_back({average(&Rgba::r), average(&Rgba::g), average(&Rgba::b), average(&Rgba::a)});
+            }
+        }
+        return ret;
+    }
+};
+
+static RgbaImage to_rgba_image(SDL_Surface *image) {
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    if (converted == nullptr) {
+        throw std::runtime_error(std::string("Error converting image for texture cache: ") + SDL_GetError());
+    }
+
+    RgbaImage ret{converted->w, converted->h, {}};
+    ret.pixels.resize(ret.width * ret.height);
+    auto const *src = static_cast<unsigned char const *>(converted->pixels);
+    for (int y = 0; y < ret.height; ++y) {
+        std::memcpy(&ret.pixels[y * ret.width], src + y * converted->pitch, ret.width * sizeof(Rgba));
+    }
+    SDL_FreeSurface(converted);
+    return ret;
+}
+
+static std::uint16_t to_rgb565(Rgba c) noexcept {
+    return static_cast<std::uint16_t>(((c.r * 31 + 127) / 255) << 11 | ((c.g * 63 + 127) / 255) << 5 | ((c.b * 31 + 127) / 255));
+}
+
+static Rgba from_rgb565(std::uint16_t c) noexcept {
+    int r = c >> 11 & 31;
+    int g = c >> 5 & 63;
+    int b = c & 31;
+    return {
+        static_cast<std::uint8_t>(r << 3 | r >> 2),
+        static_cast<std::uint8_t>(g << 2 | g >> 4),
+        static_cast<std::uint8_t>(b << 3 | b >> 2),
+        255,
+    };
+}
+
+static int color_distance_sq(Rgba a, Rgba b) noexcept {
+    int dr = a.r - b.r;
+    int dg = a.g - b.g;
+    int db = a.b - b.b;
+    return dr*dr + dg*dg + db*db;
+}
+
+static void put_u16(std::byte *out, std::uint16_t v) noexcept {
+    out[0] = static_cast<std::byte>(v);
+    out[1] = static_cast<std::byte>(v >> 8);
+}
+
+// Endpoints are the corners of the block's color bounding box, always ordered so
+// that the block decodes in four-color mode.
+static void encode_bc1_color(std::array<Rgba, 16> const &block, std::byte *out) noexcept {
+    Rgba lo = block[0];
+    Rgba hi = block[0];
+    for (auto const &p : block) {
+        lo = {std::min(lo.r, p.r), std::min(lo.g, p.g), std::min(lo.b, p.b), 255};
+        hi = {std::max(hi.r, p.r), std::max(hi.g, p.g), std::max(hi.b, p.b), 255};
+    }
+
+    std::uint16_t c0 = to_rgb565(hi);
+    std::uint16_t c1 = to_rgb565(lo);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    std::uint32_t indices = 0;
+    if (c0 != c1) {
+        Rgba e0 = from_rgb565(c0);
+        Rgba e1 = from_rgb565(c1);
+        auto mix = [](std::uint8_t a, std::uint8_t b) { return static_cast<std::uint8_t>((2*a + b) / 3); };
+        Rgba const palette[4] = {
+            e0,
+            e1,
+            {mix(e0.r, e1.r), mix(e0.g, e1.g), mix(e0.b, e1.b), 255},
+            {mix(e1.r, e0.r), mix(e1.g, e0.g), mix(e1.b, e0.b), 255},
+        };
+        for (int i = 0; i < 16; ++i) {
+            std::uint32_t best = 0;
+            for (std::uint32_t j = 1; j < 4; ++j) {
+                if (color_distance_sq(block[i], palette[j]) < color_distance_sq(block[i], palette[best])) {
+                    best = j;
+                }
+            }
+            indices |= best << (2 * i);
+        }
+    }
+
+    put_u16(out, c0);
+    put_u16(out + 2, c1);
+    put_u16(out + 4, static_cast<std::uint16_t>(indices));
+    put_u16(out + 6, static_cast<std::uint16_t>(indices >> 16));
+}
+
+static void encode_bc3_alpha(std::array<Rgba, 16> const &block, std::byte *out) noexcept {
+    std::uint8_t a0 = 0;
+    std::uint8_t a1 = 255;
+    for (auto const &p : block) {
+        a0 = std::max(a0, p.a);
+        a1 = std::min(a1, p.a);
+    }
+
+    std::uint64_t indices = 0;
+    if (a0 != a1) {
+        std::uint8_t palette[8] = {a0, a1};
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = static_cast<std::uint8_t>(((7 - i) * a0 + i * a1) / 7);
+        }
+        for (int i = 0; i < 16; ++i) {
+            std::uint64_t best = 0;
+            for (std::uint64_t j = 1; j < 8; ++j) {
+                if (std::abs(block[i].a - palette[j]) < std::abs(block[i].a - palette[best])) {
+                    best = j;
+                }
+            }
+            indices |= best << (3 * i);
+        }
+    }
+
+    out[0] = static_cast<std::byte>(a0);
+    out[1] = static_cast<std::byte>(a1);
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<std::byte>(indices >> (8 * i));
+    }
+}
+
+static std::size_t block_bytes(TextureCacheFormat format) noexcept {
+    return (format == TextureCacheFormat::Bc1)? 8 : 16;
+}
+
+static std::size_t level_size(TextureCacheFormat format, int width, int height) noexcept {
+    if (format == TextureCacheFormat::Rgba8) {
+        return static_cast<std::size_t>(width) * height * sizeof(Rgba);
+    }
+    return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * block_bytes(format);
+}
+
+static void encode_level(RgbaImage const &image, TextureCacheFormat format, std::byte *out) noexcept {
+    if (format == TextureCacheFormat::Rgba8) {
+        std::memcpy(out, image.pixels.data(), image.pixels.size() * sizeof(Rgba));
+        return;
+    }
+
+    std::array<Rgba, 16> block{};
+    for (int by = 0; by < image.height; by += 4) {
+        for (int bx = 0; bx < image.width; bx += 4) {
+            for (int i = 0; i < 16; ++i) {
+                block[i] = image.clamped(bx + i % 4, by + i / 4);
+            }
+            if (format == TextureCacheFormat::Bc3) {
+                encode_bc3_alpha(block, out);
+                out += 8;
+            }
+            encode_bc1_color(block, out);
+            out += 8;
+        }
+    }
+}
+
+TextureCache::TextureCache(char const *path):
+    file_(std::in_place, path),
+    format_(TextureCacheFormat::Rgba8)
+{
+    bytes_ = file_->bytes();
+    parse();
+}
+
+TextureCache::TextureCache(SDL_Surface *image, bool allow_compression):
+    format_(TextureCacheFormat::Rgba8)
+{
+    std::vector<RgbaImage> mips;
+    mips.push_back(to_rgba_image(image));
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        mips.push_back(mips.back().half_size());
+    }
+
+    TextureCacheFormat format = TextureCacheFormat::Rgba8;
+    if (allow_compression) {
+        bool opaque = std::all_of(mips[0].pixels.begin(), mips[0].pixels.end(), [](Rgba p) { return p.a == 255; });
+        format = opaque? TextureCacheFormat::Bc1 : TextureCacheFormat::Bc3;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.format = static_cast<std::uint32_t>(format);
+    header.level_count = static_cast<std::uint32_t>(mips.size());
+
+    std::vector<CacheLevel> level_table;
+    std::size_t offset = sizeof(CacheHeader) + mips.size() * sizeof(CacheLevel);
+    for (auto const &mip : mips) {
+        auto size = level_size(format, mip.width, mip.height);
+        level_table.push_back({
+            static_cast<std::uint32_t>(mip.width),
+            static_cast<std::uint32_t>(mip.height),
+            offset,
+            size,
+        });
+        offset += size;
+    }
+
+    owned_.resize(offset);
+    std::memcpy(owned_.data(), &header, sizeof(header));
+    std::memcpy(owned_.data() + sizeof(header), level_table.data(), level_table.size() * sizeof(CacheLevel));
+    for (std::size_t i = 0; i < mips.size(); ++i) {
+        encode_level(mips[i], format, owned_.data() + level_table[i].offset);
+    }
+
+    bytes_ = owned_;
+    parse();
+}
+
+void TextureCache::parse() {
+    CacheHeader header{};
+    if (bytes_.size() < sizeof(header)) {
+        throw std::runtime_error("Texture cache is truncated");
+    }
+    std::memcpy(&header, bytes_.data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) {
+        throw std::runtime_error("Texture cache has an invalid header");
+    }
+    if (header.version != CACHE_VERSION) {
+        throw std::runtime_error(std::format("Unsupported texture cache version {}", header.version));
+    }
+    if (header.format > static_cast<std::uint32_t>(TextureCacheFormat::Bc3)) {
+        throw std::runtime_error(std::format("Unknown texture cache format {}", header.format));
+    }
+    format_ = static_cast<TextureCacheFormat>(header.format);
+
+    auto table_end = sizeof(header) + static_cast<std::size_t>(header.level_count) * sizeof(CacheLevel);
+    if (header.level_count == 0 || bytes_.size() < table_end) {
+        throw std::runtime_error("Texture cache is truncated");
+    }
+
+    levels_.clear();
+    for (std::uint32_t i = 0; i < header.level_count; ++i) {
+        CacheLevel level{};
+        std::memcpy(&level, bytes_.data() + sizeof(header) + i * sizeof(CacheLevel), sizeof(level));
+        bool valid_size = level.width > 0 && level.height > 0
+            && level.width <= std::numeric_limits<GLsizei>::max()
+            && level.height <= std::numeric_limits<GLsizei>::max()
+            && level.size == level_size(format_, static_cast<int>(level.width), static_cast<int>(level.height));
+        if (!valid_size || level.offset > bytes_.size() || level.size > bytes_.size() - level.offset) {
+            throw std::runtime_error(std::format("Texture cache level {} is invalid", i));
+        }
+        levels_.push_back({
+            static_cast<GLsizei>(level.width),
+            static_cast<GLsizei>(level.height),
+            bytes_.subspan(level.offset, level.size),
+        });
+    }
+}
+
+TextureCache TextureCache::load_or_bake(
+    char const *source_path,
+    char const *cache_path,
+    SdlImageLoader const &image_loader,
+    bool allow_compression)
+{
+    namespace fs = std::filesystem;
+    std::error_code source_err;
+    std::error_code cache_err;
+    auto source_time = fs::last_write_time(source_path, source_err);
+    auto cache_time = fs::last_write_time(cache_path, cache_err);
+
+    if (!cache_err && (source_err || cache_time >= source_time)) {
+        try {
+            TextureCache cache(cache_path);
+            if (allow_compression || !cache.is_compressed()) {
+                return cache;
+            }
+        } catch (std::runtime_error const &err) {
+            SDL_Log("Ignoring texture cache '%s': %s", cache_path, err.what());
+        }
+    }
+
+    TRACE_SCOPE("bake_texture_cache", "load");
+    SDL_Surface *image = image_loader.load_image(source_path, ImageOrientation::AsStored);
+    std::optional<TextureCache> ret;
+    try {
+        ret.emplace(image, allow_compression);
+    } catch (std::runtime_error const &) {
+        SDL_FreeSurface(image);
+        throw;
+    }
+    SDL_FreeSurface(image);
+
+    try {
+        ret->write(cache_path);
+    } catch (std::runtime_error const &err) {
+        SDL_Log("%s", err.what());
+    }
+    return std::move(*ret);
+}
+
+void TextureCache::write(char const *path) const {
+    FILE *file;
+    if (fopen_s(&file, path, "wb") != 0) {
+        throw std::runtime_error(std::format("Could not open texture cache '{}' for writing", path));
+    }
+    auto written = fwrite(bytes_.data(), 1, bytes_.size(), file);
+    bool ok = fclose(file) == 0 && written == bytes_.size();
+    if (!ok) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        throw std::runtime_error(std::format("Error writing texture cache '{}'", path));
+    }
+}
+
+TextureCacheFormat TextureCache::format() const noexcept {
+    return format_;
+}
+
+std::span<TextureCache::Level const> TextureCache::levels() const noexcept {
+    return levels_;
+}
+
+bool TextureCache::is_compressed() const noexcept {
+    return format_ != TextureCacheFormat::Rgba8;
+}
+
+GLenum TextureCache::gl_internal_format() const noexcept {
+    switch (format_) {
+        case TextureCacheFormat::Bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureCacheFormat::Bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default: return GL_RGBA8;
+    }
+}
+
+GLsizei TextureCache::row_group_height() const noexcept {
+    return is_compressed()? 4 : 1;
+}
+
+std::size_t TextureCache::row_group_bytes(Level const &level) const noexcept {
+    return level_size(format_, level.width, row_group_height());
+}
@@ -0,0 +1,82 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_TEXTURE_CACHE_HPP
+#define SDL_GLEW_TEST_TEXTURE_CACHE_HPP
+
+#include <span>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+#include "GL/glew.h"
+#include "mapped_file.hpp"
+
+struct SDL_Surface;
+class SdlImageLoader;
+
+enum class TextureCacheFormat : std::uint32_t {
+    Rgba8 = 0,
+    Bc1 = 1,
+    Bc3 = 2,
+};
+
+// A texture with its complete mip chain, baked ahead of time so that loading it
+// is a memory map followed by one upload per level. Rows are stored in file
+// order (top row first), matching ImageOrientation::AsStored.
+class TextureCache {
+public:
+    struct Level {
+        GLsizei width;
+        GLsizei height;
+        std::span<std::byte const> data;
+    };
+
+    // Maps an existing cache file.
+    explicit TextureCache(char const *path);
+
+    // Builds the mip chain of an image in memory, block-compressing each level when
+    // allowed (BC1 for opaque images, BC3 otherwise). Images of any pixel format
+    // are converted to RGBA8 first.
+    TextureCache(SDL_Surface *image, bool allow_compression);
+
+    TextureCache(TextureCache const &other) = delete;
+    TextureCache(TextureCache &&other) noexcept = default;
+    TextureCache &operator=(TextureCache const &other) = delete;
+    TextureCache &operator=(TextureCache &&other) noexcept = default;
+
+    // Uses the cache file if it is at least as new as the source image and in a usable
+    // format; otherwise bakes the source and tries to write the cache for next time.
+    [[nodiscard]] static TextureCache load_or_bake(
+        char const *source_path,
+        char const *cache_path,
+        SdlImageLoader const &image_loader,
+        bool allow_compression);
+
+    void write(char const *path) const;
+
+    [[nodiscard]] TextureCacheFormat format() const noexcept;
+    [[nodiscard]] std::span<Level const> levels() const noexcept;
+
+    [[nodiscard]] bool is_compressed() const noexcept;
+    [[nodiscard]] GLenum gl_internal_format() const noexcept;
+
+    // Levels are stored as groups of rows that can be uploaded independently:
+    // single rows for Rgba8, rows of 4x4 blocks for compressed formats.
+    [[nodiscard]] GLsizei row_group_height() const noexcept;
+    [[nodiscard]] std::size_t row_group_bytes(Level const &level) const noexcept;
+
+private:
+    void parse();
+
+    std::optional<MappedFile> file_;
+    std::vector<std::byte> owned_;
+    std::span<std::byte const> bytes_;
+
+    TextureCacheFormat format_;
+    std::vector<Level> levels_;
+};
+
+#endif //SDL_GLEW_TEST_TEXTURE_CACHE_HPP
@@ -0,0 +1,260 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class TraceEventType : char {
+    Begin = 'B',
+    End = 'E',
+    Counter = 'C',
+};
+
+struct TraceEvent {
+    char const *name;
+    char const *category;
+    TraceEventType type;
+    std::int64_t timestamp_ns;
+    double value;
+};
+
+constexpr std::size_t THREAD_BUFFER_EVENTS = 1 << 16;
+// Events kept across flushes; past this the oldest are discarded.
+constexpr std::size_t MAX_RECORDED_EVENTS = 1 << 20;
+
+class ThreadTraceBuffer {
+public:
+    explicit ThreadTraceBuffer(int tid):
+        tid(tid),
+        head_(0),
+        dropped_(0)
+    {}
+
+    // Called only by the owning thread. A full ring overwrites its oldest
+    // event, so the ring always holds the latest ones.
+    void push(TraceEvent const &event) noexcept {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto &slot = slots_[head % THREAD_BUFFER_EVENTS];
+        // Stores to a slot the flushing thread may be reading; it discards any
+        // slot overwritten while it read, so the fields need only be atomic.
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.category.store(event.category, std::memory_order_relaxed);
+        slot.type.store(event.type, std::memory_order_relaxed);
+        slot.timestamp_ns.store(event.timestamp_ns, std::memory_order_relaxed);
+        slot.value.store(event.value, std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Called by the flushing thread, with the registry lock held. Events
+    // overwritten before they were drained count as dropped.
+    template<typename F>
+    void drain(F &&consume) {
+        auto tail = tail_;
+        auto head = head_.load(std::memory_order_acquire);
+        if (head - tail > THREAD_BUFFER_EVENTS) {
+            dropped_.fetch_add(head - tail - THREAD_BUFFER_EVENTS, std::memory_order_relaxed);
+            tail = head - THREAD_BUFFER_EVENTS;
+        }
+        drained_.clear();
+        for (auto i = tail; i != head; ++i) {
+            auto const &slot = slots_[i % THREAD_BUFFER_EVENTS];
+            drained_.push_back({slot.name.load(std::memory_order_relaxed),
+                                slot.category.load(std::memory_order_relaxed),
+                                slot.type.load(std::memory_order_relaxed),
+                                slot.timestamp_ns.load(std::memory_order_relaxed),
+                                slot.value.load(std::memory_order_relaxed)});
+        }
+        // The owning thread kept recording meanwhile; slots it lapped may hold
+        // torn events, so only those still older than a full ring are kept.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto lapped = head_.load(std::memory_order_relaxed);
+        std::size_t skip = 0;
+        if (lapped - tail > THREAD_BUFFER_EVENTS) {
+            skip = static_cast<std::size_t>(std::min<std::uint64_t>(lapped - tail - THREAD_BUFFER_EVENTS, head - tail));
+            dropped_.fetch_add(skip, std::memory_order_relaxed);
+        }
+        for (auto i = skip; i < drained_.size(); ++i) {
+            consume(drained_[i]);
+        }
+        tail_ = head;
+    }
+
+    // Counts events the registry discarded after draining them.
+    void add_dropped(std::uint64_t count) noexcept {
+        dropped_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    int const tid;
+    std::string name;
+
+private:
+    struct Slot {
+        std::atomic<char const *> name;
+        std::atomic<char const *> category;
+        std::atomic<TraceEventType> type;
+        std::atomic<std::int64_t> timestamp_ns;
+        std::atomic<double> value;
+    };
+
+    std::array<Slot, THREAD_BUFFER_EVENTS> slots_;
+    std::atomic<std::uint64_t> head_;
+    // Only the flushing thread moves the tail; the owning thread never waits on it.
+    std::uint64_t tail_ = 0;
+    std::atomic<std::uint64_t> dropped_;
+    // Events copied out by the last drain, kept to reuse the allocation.
+    std::vector<TraceEvent> drained_;
+};
+
+struct RecordedEvent {
+    TraceEvent event;
+    int tid;
+};
+
+class TraceRegistry {
+public:
+    static TraceRegistry &instance() {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+    ThreadTraceBuffer &register_thread() {
+        std::lock_guard lock(mutex_);
+        auto &buffer = buffers_.emplace_back(std::make_shared<ThreadTraceBuffer>(static_cast<int>(buffers_.size()) + 1));
+        return *buffer;
+    }
+
+    void write_chrome_json(char const *path) {
+        std::lock_guard lock(mutex_);
+        for (auto const &buffer : buffers_) {
+            buffer->drain([&](TraceEvent const &event) { recorded_.push_back({event, buffer->tid}); });
+        }
+        while (recorded_.size() > MAX_RECORDED_EVENTS) {
+            buffers_[recorded_.front().tid - 1]->add_dropped(1);
+            recorded_.pop_front();
+        }
+
+        FILE *file;
+        if (fopen_s(&file, path, "w") != 0) {
+            throw std::runtime_error(std::format("Could not open trace output '{}'", path));
+        }
+
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+        bool first = true;
+        auto separator = [&] {
+            if (!first) {
+                fputs(",\n", file);
+            }
+            first = false;
+        };
+        for (auto const &buffer : buffers_) {
+            separator();
+            fprintf(file, R"({"name":"thread_name","ph":"M","pid":1,"tid":%d,"args":{"name":"%s"}})",
+                    buffer->tid, escaped(buffer->name.empty()? std::format("thread {}", buffer->tid) : buffer->name).c_str());
+            if (auto dropped = buffer->dropped(); dropped != 0) {
+                separator();
+                fprintf(file, R"({"name":"dropped_events","ph":"C","ts":0,"pid":1,"tid":%d,"args":{"value":%llu}})",
+                        buffer->tid, static_cast<unsigned long long>(dropped));
+            }
+        }
+        for (auto const &[event, tid] : recorded_) {
+            separator();
+            auto ts = static_cast<double>(event.timestamp_ns) / 1000.0;
+            auto name = escaped(event.name);
+            if (event.type == TraceEventType::Counter) {
+                fprintf(file, R"({"name":"%s","ph":"C","ts":%.3f,"pid":1,"tid":%d,"args":{"value":%g}})",
+                        name.c_str(), ts, tid, event.value);
+            } else {
+                fprintf(file, R"({"name":"%s","cat":"%s","ph":"%c","ts":%.3f,"pid":1,"tid":%d})",
+                        name.c_str(), escaped(event.category).c_str(), static_cast<char>(event.type), ts, tid);
+            }
+        }
+        fputs("\n]}\n", file);
+
+        if (fclose(file) != 0) {
+            throw std::runtime_error(std::format("Error writing trace output '{}'", path));
+        }
+    }
+
+    std::mutex &mutex() noexcept {
+        return mutex_;
+    }
+
+private:
+    static std::string escaped(std::string_view str) {
+        std::string ret;
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                ret.push_back('\\');
+            }
+            ret.push_back(c);
+        }
+        return ret;
+    }
+
+    std::mutex mutex_;
+    // Buffers outlive their threads so events recorded just before a thread exits still get written.
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers_;
+    // The latest MAX_RECORDED_EVENTS events drained, oldest first.
+    std::deque<RecordedEvent> recorded_;
+};
+
+static ThreadTraceBuffer &thread_buffer() {
+    thread_local ThreadTraceBuffer &buffer = TraceRegistry::instance().register_thread();
+    return buffer;
+}
+
+static std::int64_t now_ns() noexcept {
+    static auto const epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::begin(char const *name, char const *category) noexcept {
+    thread_buffer().push({name, category, TraceEventType::Begin, now_ns(), 0});
+}
+
+void Trace::end(char const *name, char const *category) noexcept {
+    thread_buffer().push({name, category, TraceEventType::End, now_ns(), 0});
+}
+
+void Trace::counter(char const *name, double value) noexcept {
+    thread_buffer().push({name, "counter", TraceEventType::Counter, now_ns(), value});
+}
+
+void Trace::set_thread_name(char const *name) {
+    auto &buffer = thread_buffer();
+    std::lock_guard lock(TraceRegistry::instance().mutex());
+    buffer.name = name;
+}
+
+void Trace::write_chrome_json(char const *path) {
+    TraceRegistry::instance().write_chrome_json(path);
+}
+
+TraceScope::TraceScope(char const *name, char const *category) noexcept:
+    name_(name),
+    category_(category)
+{
+    Trace::begin(name_, category_);
+}
+
+TraceScope::~TraceScope() noexcept {
+    Trace::end(name_, category_);
+}
@@ -0,0 +1,56 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_TRACE_HPP
+#define SDL_GLEW_TEST_TRACE_HPP
+
+// Timeline tracing in the Chrome trace event format (viewable in chrome://tracing
+// or Perfetto). Each thread records into its own fixed-size single-producer ring,
+// so recording takes no locks; a full ring overwrites its oldest events, and
+// flushes keep only the latest events, so a trace shows what just happened.
+// Event names and categories must be string literals (or otherwise outlive the
+// trace), since only their pointers are recorded.
+class Trace {
+public:
+    static void begin(char const *name, char const *category) noexcept;
+    static void end(char const *name, char const *category) noexcept;
+    static void counter(char const *name, double value) noexcept;
+
+    static void set_thread_name(char const *name);
+
+    // Drains every thread's ring and writes the latest events recorded so far.
+    static void write_chrome_json(char const *path);
+};
+
+class TraceScope {
+public:
+    TraceScope(char const *name, char const *category) noexcept;
+    ~TraceScope() noexcept;
+
+    TraceScope(TraceScope const &other) = delete;
+    TraceScope(TraceScope &&other) = delete;
+    TraceScope &operator=(TraceScope const &other) = delete;
+    TraceScope &operator=(TraceScope &&other) = delete;
+
+private:
+    char const *name_;
+    char const *category_;
+};
+
+// Tracing is compiled in only with BOIDS_ENABLE_TRACE.
+#ifdef BOIDS_ENABLE_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)((name), (category))
+#define TRACE_COUNTER(name, value) Trace::counter((name), (value))
+#define TRACE_THREAD_NAME(name) Trace::set_thread_name(name)
+#define TRACE_WRITE(path) Trace::write_chrome_json(path)
+#else
+#define TRACE_SCOPE(name, category) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#define TRACE_WRITE(path) ((void)0)
+#endif
+
+#endif //SDL_GLEW_TEST_TRACE_HPP
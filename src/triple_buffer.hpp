@@ -0,0 +1,75 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_TRIPLE_BUFFER_HPP
+#define SDL_GLEW_TEST_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+
+// Lock-free handoff of the most recent value from one producer thread to one
+// consumer thread. The producer fills back() and publishes it; the consumer
+// swaps in whatever was published last, skipping any it never saw. Neither side
+// ever waits on the other.
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(TripleBuffer const &other) = delete;
+    TripleBuffer(TripleBuffer &&other) = delete;
+    TripleBuffer &operator=(TripleBuffer const &other) = delete;
+    TripleBuffer &operator=(TripleBuffer &&other) = delete;
+
+    // Producer side.
+    [[nodiscard]] T &back() noexcept;
+    void publish() noexcept;
+
+    // Consumer side. Returns whether a newly published value was swapped into front().
+    bool acquire() noexcept;
+    [[nodiscard]] T const &front() const noexcept;
+    [[nodiscard]] bool has_front() const noexcept;
+
+private:
+    static constexpr unsigned FRESH_BIT = 4;
+    static constexpr unsigned INDEX_MASK = 3;
+
+    std::array<T, 3> buffers_{};
+    unsigned back_ = 0;
+    std::atomic<unsigned> middle_ = 1;
+    unsigned front_ = 2;
+    bool has_front_ = false;
+};
+
+template<typename T>
+T &TripleBuffer<T>::back() noexcept {
+    return buffers_[back_];
+}
+
+template<typename T>
+void TripleBuffer<T>::publish() noexcept {
+    back_ = middle_.exchange(back_ | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+template<typename T>
+bool TripleBuffer<T>::acquire() noexcept {
+    if ((middle_.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+        return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+    has_front_ = true;
+    return true;
+}
+
+template<typename T>
+T const &TripleBuffer<T>::front() const noexcept {
+    return buffers_[front_];
+}
+
+template<typename T>
+bool TripleBuffer<T>::has_front() const noexcept {
+    return has_front_;
+}
+
+#endif //SDL_GLEW_TEST_TRIPLE_BUFFER_HPP
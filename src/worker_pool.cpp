@@ -0,0 +1,224 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "trace.hpp"
+
+// Pins a thread to the n-th CPU this process may run on (wrapping around).
+static void pin_to_cpu(std::thread::native_handle_type thread, std::size_t n) noexcept {
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        return;
+    }
+    n %= static_cast<std::size_t>(CPU_COUNT(&allowed));
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && n-- == 0) {
+            cpu_set_t target;
+            CPU_ZERO(&target);
+            CPU_SET(cpu, &target);
+            pthread_setaffinity_np(thread, sizeof(target), &target);
+            return;
+        }
+    }
+#else
+    (void)thread;
+    (void)n;
+#endif
+}
+
+// Holds the calling thread on the pool's first CPU for a scope, then gives it
+// back the CPUs it was allowed before.
+class CallerPin {
+public:
+    explicit CallerPin(bool pin) noexcept {
+#ifdef __linux__
+        if (pin) {
+            CPU_ZERO(&saved_);
+            pinned_ = pthread_getaffinity_np(pthread_self(), sizeof(saved_), &saved_) == 0;
+            if (pinned_) {
+                pin_to_cpu(pthread_self(), 0);
+            }
+        }
+#else
+        (void)pin;
+#endif
+    }
+
+    ~CallerPin() noexcept {
+#ifdef __linux__
+        if (pinned_) {
+            pthread_setaffinity_np(pthread_self(), sizeof(saved_), &saved_);
+        }
+#endif
+    }
+
+    CallerPin(CallerPin const &other) = delete;
+    CallerPin &operator=(CallerPin const &other) = delete;
+
+private:
+#ifdef __linux__
+    cpu_set_t saved_;
+    bool pinned_ = false;
+#endif
+};
+
+WorkerPool::WorkerPool(std::size_t thread_count, bool pin_threads):
+    pin_threads_(pin_threads)
+{
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    worker_counters_.resize(thread_count - 1);
+    workers_.reserve(thread_count - 1);
+    for (std::size_t i = 0; i + 1 < thread_count; ++i) {
+        workers_.emplace_back([this, i](std::stop_token stop) { worker_loop(std::move(stop), i); });
+        if (pin_threads_) {
+            pin_to_cpu(workers_.back().native_handle(), i + 1);
+        }
+    }
+}
+
+WorkerPool::~WorkerPool() noexcept {
+    for (auto &worker : workers_) {
+        worker.request_stop();
+    }
+    work_available_.notify_all();
+    workers_.clear();
+}
+
+std::size_t WorkerPool::thread_count() const noexcept {
+    return workers_.size() + 1;
+}
+
+void WorkerPool::parallel_for(std::size_t count, std::size_t grain, RangeFunction const &fn) {
+    run(count, std::max<std::size_t>(grain, 1), false, fn);
+}
+
+void WorkerPool::parallel_for_static(std::size_t count, RangeFunction const &fn) {
+    run(count, (count + thread_count() - 1) / thread_count(), true, fn);
+}
+
+void WorkerPool::run(std::size_t count, std::size_t grain, bool split_static, RangeFunction const &fn) {
+    if (caller_thread_ != std::this_thread::get_id()) {
+        adopt_caller();
+    }
+    CallerPin pin(pin_threads_);
+
+    if (workers_.empty() || count <= grain) {
+        if (count > 0) {
+            fn(0, count);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        fn_ = &fn;
+        count_ = count;
+        grain_ = grain;
+        split_static_ = split_static;
+        next_chunk_.store(0, std::memory_order_relaxed);
+        error_ = nullptr;
+        busy_workers_ = workers_.size();
+        ++generation_;
+    }
+    work_available_.notify_all();
+    run_chunks(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock lock(mutex_);
+        work_done_.wait(lock, [&] { return busy_workers_ == 0; });
+        fn_ = nullptr;
+        error = std::exchange(error_, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkerPool::adopt_caller() {
+    auto counters = std::make_unique<CacheCounters>();
+    std::lock_guard lock(mutex_);
+    if (caller_counters_) {
+        retired_counts_ += caller_counters_->read();
+    }
+    caller_counters_ = std::move(counters);
+    caller_thread_ = std::this_thread::get_id();
+}
+
+CacheCounters::Sample WorkerPool::cache_counts() {
+    std::lock_guard lock(mutex_);
+    auto ret = retired_counts_;
+    if (caller_counters_) {
+        ret += caller_counters_->read();
+    }
+    for (auto const &counters : worker_counters_) {
+        if (counters) {
+            ret += counters->read();
+        }
+    }
+    return ret;
+}
+
+void WorkerPool::worker_loop(std::stop_token stop, std::size_t index) {
+    TRACE_THREAD_NAME("worker");
+    {
+        auto counters = std::make_unique<CacheCounters>();
+        std::lock_guard lock(mutex_);
+        worker_counters_[index] = std::move(counters);
+    }
+    std::uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            if (!work_available_.wait(lock, stop, [&] { return generation_ != seen_generation; })) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+        run_chunks(index + 1);
+        {
+            std::lock_guard lock(mutex_);
+            --busy_workers_;
+        }
+        work_done_.notify_one();
+    }
+}
+
+void WorkerPool::run_chunks(std::size_t thread) noexcept {
+    try {
+        if (split_static_) {
+            auto begin = std::min(thread * grain_, count_);
+            auto end = std::min(begin + grain_, count_);
+            if (begin < end) {
+                (*fn_)(begin, end);
+            }
+            return;
+        }
+        auto chunk_count = (count_ + grain_ - 1) / grain_;
+        for (auto chunk = next_chunk_.fetch_add(1); chunk < chunk_count; chunk = next_chunk_.fetch_add(1)) {
+            auto begin = chunk * grain_;
+            (*fn_)(begin, std::min(begin + grain_, count_));
+        }
+    } catch (...) {
+        // Chunks not yet taken are skipped; the first error is rethrown on the caller.
+        next_chunk_.store(count_, std::memory_order_relaxed);
+        std::lock_guard lock(mutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+}
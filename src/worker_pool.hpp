@@ -0,0 +1,86 @@
+//
+// Created by agent on 10/18/2026.
+//
+
+#ifndef SDL_GLEW_TEST_WORKER_POOL_HPP
+#define SDL_GLEW_TEST_WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cache_counters.hpp"
+
+// Fixed set of threads that split index ranges between themselves and the
+// calling thread. Only one parallel_for runs at a time. Every thread that runs
+// pool work counts its cache events, so callers can see how well a pass uses
+// the cache.
+//
+// Threads can be pinned to CPUs, so that together with parallel_for_static the
+// memory a thread first touches stays on that thread's NUMA node.
+class WorkerPool {
+public:
+    using RangeFunction = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // Zero threads means one per hardware thread. The caller counts as one of them
+    // and, when pinning, is held on the first CPU only while it runs pool work, so
+    // that threads calling in now and then keep the CPUs they had.
+    explicit WorkerPool(std::size_t thread_count = 0, bool pin_threads = false);
+    ~WorkerPool() noexcept;
+
+    WorkerPool(WorkerPool const &other) = delete;
+    WorkerPool(WorkerPool &&other) = delete;
+    WorkerPool &operator=(WorkerPool const &other) = delete;
+    WorkerPool &operator=(WorkerPool &&other) = delete;
+
+    [[nodiscard]] std::size_t thread_count() const noexcept;
+
+    // Calls fn over disjoint subranges of [0, count), each at most `grain` long,
+    // and returns once all of them have finished. If fn throws, the subranges not
+    // yet started are skipped and the first exception is rethrown here.
+    void parallel_for(std::size_t count, std::size_t grain, RangeFunction const &fn);
+    // Splits [0, count) into one contiguous block per thread, in thread order with
+    // the caller first. The same count always gives each thread the same block.
+    // Exceptions from fn are rethrown as by parallel_for.
+    void parallel_for_static(std::size_t count, RangeFunction const &fn);
+
+    // Totals since the pool started, over the workers and every calling thread.
+    [[nodiscard]] CacheCounters::Sample cache_counts();
+
+private:
+    void run(std::size_t count, std::size_t grain, bool split_static, RangeFunction const &fn);
+    void adopt_caller();
+    void worker_loop(std::stop_token stop, std::size_t index);
+    void run_chunks(std::size_t thread) noexcept;
+
+    std::mutex mutex_;
+    std::condition_variable_any work_available_;
+    std::condition_variable work_done_;
+    std::uint64_t generation_ = 0;
+    std::size_t busy_workers_ = 0;
+
+    RangeFunction const *fn_ = nullptr;
+    std::size_t count_ = 0;
+    std::size_t grain_ = 1;
+    bool split_static_ = false;
+    std::atomic<std::size_t> next_chunk_ = 0;
+    // First exception thrown by fn during the current run.
+    std::exception_ptr error_;
+    bool pin_threads_;
+
+    std::vector<std::unique_ptr<CacheCounters>> worker_counters_;
+    std::unique_ptr<CacheCounters> caller_counters_;
+    std::thread::id caller_thread_;
+    CacheCounters::Sample retired_counts_;
+
+    std::vector<std::jthread> workers_;
+};
+
+#endif //SDL_GLEW_TEST_WORKER_POOL_HPP